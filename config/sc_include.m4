@@ -288,6 +288,7 @@ SC_BUILTIN_ALL_PREFIX([$1])
 SC_CHECK_PTHREAD([$1])
 SC_CHECK_OPENMP([$1])
 SC_CHECK_MEMALIGN([$1])
+SC_CHECK_SLAB([$1])
 dnl SC_CUDA([$1])
 ])
 
@@ -0,0 +1,29 @@
+dnl SC_CHECK_SLAB(PREFIX)
+dnl Let the user specify --enable-slab to put a slab allocator with size
+dnl classes and thread-local caches behind sc_malloc and friends.
+dnl
+dnl With POSIX threads or OpenMP, the caches require the __thread keyword.
+dnl This macro must be called after SC_CHECK_PTHREAD and SC_CHECK_OPENMP.
+dnl
+AC_DEFUN([SC_CHECK_SLAB], [
+
+AC_MSG_CHECKING([for slab allocator])
+SC_ARG_ENABLE_PREFIX([slab],
+  [use a slab allocator with thread-local caches for small sc_malloc sizes],
+  [SLAB], [$1])
+if test "x$$1_ENABLE_SLAB" != xno ; then
+  if test "x$$1_ENABLE_PTHREAD" != xno || \
+     test "x$$1_ENABLE_OPENMP" != xno ; then
+    AC_COMPILE_IFELSE([AC_LANG_PROGRAM(
+[[
+static __thread int sc_slab_thread_test;
+]],[[
+  sc_slab_thread_test = 1;
+]])],,
+                      [AC_MSG_ERROR([Slab allocator requires __thread])])
+  fi
+  AC_MSG_RESULT([successful])
+else
+  AC_MSG_RESULT([not used])
+fi
+])
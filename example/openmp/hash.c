@@ -0,0 +1,149 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+
+  The SC Library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation; either version 2.1 of the License, or
+  (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/* Measure the insert throughput of a hash table shared by OpenMP threads.
+ * We compare an sc_hash protected by one global lock with sc_hash_mt.
+ * Usage: sc_openmp_hash [number of keys] [number of stripes]
+ */
+
+#include <sc_containers.h>
+#include <omp.h>
+
+static unsigned
+openmp_hash_int (const void *v, const void *u)
+{
+  return (unsigned) *(const int *) v;
+}
+
+static int
+openmp_equal_int (const void *v1, const void *v2, const void *u)
+{
+  return *(const int *) v1 == *(const int *) v2;
+}
+
+/** Insert all keys into an sc_hash guarded by a single lock.
+ * \return          The wall clock time of the insertion.
+ */
+static double
+openmp_hash_global (int *keys, int N, int num_threads)
+{
+  int                 i;
+  double              elapsed;
+  omp_lock_t          lock;
+  sc_hash_t          *hash;
+
+  hash = sc_hash_new_pow2 (openmp_hash_int, openmp_equal_int, NULL, NULL);
+  omp_init_lock (&lock);
+
+  elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+  for (i = 0; i < N; ++i) {
+    omp_set_lock (&lock);
+    (void) sc_hash_insert_unique (hash, keys + i, NULL);
+    omp_unset_lock (&lock);
+  }
+  elapsed += sc_MPI_Wtime ();
+
+  SC_CHECK_ABORT (hash->elem_count == (size_t) N, "Global lock count");
+  omp_destroy_lock (&lock);
+  sc_hash_destroy (hash);
+
+  return elapsed;
+}
+
+/** Insert all keys into an sc_hash_mt.
+ * \return          The wall clock time of the insertion.
+ */
+static double
+openmp_hash_striped (int *keys, int N, int num_threads, int num_stripes)
+{
+  int                 i;
+  double              elapsed;
+  sc_hash_mt_t       *hash;
+
+  hash = sc_hash_mt_new (openmp_hash_int, openmp_equal_int, NULL,
+                         num_stripes);
+
+  elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+  for (i = 0; i < N; ++i) {
+    (void) sc_hash_mt_insert_unique (hash, keys + i, NULL);
+  }
+  elapsed += sc_MPI_Wtime ();
+
+  SC_CHECK_ABORT (sc_hash_mt_count (hash) == (size_t) N, "Striped count");
+  if (num_threads == 1) {
+    sc_hash_mt_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+  }
+  sc_hash_mt_destroy (hash);
+
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int                 mpiret;
+  int                 i, N, num_stripes;
+  int                 num_threads, max_threads;
+  int                *keys;
+  uint32_t            x;
+  double              tglobal, tstriped;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  N = argc >= 2 ? (int) strtol (argv[1], NULL, 0) : 1000000;
+  num_stripes = argc >= 3 ? (int) strtol (argv[2], NULL, 0) : 0;
+  SC_CHECK_ABORT (N > 0 && num_stripes >= 0, "Invalid arguments");
+
+  /* distinct pseudo-random keys: an odd multiplier is a bijection */
+  keys = SC_ALLOC (int, N);
+  for (i = 0; i < N; ++i) {
+    x = (uint32_t) i * 0x9e3779b1U;
+    keys[i] = (int) (x ^ (x >> 15));
+  }
+
+  max_threads = omp_get_max_threads ();
+  SC_GLOBAL_PRODUCTIONF ("Inserting %d keys with up to %d threads\n",
+                         N, max_threads);
+  for (num_threads = 1;; num_threads *= 2) {
+    num_threads = SC_MIN (num_threads, max_threads);
+    tglobal = openmp_hash_global (keys, N, num_threads);
+    tstriped = openmp_hash_striped (keys, N, num_threads, num_stripes);
+    SC_GLOBAL_PRODUCTIONF ("Threads %3d global lock %8.3g Mops/s"
+                           " striped %8.3g Mops/s\n", num_threads,
+                           1e-6 * N / tglobal, 1e-6 * N / tstriped);
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+
+  SC_FREE (keys);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
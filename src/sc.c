@@ -45,14 +45,34 @@ typedef void        (*sc_sig_t) (int);
 #include <pthread.h>
 #endif
 
+/* With threads, the allocation counters are incremented atomically.
+ * Each thread uses one of several shards to avoid contention. */
+#if (defined SC_ENABLE_PTHREAD || defined SC_ENABLE_OPENMP) && \
+    (defined __GNUC__ || defined __clang__)
+#define SC_ALLOC_COUNT_ATOMIC
+#define SC_ALLOC_COUNT_SHARDS 16
+#else
+#define SC_ALLOC_COUNT_SHARDS 1
+#endif
+
+/** The allocation counters of one shard fill a cache line of their own. */
+typedef struct sc_alloc_count
+{
+  int                 malloc_count;
+  int                 free_count;
+#if SC_ALLOC_COUNT_SHARDS > 1
+  char                padding[64 - 2 * sizeof (int)];
+#endif
+}
+sc_alloc_count_t;
+
 typedef struct sc_package
 {
   int                 is_registered;
   sc_log_handler_t    log_handler;
   int                 log_threshold;
   int                 log_indent;
-  int                 malloc_count;
-  int                 free_count;
+  sc_alloc_count_t    alloc_count[SC_ALLOC_COUNT_SHARDS];
   int                 rc_active;
   int                 abort_mismatch;
   const char         *name;
@@ -94,8 +114,7 @@ int                 sc_package_id = -1;
 FILE               *sc_trace_file = NULL;
 int                 sc_trace_prio = SC_LP_STATISTICS;
 
-static int          default_malloc_count = 0;
-static int          default_free_count = 0;
+static sc_alloc_count_t default_alloc_count[SC_ALLOC_COUNT_SHARDS];
 static int          default_rc_active = 0;
 static int          default_abort_mismatch = 1;
 
@@ -295,24 +314,72 @@ sc_log_handler (FILE * log_stream, const char *filename, int lineno,
   fflush (log_stream);
 }
 
-static int         *
-sc_malloc_count (int package)
+#ifdef SC_ALLOC_COUNT_ATOMIC
+static int          sc_alloc_count_next = 0;
+static __thread int sc_alloc_count_shard = -1;
+#endif
+
+/** Return the counters of a package for the calling thread's shard. */
+static sc_alloc_count_t *
+sc_alloc_count (int package)
 {
+  int                 shard = 0;
+
+#ifdef SC_ALLOC_COUNT_ATOMIC
+  /* the threads are assigned to the shards in turn */
+  if (sc_alloc_count_shard < 0) {
+    sc_alloc_count_shard =
+      __sync_fetch_and_add (&sc_alloc_count_next, 1) % SC_ALLOC_COUNT_SHARDS;
+  }
+  shard = sc_alloc_count_shard;
+#endif
+
   if (package == -1)
-    return &default_malloc_count;
+    return default_alloc_count + shard;
 
   SC_ASSERT (sc_package_is_registered (package));
-  return &sc_packages[package].malloc_count;
+  return sc_packages[package].alloc_count + shard;
 }
 
-static int         *
-sc_free_count (int package)
+/** Add to an allocation counter without taking the package lock. */
+static inline void
+sc_alloc_count_add (int package, int *counter, int toadd)
 {
-  if (package == -1)
-    return &default_free_count;
+#ifdef SC_ALLOC_COUNT_ATOMIC
+  (void) __sync_fetch_and_add (counter, toadd);
+#else
+#ifdef SC_ENABLE_PTHREAD
+  sc_package_lock (package);
+#endif
+  *counter += toadd;
+#ifdef SC_ENABLE_PTHREAD
+  sc_package_unlock (package);
+#endif
+#endif
+}
 
-  SC_ASSERT (sc_package_is_registered (package));
-  return &sc_packages[package].free_count;
+/** Fold the counters of all shards together. */
+static void
+sc_alloc_count_sum (sc_alloc_count_t * alloc_count,
+                    int *malloc_count, int *free_count)
+{
+  int                 i;
+
+  *malloc_count = *free_count = 0;
+  for (i = 0; i < SC_ALLOC_COUNT_SHARDS; ++i) {
+    *malloc_count += alloc_count[i].malloc_count;
+    *free_count += alloc_count[i].free_count;
+  }
+}
+
+static void
+sc_alloc_count_reset (sc_alloc_count_t * alloc_count)
+{
+  int                 i;
+
+  for (i = 0; i < SC_ALLOC_COUNT_SHARDS; ++i) {
+    alloc_count[i].malloc_count = alloc_count[i].free_count = 0;
+  }
 }
 
 #ifdef SC_ENABLE_MEMALIGN
@@ -460,6 +527,8 @@ sc_free_aligned (void *ptr, size_t alignment)
 #endif
 }
 
+#ifndef SC_ENABLE_SLAB
+
 /* *INDENT-OFF* */
 static void        *
 sc_realloc_aligned (void *ptr, size_t alignment, size_t size)
@@ -511,38 +580,414 @@ sc_realloc_aligned (void *ptr, size_t alignment, size_t size)
 #endif
 }
 
+#endif /* !SC_ENABLE_SLAB */
+
 #endif /* SC_ENABLE_MEMALIGN */
 
-void               *
-sc_malloc (int package, size_t size)
+#ifdef SC_ENABLE_SLAB
+
+/* The slab allocator serves small requests from a fixed set of size classes.
+ * Each object is preceded by a header that records its size class.  Free
+ * objects are kept in per-thread caches, which exchange batches of objects
+ * with a global depot under a lock.  New memory is obtained in chunks that
+ * are kept for reuse until the program exits.  Requests beyond the largest
+ * size class are passed on to the system allocator with the same header.
+ * With pthreads, the cache of an exiting thread is returned to the depot.
+ * OpenMP provides no thread exit hook, so with OpenMP only, the objects in
+ * the cache of a finished thread, up to two batches per size class, are not
+ * reused; this is bounded as long as the runtime keeps its thread pool.
+ */
+
+#if defined SC_ENABLE_PTHREAD || defined SC_ENABLE_OPENMP
+#define SC_SLAB_THREAD __thread
+#else
+#define SC_SLAB_THREAD
+#endif
+
+#if defined SC_ENABLE_MEMALIGN && SC_MEMALIGN_BYTES > 16
+#define SC_SLAB_ALIGN SC_MEMALIGN_BYTES
+#else
+#define SC_SLAB_ALIGN 16
+#endif
+
+#define SC_SLAB_NUM_CLASSES 23
+#define SC_SLAB_LARGE SC_SLAB_NUM_CLASSES
+#define SC_SLAB_MAX_SIZE 2048
+#define SC_SLAB_CHUNK_SIZE (1 << 16)
+
+/** The header in front of every object returned by the slab allocator. */
+typedef struct sc_slab_header
+{
+  size_t              size;     /**< requested size for large objects */
+  int                 sclass;   /**< size class or SC_SLAB_LARGE */
+}
+sc_slab_header_t;
+
+/** A free object links to the next object in its batch.
+ * The first object of a batch also links to the next batch in a list.
+ */
+typedef struct sc_slab_free
+{
+  struct sc_slab_free *next;
+  struct sc_slab_free *batch;
+  size_t              count;    /**< number of objects in this batch */
+}
+sc_slab_free_t;
+
+typedef struct sc_slab_cache
+{
+  sc_slab_free_t     *head[SC_SLAB_NUM_CLASSES];
+  size_t              count[SC_SLAB_NUM_CLASSES];
+  int                 registered;
+}
+sc_slab_cache_t;
+
+/* size classes including the header: steps of 16 bytes up to 128,
+ * then four steps per power of two up to SC_SLAB_MAX_SIZE */
+static const size_t sc_slab_class_size[SC_SLAB_NUM_CLASSES] = {
+  32, 48, 64, 80, 96, 112, 128,
+  160, 192, 224, 256, 320, 384, 448, 512,
+  640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+
+static SC_SLAB_THREAD sc_slab_cache_t sc_slab_cache;
+static sc_slab_free_t *sc_slab_depot[SC_SLAB_NUM_CLASSES];
+static void        *sc_slab_chunks = NULL;
+
+#ifdef SC_ENABLE_PTHREAD
+static pthread_mutex_t sc_slab_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t sc_slab_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sc_slab_key;
+#endif
+
+static void        *
+sc_slab_raw_malloc (size_t size)
 {
   void               *ret;
-  int                *malloc_count = sc_malloc_count (package);
 
-  /* allocate memory */
 #if defined SC_ENABLE_MEMALIGN
   ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, size);
 #else
   ret = malloc (size);
-  if (size > 0) {
-    SC_CHECK_ABORTF (ret != NULL, "Allocation (malloc size %lli)",
-                     (long long int) size);
+#endif
+  SC_CHECK_ABORTF (ret != NULL, "Allocation (malloc size %lli)",
+                   (long long int) size);
+  return ret;
+}
+
+static void
+sc_slab_raw_free (void *ptr)
+{
+#if defined SC_ENABLE_MEMALIGN
+  sc_free_aligned (ptr, SC_MEMALIGN_BYTES);
+#else
+  free (ptr);
+#endif
+}
+
+/** Return the size class for a size that includes the header. */
+static inline int
+sc_slab_class (size_t n)
+{
+  int                 p;
+
+  SC_ASSERT (n <= SC_SLAB_MAX_SIZE);
+  if (n <= 128) {
+    return n <= 32 ? 0 : (int) ((n - 1) >> 4) - 1;
   }
+  p = SC_LOG2_32 ((uint32_t) (n - 1));
+  return 7 + 4 * (p - 7) + (int) ((n - 1) >> (p - 2)) - 4;
+}
+
+/** The distance of neighboring objects of a size class in a chunk. */
+static inline size_t
+sc_slab_stride (int sclass)
+{
+  return SC_ALIGN_UP (sc_slab_class_size[sclass], (size_t) SC_SLAB_ALIGN);
+}
+
+/** The number of objects exchanged with the depot at once. */
+static inline size_t
+sc_slab_batch (int sclass)
+{
+  return SC_MAX (4, SC_MIN (64, 4096 / sc_slab_stride (sclass)));
+}
+
+/** Move up to one batch from the front of a thread's free list to the depot.
+ * \return          The number of objects moved.
+ */
+static size_t
+sc_slab_flush_batch (sc_slab_cache_t * cache, int sclass)
+{
+  size_t              n, batch = sc_slab_batch (sclass);
+  sc_slab_free_t     *first, *last;
+
+  /* cut the batch from the thread's list outside of the lock */
+  first = last = cache->head[sclass];
+  SC_ASSERT (first != NULL);
+  for (n = 1; n < batch && last->next != NULL; ++n) {
+    last = last->next;
+  }
+  cache->head[sclass] = last->next;
+  cache->count[sclass] -= n;
+  last->next = NULL;
+  first->count = n;
+
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_lock (&sc_slab_mutex);
+#elif defined SC_ENABLE_OPENMP
+#pragma omp critical (sc_slab)
+#endif
+  {
+    first->batch = sc_slab_depot[sclass];
+    sc_slab_depot[sclass] = first;
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_slab_mutex);
 #endif
 
-  /* count the allocations */
+  return n;
+}
+
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
+
+/** Return the objects cached by an exiting thread to the depot. */
+static void
+sc_slab_thread_exit (void *v)
+{
+  int                 c;
+  sc_slab_cache_t    *cache = (sc_slab_cache_t *) v;
+
+  for (c = 0; c < SC_SLAB_NUM_CLASSES; ++c) {
+    while (cache->head[c] != NULL) {
+      (void) sc_slab_flush_batch (cache, c);
+    }
+  }
+}
+
+static void
+sc_slab_key_create (void)
+{
+  int                 pth;
+
+  pth = pthread_key_create (&sc_slab_key, sc_slab_thread_exit);
+  SC_CHECK_ABORT (pth == 0, "sc_slab key create");
+}
+
+/** Have the thread's cache returned to the depot when the thread exits.
+ * This must happen before the first object enters the cache, whether by
+ * allocation or by a thread that only frees objects allocated elsewhere.
+ */
+static void
+sc_slab_register (sc_slab_cache_t * cache)
+{
+  int                 pth;
+
+  pth = pthread_once (&sc_slab_once, sc_slab_key_create);
+  SC_CHECK_ABORT (pth == 0, "sc_slab once");
+  pth = pthread_setspecific (sc_slab_key, cache);
+  SC_CHECK_ABORT (pth == 0, "sc_slab set specific");
+  cache->registered = 1;
+}
+
 #endif
-  if (size > 0) {
-    ++*malloc_count;
+
+/** Carve a new chunk into batches of a size class and add them to the depot.
+ * This function must be called while holding the depot lock.
+ */
+static void
+sc_slab_new_chunk (int sclass)
+{
+  size_t              stride = sc_slab_stride (sclass);
+  size_t              batch = sc_slab_batch (sclass);
+  size_t              n, i, offset;
+  char               *chunk;
+  sc_slab_free_t     *obj, *first;
+
+  /* the first bytes of a chunk link to the previously allocated one */
+  chunk = (char *) sc_slab_raw_malloc (SC_SLAB_CHUNK_SIZE);
+  *(void **) chunk = sc_slab_chunks;
+  sc_slab_chunks = chunk;
+  offset = SC_ALIGN_UP (sizeof (void *), (size_t) SC_SLAB_ALIGN);
+  n = (SC_SLAB_CHUNK_SIZE - offset) / stride;
+  SC_ASSERT (n >= batch);
+
+  first = NULL;
+  for (i = 0; i < n; ++i) {
+    obj = (sc_slab_free_t *) (chunk + offset + i * stride);
+    if (i % batch == 0) {
+      if (first != NULL) {
+        first->batch = sc_slab_depot[sclass];
+        sc_slab_depot[sclass] = first;
+      }
+      first = obj;
+      first->count = SC_MIN (batch, n - i);
+    }
+    obj->next = (i + 1) % batch == 0 || i + 1 == n ?
+      NULL : (sc_slab_free_t *) (chunk + offset + (i + 1) * stride);
+  }
+  first->batch = sc_slab_depot[sclass];
+  sc_slab_depot[sclass] = first;
+}
+
+/** Fetch one batch of a size class from the depot into a thread's cache. */
+static void
+sc_slab_refill (sc_slab_cache_t * cache, int sclass)
+{
+  sc_slab_free_t     *first;
+
+#ifdef SC_ENABLE_PTHREAD
+  if (!cache->registered) {
+    sc_slab_register (cache);
+  }
+  pthread_mutex_lock (&sc_slab_mutex);
+#elif defined SC_ENABLE_OPENMP
+#pragma omp critical (sc_slab)
+#endif
+  {
+    if (sc_slab_depot[sclass] == NULL) {
+      sc_slab_new_chunk (sclass);
+    }
+    first = sc_slab_depot[sclass];
+    sc_slab_depot[sclass] = first->batch;
+  }
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_unlock (&sc_slab_mutex);
+#endif
+
+  SC_ASSERT (cache->head[sclass] == NULL);
+  cache->head[sclass] = first;
+  cache->count[sclass] = first->count;
+}
+
+static void        *
+sc_slab_malloc (size_t size)
+{
+  int                 sclass;
+  sc_slab_header_t   *header;
+  sc_slab_cache_t    *cache;
+  sc_slab_free_t     *obj;
+
+  if (size > SC_SLAB_MAX_SIZE - SC_SLAB_ALIGN) {
+    /* the header must not wrap the size around */
+    SC_CHECK_ABORTF (size <= SIZE_MAX - SC_SLAB_ALIGN,
+                     "Allocation (malloc size %lli)", (long long int) size);
+    header = (sc_slab_header_t *) sc_slab_raw_malloc (size + SC_SLAB_ALIGN);
+    header->size = size;
+    header->sclass = SC_SLAB_LARGE;
   }
   else {
-    *malloc_count += ((ret == NULL) ? 0 : 1);
+    sclass = sc_slab_class (size + SC_SLAB_ALIGN);
+    cache = &sc_slab_cache;
+    if (cache->head[sclass] == NULL) {
+      sc_slab_refill (cache, sclass);
+    }
+    obj = cache->head[sclass];
+    cache->head[sclass] = obj->next;
+    --cache->count[sclass];
+
+    header = (sc_slab_header_t *) obj;
+    header->sclass = sclass;
   }
+  return (char *) header + SC_SLAB_ALIGN;
+}
+
+static void
+sc_slab_free (void *ptr)
+{
+  int                 sclass;
+  sc_slab_header_t   *header;
+  sc_slab_cache_t    *cache;
+  sc_slab_free_t     *obj;
+
+  SC_ASSERT (ptr != NULL);
+  header = (sc_slab_header_t *) ((char *) ptr - SC_SLAB_ALIGN);
+  sclass = header->sclass;
+  if (sclass == SC_SLAB_LARGE) {
+    sc_slab_raw_free (header);
+    return;
+  }
+  SC_ASSERT (0 <= sclass && sclass < SC_SLAB_NUM_CLASSES);
+
+  /* objects freed by a different thread migrate to this thread's cache */
+  cache = &sc_slab_cache;
 #ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
+  if (!cache->registered) {
+    sc_slab_register (cache);
+  }
+#endif
+  obj = (sc_slab_free_t *) header;
+  obj->next = cache->head[sclass];
+  cache->head[sclass] = obj;
+  if (++cache->count[sclass] >= 2 * sc_slab_batch (sclass)) {
+    (void) sc_slab_flush_batch (cache, sclass);
+  }
+}
+
+static void        *
+sc_slab_realloc (void *ptr, size_t size)
+{
+  size_t              old_size;
+  void               *ret;
+  sc_slab_header_t   *header;
+
+  SC_ASSERT (ptr != NULL && size > 0);
+  header = (sc_slab_header_t *) ((char *) ptr - SC_SLAB_ALIGN);
+  if (header->sclass == SC_SLAB_LARGE) {
+#ifndef SC_ENABLE_MEMALIGN
+    if (size > SC_SLAB_MAX_SIZE - SC_SLAB_ALIGN) {
+      /* the system allocator may be able to grow in place */
+      SC_CHECK_ABORTF (size <= SIZE_MAX - SC_SLAB_ALIGN,
+                       "Reallocation (realloc size %lli)",
+                       (long long int) size);
+      header = (sc_slab_header_t *) realloc (header, size + SC_SLAB_ALIGN);
+      SC_CHECK_ABORTF (header != NULL, "Reallocation (realloc size %lli)",
+                       (long long int) size);
+      header->size = size;
+      return (char *) header + SC_SLAB_ALIGN;
+    }
 #endif
+    old_size = header->size;
+  }
+  else {
+    old_size = sc_slab_stride (header->sclass) - SC_SLAB_ALIGN;
+    if (size <= old_size) {
+      /* the object already has enough room */
+      return ptr;
+    }
+  }
+
+  ret = sc_slab_malloc (size);
+  memcpy (ret, ptr, SC_MIN (old_size, size));
+  sc_slab_free (ptr);
+  return ret;
+}
+
+#endif /* SC_ENABLE_SLAB */
+
+void               *
+sc_malloc (int package, size_t size)
+{
+  void               *ret;
+  sc_alloc_count_t   *alloc_count = sc_alloc_count (package);
+
+  /* allocate memory */
+#if defined SC_ENABLE_SLAB
+  ret = sc_slab_malloc (size);
+#elif defined SC_ENABLE_MEMALIGN
+  ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, size);
+#else
+  ret = malloc (size);
+  if (size > 0) {
+    SC_CHECK_ABORTF (ret != NULL, "Allocation (malloc size %lli)",
+                     (long long int) size);
+  }
+#endif
+
+  /* count the allocations */
+  if (size > 0 || ret != NULL) {
+    sc_alloc_count_add (package, &alloc_count->malloc_count, 1);
+  }
 
   return ret;
 }
@@ -551,10 +996,13 @@ void               *
 sc_calloc (int package, size_t nmemb, size_t size)
 {
   void               *ret;
-  int                *malloc_count = sc_malloc_count (package);
+  sc_alloc_count_t   *alloc_count = sc_alloc_count (package);
 
   /* allocate memory */
-#if defined SC_ENABLE_MEMALIGN
+#if defined SC_ENABLE_SLAB
+  ret = sc_slab_malloc (nmemb * size);
+  memset (ret, 0, nmemb * size);
+#elif defined SC_ENABLE_MEMALIGN
   ret = sc_malloc_aligned (SC_MEMALIGN_BYTES, nmemb * size);
   memset (ret, 0, nmemb * size);
 #else
@@ -566,18 +1014,9 @@ sc_calloc (int package, size_t nmemb, size_t size)
 #endif
 
   /* count the allocations */
-#ifdef SC_ENABLE_PTHREAD
-  sc_package_lock (package);
-#endif
-  if (nmemb * size > 0) {
-    ++*malloc_count;
+  if (nmemb * size > 0 || ret != NULL) {
+    sc_alloc_count_add (package, &alloc_count->malloc_count, 1);
   }
-  else {
-    *malloc_count += ((ret == NULL) ? 0 : 1);
-  }
-#ifdef SC_ENABLE_PTHREAD
-  sc_package_unlock (package);
-#endif
 
   return ret;
 }
@@ -595,7 +1034,9 @@ sc_realloc (int package, void *ptr, size_t size)
   else {
     void               *ret;
 
-#if defined SC_ENABLE_MEMALIGN
+#if defined SC_ENABLE_SLAB
+    ret = sc_slab_realloc (ptr, size);
+#elif defined SC_ENABLE_MEMALIGN
     ret = sc_realloc_aligned (ptr, SC_MEMALIGN_BYTES, size);
 #else
     ret = realloc (ptr, size);
@@ -632,19 +1073,15 @@ sc_free (int package, void *ptr)
   }
   else {
     /* uncount the allocations */
-    int                *free_count = sc_free_count (package);
+    sc_alloc_count_t   *alloc_count = sc_alloc_count (package);
 
-#ifdef SC_ENABLE_PTHREAD
-    sc_package_lock (package);
-#endif
-    ++*free_count;
-#ifdef SC_ENABLE_PTHREAD
-    sc_package_unlock (package);
-#endif
+    sc_alloc_count_add (package, &alloc_count->free_count, 1);
   }
 
   /* free memory */
-#if defined SC_ENABLE_MEMALIGN
+#if defined SC_ENABLE_SLAB
+  sc_slab_free (ptr);
+#elif defined SC_ENABLE_MEMALIGN
   sc_free_aligned (ptr, SC_MEMALIGN_BYTES);
 #else
   free (ptr);
@@ -654,16 +1091,17 @@ sc_free (int package, void *ptr)
 int
 sc_memory_status (int package)
 {
-  sc_package_t       *p;
+  int                 malloc_count, free_count;
 
   if (package == -1) {
-    return (default_malloc_count - default_free_count);
+    sc_alloc_count_sum (default_alloc_count, &malloc_count, &free_count);
   }
   else {
     SC_ASSERT (sc_package_is_registered (package));
-    p = sc_packages + package;
-    return (p->malloc_count - p->free_count);
+    sc_alloc_count_sum (sc_packages[package].alloc_count,
+                        &malloc_count, &free_count);
   }
+  return malloc_count - free_count;
 }
 
 void
@@ -684,15 +1122,16 @@ sc_package_set_abort_alloc_mismatch (int package_id, int set_abort)
 void
 sc_memory_check (int package)
 {
+  int                 malloc_count, free_count;
   sc_package_t       *p;
 
   if (package == -1) {
     SC_CHECK_ABORT (default_rc_active == 0, "Leftover references (default)");
+    sc_alloc_count_sum (default_alloc_count, &malloc_count, &free_count);
     if (default_abort_mismatch) {
-      SC_CHECK_ABORT (default_malloc_count == default_free_count,
-                      "Memory balance (default)");
+      SC_CHECK_ABORT (malloc_count == free_count, "Memory balance (default)");
     }
-    else if (default_malloc_count != default_free_count) {
+    else if (malloc_count != free_count) {
       SC_GLOBAL_LERROR ("Memory balance (default)\n");
     }
   }
@@ -700,11 +1139,12 @@ sc_memory_check (int package)
     SC_ASSERT (sc_package_is_registered (package));
     p = sc_packages + package;
     SC_CHECK_ABORTF (p->rc_active == 0, "Leftover references (%s)", p->name);
+    sc_alloc_count_sum (p->alloc_count, &malloc_count, &free_count);
     if (p->abort_mismatch) {
-      SC_CHECK_ABORTF (p->malloc_count == p->free_count,
+      SC_CHECK_ABORTF (malloc_count == free_count,
                        "Memory balance (%s)", p->name);
     }
-    else if (p->malloc_count != p->free_count) {
+    else if (malloc_count != free_count) {
       SC_GLOBAL_LERRORF ("Memory balance (%s)\n", p->name);
     }
   }
@@ -1056,8 +1496,7 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
       p->log_handler = NULL;
       p->log_threshold = SC_LP_SILENT;
       p->log_indent = 0;
-      p->malloc_count = 0;
-      p->free_count = 0;
+      sc_alloc_count_reset (p->alloc_count);
       p->rc_active = 0;
       p->name = NULL;
       p->full = NULL;
@@ -1068,8 +1507,7 @@ sc_package_register (sc_log_handler_t log_handler, int log_threshold,
   new_package->log_handler = log_handler;
   new_package->log_threshold = log_threshold;
   new_package->log_indent = 0;
-  new_package->malloc_count = 0;
-  new_package->free_count = 0;
+  sc_alloc_count_reset (new_package->alloc_count);
   new_package->rc_active = 0;
   new_package->abort_mismatch = 1;
   new_package->name = name;
@@ -1127,7 +1565,7 @@ sc_package_unregister (int package_id)
   p->is_registered = 0;
   p->log_handler = NULL;
   p->log_threshold = SC_LP_DEFAULT;
-  p->malloc_count = p->free_count = 0;
+  sc_alloc_count_reset (p->alloc_count);
   p->rc_active = 0;
 #ifdef SC_ENABLE_PTHREAD
   i = pthread_mutex_destroy (&p->mutex);
@@ -1142,6 +1580,7 @@ void
 sc_package_print_summary (int log_priority)
 {
   int                 i;
+  int                 malloc_count, free_count;
   sc_package_t       *p;
 
   SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
@@ -1151,9 +1590,10 @@ sc_package_print_summary (int log_priority)
   for (i = 0; i < sc_num_packages_alloc; ++i) {
     p = sc_packages + i;
     if (p->is_registered) {
+      sc_alloc_count_sum (p->alloc_count, &malloc_count, &free_count);
       SC_GEN_LOGF (sc_package_id, SC_LC_GLOBAL, log_priority,
                    "   %3d: %-15s +%d-%d   %s\n",
-                   i, p->name, p->malloc_count, p->free_count, p->full);
+                   i, p->name, malloc_count, free_count, p->full);
     }
   }
 }
@@ -1283,6 +1723,8 @@ sc_finalize (void)
 #if defined(SC_ENABLE_MPI) && defined(SC_ENABLE_MPICOMMSHARED)
   sc_mpi_comm_detach_node_comms (sc_mpicomm);
 #endif
+  sc_notify_keyvals_free ();
+  sc_coll_keyval_free ();
 
   /* sc_packages is static and thus initialized to all zeros */
   for (i = sc_num_packages_alloc - 1; i >= 0; --i)
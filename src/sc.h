@@ -298,6 +298,13 @@ void                SC_CHECK_ABORTF (int success, const char *fmt, ...)
 #define SC_ATTR_ALIGN(n)
 #endif
 
+/* hint the processor to load the cache line of an address for reading */
+#if (defined __GNUC__) || (defined __clang__)
+#define SC_PREFETCH(p) __builtin_prefetch ((const void *) (p))
+#else
+#define SC_PREFETCH(p) SC_NOOP ()
+#endif
+
 /**
  * Sets n elements of a memory range to zero.
  * Assumes the pointer p is of the correct type.
@@ -491,6 +498,8 @@ typedef void        (*sc_log_handler_t) (FILE * log_stream,
 typedef void        (*sc_abort_handler_t) (void);
 
 /* memory allocation functions, will abort if out of memory */
+/* with --enable-slab, small sizes are served from thread-local caches;
+ * memory obtained this way must not be passed to the system's free */
 
 void               *sc_malloc (int package, size_t size);
 void               *sc_calloc (int package, size_t nmemb, size_t size);
@@ -165,3 +165,312 @@ sc_allgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
 
   return sc_MPI_SUCCESS;
 }
+
+void
+sc_allgatherv_alltoall (sc_MPI_Comm mpicomm, char *data,
+                        const size_t * offsets, int groupsize,
+                        int myoffset, int myrank)
+{
+  int                 j, peer;
+  int                 mpiret;
+  sc_MPI_Request     *request;
+
+  SC_ASSERT (myoffset >= 0 && myoffset < groupsize);
+
+  request = SC_ALLOC (sc_MPI_Request, 2 * groupsize);
+
+  for (j = 0; j < groupsize; ++j) {
+    if (j == myoffset) {
+      request[j] = request[groupsize + j] = sc_MPI_REQUEST_NULL;
+      continue;
+    }
+    peer = myrank - (myoffset - j);
+
+    mpiret = sc_MPI_Irecv (data + offsets[j],
+                           (int) (offsets[j + 1] - offsets[j]), sc_MPI_BYTE,
+                           peer, SC_TAG_AG_ALLTOALL, mpicomm, request + j);
+    SC_CHECK_MPI (mpiret);
+
+    mpiret = sc_MPI_Isend (data + offsets[myoffset],
+                           (int) (offsets[myoffset + 1] - offsets[myoffset]),
+                           sc_MPI_BYTE, peer, SC_TAG_AG_ALLTOALL,
+                           mpicomm, request + groupsize + j);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  mpiret = sc_MPI_Waitall (2 * groupsize, request, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  SC_FREE (request);
+}
+
+void
+sc_allgatherv_recursive (sc_MPI_Comm mpicomm, char *data,
+                         const size_t * offsets, int groupsize,
+                         int myoffset, int myrank)
+{
+  const int           g2 = groupsize / 2;
+  const int           g2B = groupsize - g2;
+  const int           lowsize = (int) (offsets[g2] - offsets[0]);
+  const int           highsize = (int) (offsets[groupsize] - offsets[g2]);
+  int                 mpiret;
+  sc_MPI_Request      request[3];
+
+  SC_ASSERT (myoffset >= 0 && myoffset < groupsize);
+
+  if (groupsize > SC_AG_ALLTOALL_MAX) {
+    /* the offsets are absolute, so data is the same for both halves */
+    if (myoffset < g2) {
+      sc_allgatherv_recursive (mpicomm, data, offsets, g2, myoffset, myrank);
+
+      mpiret = sc_MPI_Irecv (data + offsets[g2], highsize,
+                             sc_MPI_BYTE, myrank + g2, SC_TAG_AG_RECURSIVE_B,
+                             mpicomm, request + 0);
+      SC_CHECK_MPI (mpiret);
+
+      mpiret = sc_MPI_Isend (data + offsets[0], lowsize, sc_MPI_BYTE,
+                             myrank + g2, SC_TAG_AG_RECURSIVE_A,
+                             mpicomm, request + 1);
+      SC_CHECK_MPI (mpiret);
+
+      if (myoffset == g2 - 1 && g2 != g2B) {
+        mpiret = sc_MPI_Isend (data + offsets[0], lowsize, sc_MPI_BYTE,
+                               myrank + g2B, SC_TAG_AG_RECURSIVE_C,
+                               mpicomm, request + 2);
+        SC_CHECK_MPI (mpiret);
+      }
+      else {
+        request[2] = sc_MPI_REQUEST_NULL;
+      }
+    }
+    else {
+      sc_allgatherv_recursive (mpicomm, data, offsets + g2, g2B,
+                               myoffset - g2, myrank);
+
+      if (myoffset == groupsize - 1 && g2 != g2B) {
+        request[0] = sc_MPI_REQUEST_NULL;
+        request[1] = sc_MPI_REQUEST_NULL;
+
+        mpiret = sc_MPI_Irecv (data + offsets[0], lowsize, sc_MPI_BYTE,
+                               myrank - g2B, SC_TAG_AG_RECURSIVE_C,
+                               mpicomm, request + 2);
+        SC_CHECK_MPI (mpiret);
+      }
+      else {
+        mpiret = sc_MPI_Irecv (data + offsets[0], lowsize, sc_MPI_BYTE,
+                               myrank - g2, SC_TAG_AG_RECURSIVE_A,
+                               mpicomm, request + 0);
+        SC_CHECK_MPI (mpiret);
+
+        mpiret = sc_MPI_Isend (data + offsets[g2], highsize,
+                               sc_MPI_BYTE, myrank - g2,
+                               SC_TAG_AG_RECURSIVE_B, mpicomm, request + 1);
+        SC_CHECK_MPI (mpiret);
+
+        request[2] = sc_MPI_REQUEST_NULL;
+      }
+    }
+
+    mpiret = sc_MPI_Waitall (3, request, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  else {
+    sc_allgatherv_alltoall (mpicomm, data, offsets, groupsize, myoffset,
+                            myrank);
+  }
+}
+
+int
+sc_allgatherv (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+               void *recvbuf, int *recvcounts, int *displs,
+               sc_MPI_Datatype recvtype, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 i, packed;
+  char               *data;
+  size_t              typesize;
+  size_t             *offsets;
+
+  SC_ASSERT (sendcount >= 0);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* byte offsets of the blocks when stored without gaps */
+  typesize = sc_mpi_sizeof (recvtype);
+  offsets = SC_ALLOC (size_t, mpisize + 1);
+  offsets[0] = 0;
+  packed = 1;
+  for (i = 0; i < mpisize; ++i) {
+    SC_ASSERT (recvcounts[i] >= 0);
+    packed = packed && (size_t) displs[i] * typesize == offsets[i];
+    offsets[i + 1] = offsets[i] + (size_t) recvcounts[i] * typesize;
+  }
+  SC_ASSERT ((size_t) sendcount * sc_mpi_sizeof (sendtype) ==
+             offsets[mpirank + 1] - offsets[mpirank]);
+
+  data = packed ? (char *) recvbuf : SC_ALLOC (char, offsets[mpisize]);
+  memcpy (data + offsets[mpirank], sendbuf,
+          offsets[mpirank + 1] - offsets[mpirank]);
+  sc_allgatherv_recursive (mpicomm, data, offsets, mpisize, mpirank,
+                           mpirank);
+
+  if (!packed) {
+    for (i = 0; i < mpisize; ++i) {
+      memcpy ((char *) recvbuf + (size_t) displs[i] * typesize,
+              data + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    SC_FREE (data);
+  }
+  SC_FREE (offsets);
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_allgather_node (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+                   void *recvbuf, int recvcount, sc_MPI_Datatype recvtype,
+                   sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 intrasize, intrarank;
+  int                 numnodes, noderank;
+  size_t              datasize, nodesize;
+#ifdef SC_ENABLE_DEBUG
+  int                 mpirank;
+#endif
+  sc_MPI_Comm         intranode, internode;
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    return sc_allgather (sendbuf, sendcount, sendtype,
+                         recvbuf, recvcount, recvtype, mpicomm);
+  }
+
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (internode, &numnodes);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (internode, &noderank);
+  SC_CHECK_MPI (mpiret);
+#ifdef SC_ENABLE_DEBUG
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+#endif
+  SC_ASSERT (mpirank == noderank * intrasize + intrarank);
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) recvcount * sc_mpi_sizeof (recvtype);
+  /* *INDENT-ON* */
+  nodesize = intrasize * datasize;
+
+  /* the node leader collects the data of its node in place */
+  mpiret = sc_MPI_Gather (sendbuf, sendcount, sendtype,
+                          (char *) recvbuf + noderank * nodesize,
+                          recvcount, recvtype, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  /* only the leaders communicate between nodes */
+  if (intrarank == 0) {
+    sc_allgather_recursive (internode, (char *) recvbuf, (int) nodesize,
+                            numnodes, noderank, noderank);
+  }
+
+  mpiret = sc_MPI_Bcast (recvbuf, (int) (numnodes * nodesize), sc_MPI_BYTE,
+                         0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  return sc_MPI_SUCCESS;
+}
+
+void
+sc_allgather_schedule (sc_coll_t * coll, char *data, int datasize,
+                       int groupsize, int myoffset, int myrank)
+{
+  const int           g2 = groupsize / 2;
+  const int           g2B = groupsize - g2;
+  int                 j, peer;
+
+  SC_ASSERT (myoffset >= 0 && myoffset < groupsize);
+
+  if (groupsize > SC_AG_ALLTOALL_MAX) {
+    /* the same messages as in sc_allgather_recursive */
+    if (myoffset < g2) {
+      sc_allgather_schedule (coll, data, datasize, g2, myoffset, myrank);
+
+      sc_coll_recv (coll, data + g2 * datasize, g2B * datasize, myrank + g2);
+      sc_coll_send (coll, data, g2 * datasize, myrank + g2);
+      if (myoffset == g2 - 1 && g2 != g2B) {
+        sc_coll_send (coll, data, g2 * datasize, myrank + g2B);
+      }
+    }
+    else {
+      sc_allgather_schedule (coll, data + g2 * datasize, datasize, g2B,
+                             myoffset - g2, myrank);
+
+      if (myoffset == groupsize - 1 && g2 != g2B) {
+        sc_coll_recv (coll, data, g2 * datasize, myrank - g2B);
+      }
+      else {
+        sc_coll_recv (coll, data, g2 * datasize, myrank - g2);
+        sc_coll_send (coll, data + g2 * datasize, g2B * datasize,
+                      myrank - g2);
+      }
+    }
+  }
+  else {
+    for (j = 0; j < groupsize; ++j) {
+      if (j != myoffset) {
+        peer = myrank - (myoffset - j);
+        sc_coll_recv (coll, data + j * datasize, datasize, peer);
+        sc_coll_send (coll, data + myoffset * datasize, datasize, peer);
+      }
+    }
+  }
+  sc_coll_fence (coll);
+}
+
+int
+sc_iallgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, sc_MPI_Datatype recvtype,
+               sc_MPI_Comm mpicomm, sc_coll_t ** request)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  size_t              datasize;
+#ifdef SC_ENABLE_DEBUG
+  size_t              datasize2;
+#endif
+
+  SC_ASSERT (sendcount >= 0 && recvcount >= 0);
+  SC_ASSERT (request != NULL);
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+#ifdef SC_ENABLE_DEBUG
+  datasize2 = (size_t) recvcount * sc_mpi_sizeof (recvtype);
+#endif
+  /* *INDENT-ON* */
+
+  SC_ASSERT (datasize == datasize2);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  memcpy (((char *) recvbuf) + mpirank * datasize, sendbuf, datasize);
+  *request = sc_coll_new (mpicomm);
+  sc_allgather_schedule (*request, (char *) recvbuf, (int) datasize,
+                         mpisize, mpirank, mpirank);
+  sc_coll_start (*request);
+
+  return sc_MPI_SUCCESS;
+}
@@ -24,7 +24,7 @@
 #ifndef SC_ALLGATHER_H
 #define SC_ALLGATHER_H
 
-#include <sc.h>
+#include <sc_coll.h>
 
 #ifndef SC_AG_ALLTOALL_MAX
 #define SC_AG_ALLTOALL_MAX      5
@@ -53,6 +53,73 @@ int                 sc_allgather (void *sendbuf, int sendcount,
                                   int recvcount, sc_MPI_Datatype recvtype,
                                   sc_MPI_Comm mpicomm);
 
+/** Allgather blocks of different sizes by direct point-to-point messages.
+ * Only makes sense for small group sizes.
+ * \param [in] offsets     Byte offsets into \b data of the blocks of the
+ *                         group, in order and without gaps, followed by the
+ *                         offset one past the last block.
+ */
+void                sc_allgatherv_alltoall (sc_MPI_Comm mpicomm, char *data,
+                                            const size_t * offsets,
+                                            int groupsize, int myoffset,
+                                            int myrank);
+
+/** Performs recursive bisection allgather of blocks of different sizes.
+ * When size becomes small enough, calls \ref sc_allgatherv_alltoall.
+ * \param [in] offsets     Byte offsets into \b data of the blocks of the
+ *                         group, in order and without gaps, followed by the
+ *                         offset one past the last block.
+ */
+void                sc_allgatherv_recursive (sc_MPI_Comm mpicomm, char *data,
+                                             const size_t * offsets,
+                                             int groupsize, int myoffset,
+                                             int myrank);
+
+/** Drop-in allgatherv replacement.
+ * It uses the same recursive bisection as \ref sc_allgather.  If the
+ * displacements leave gaps or change the order of the blocks, the data is
+ * exchanged in a temporary buffer and copied into place afterwards.
+ */
+int                 sc_allgatherv (void *sendbuf, int sendcount,
+                                   sc_MPI_Datatype sendtype, void *recvbuf,
+                                   int *recvcounts, int *displs,
+                                   sc_MPI_Datatype recvtype,
+                                   sc_MPI_Comm mpicomm);
+
+/** Node-aware allgather replacement.
+ * If \ref sc_mpi_comm_attach_node_comms has been called on \b mpicomm,
+ * the data of each node is gathered by its first process, only these node
+ * leaders exchange data by \ref sc_allgather_recursive, and the result is
+ * broadcast within each node.  This divides the number of messages between
+ * nodes by the processes per node.  The ranks on each node must be numbered
+ * consecutively.  Without node communicators we call \ref sc_allgather.
+ */
+int                 sc_allgather_node (void *sendbuf, int sendcount,
+                                       sc_MPI_Datatype sendtype,
+                                       void *recvbuf, int recvcount,
+                                       sc_MPI_Datatype recvtype,
+                                       sc_MPI_Comm mpicomm);
+
+/** Add the messages of \ref sc_allgather_recursive to a schedule.
+ * The arguments other than \b coll are the same.  Each level of the
+ * recursion becomes one round of the schedule.
+ */
+void                sc_allgather_schedule (sc_coll_t * coll, char *data,
+                                           int datasize, int groupsize,
+                                           int myoffset, int myrank);
+
+/** Nonblocking allgather replacement.
+ * The send buffer may be reused on return.  The receive buffer is valid
+ * once \b request has been completed by \ref sc_coll_test or \ref
+ * sc_coll_wait.  All processes must start their nonblocking collectives on
+ * a communicator in the same order.
+ * \param [out] request   Handle of the collective in progress.
+ */
+int                 sc_iallgather (void *sendbuf, int sendcount,
+                                   sc_MPI_Datatype sendtype, void *recvbuf,
+                                   int recvcount, sc_MPI_Datatype recvtype,
+                                   sc_MPI_Comm mpicomm, sc_coll_t ** request);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_ALLGATHER_H */
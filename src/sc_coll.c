@@ -0,0 +1,337 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_coll.h>
+#include <sc_private.h>
+
+typedef enum sc_coll_step_type
+{
+  SC_COLL_SEND,
+  SC_COLL_RECV,
+  SC_COLL_FENCE,
+  SC_COLL_REDUCE,
+  SC_COLL_COPY
+}
+sc_coll_step_type_t;
+
+typedef struct sc_coll_step
+{
+  sc_coll_step_type_t type;
+  int                 peer;
+  int                 count;
+  size_t              size;
+  const void         *src;
+  void               *dest;
+  sc_MPI_Datatype     datatype;
+  sc_coll_reduce_t    reduce_fn;
+}
+sc_coll_step_t;
+
+struct sc_coll
+{
+  sc_MPI_Comm         mpicomm;
+  int                 tag;
+  int                 started;
+  int                 waiting;
+  size_t              next;
+  sc_array_t          steps;
+  sc_array_t          requests;
+  sc_array_t          scratch;
+};
+
+#ifdef SC_ENABLE_MPI
+
+static int          sc_coll_keyval = MPI_KEYVAL_INVALID;
+
+/** Give each pending collective on a communicator its own message tag.
+ * Rounds of different collectives may be posted in any order relative to
+ * each other, so they must not match each other's messages.  Within one
+ * collective, each pair of processes posts its messages in the same order.
+ * We count the collectives in an attribute stored in the communicator.
+ */
+static int
+sc_coll_tag (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 flag;
+  void               *value;
+  intptr_t            count;
+
+  if (sc_coll_keyval == MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_coll_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Comm_get_attr (mpicomm, sc_coll_keyval, &value, &flag);
+  SC_CHECK_MPI (mpiret);
+  count = flag ? (intptr_t) value : 0;
+  mpiret = MPI_Comm_set_attr (mpicomm, sc_coll_keyval, (void *) (count + 1));
+  SC_CHECK_MPI (mpiret);
+
+  return SC_TAG_COLL + (int) (count % SC_COLL_MAX_PENDING);
+}
+
+#endif
+
+void
+sc_coll_keyval_free (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  if (sc_coll_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_free_keyval (&sc_coll_keyval);
+    SC_CHECK_MPI (mpiret);
+    sc_coll_keyval = MPI_KEYVAL_INVALID;
+  }
+#endif
+}
+
+sc_coll_t          *
+sc_coll_new (sc_MPI_Comm mpicomm)
+{
+  sc_coll_t          *coll;
+
+  coll = SC_ALLOC (sc_coll_t, 1);
+  coll->mpicomm = mpicomm;
+#ifdef SC_ENABLE_MPI
+  coll->tag = sc_coll_tag (mpicomm);
+#else
+  coll->tag = SC_TAG_COLL;
+#endif
+  coll->started = 0;
+  coll->waiting = 0;
+  coll->next = 0;
+  sc_array_init (&coll->steps, sizeof (sc_coll_step_t));
+  sc_array_init (&coll->requests, sizeof (sc_MPI_Request));
+  sc_array_init (&coll->scratch, sizeof (void *));
+
+  return coll;
+}
+
+static void
+sc_coll_destroy (sc_coll_t * coll)
+{
+  size_t              zz;
+
+  SC_ASSERT (coll->requests.elem_count == 0);
+
+  for (zz = 0; zz < coll->scratch.elem_count; ++zz) {
+    SC_FREE (*(void **) sc_array_index (&coll->scratch, zz));
+  }
+  sc_array_reset (&coll->scratch);
+  sc_array_reset (&coll->requests);
+  sc_array_reset (&coll->steps);
+  SC_FREE (coll);
+}
+
+void               *
+sc_coll_alloc (sc_coll_t * coll, size_t size)
+{
+  void               *mem;
+
+  SC_ASSERT (!coll->started);
+
+  mem = SC_ALLOC (char, size);
+  *(void **) sc_array_push (&coll->scratch) = mem;
+
+  return mem;
+}
+
+static sc_coll_step_t *
+sc_coll_push (sc_coll_t * coll, sc_coll_step_type_t type)
+{
+  sc_coll_step_t     *step;
+
+  SC_ASSERT (!coll->started);
+
+  step = (sc_coll_step_t *) sc_array_push (&coll->steps);
+  memset (step, 0, sizeof (sc_coll_step_t));
+  step->type = type;
+
+  return step;
+}
+
+void
+sc_coll_send (sc_coll_t * coll, const void *buf, size_t size, int peer)
+{
+  sc_coll_step_t     *step = sc_coll_push (coll, SC_COLL_SEND);
+
+  step->peer = peer;
+  step->size = size;
+  step->src = buf;
+}
+
+void
+sc_coll_recv (sc_coll_t * coll, void *buf, size_t size, int peer)
+{
+  sc_coll_step_t     *step = sc_coll_push (coll, SC_COLL_RECV);
+
+  step->peer = peer;
+  step->size = size;
+  step->dest = buf;
+}
+
+void
+sc_coll_fence (sc_coll_t * coll)
+{
+  (void) sc_coll_push (coll, SC_COLL_FENCE);
+}
+
+void
+sc_coll_reduce (sc_coll_t * coll, sc_coll_reduce_t reduce_fn,
+                const void *sendbuf, void *recvbuf,
+                int count, sc_MPI_Datatype datatype)
+{
+  sc_coll_step_t     *step = sc_coll_push (coll, SC_COLL_REDUCE);
+
+  SC_ASSERT (reduce_fn != NULL);
+
+  step->reduce_fn = reduce_fn;
+  step->src = sendbuf;
+  step->dest = recvbuf;
+  step->count = count;
+  step->datatype = datatype;
+}
+
+void
+sc_coll_copy (sc_coll_t * coll, const void *src, void *dest, size_t size)
+{
+  sc_coll_step_t     *step = sc_coll_push (coll, SC_COLL_COPY);
+
+  step->src = src;
+  step->dest = dest;
+  step->size = size;
+}
+
+/** Execute steps until a fence with pending messages or the end.
+ * \return          True if the schedule has completed.
+ */
+static int
+sc_coll_progress (sc_coll_t * coll)
+{
+  int                 mpiret;
+  int                 flag;
+  sc_coll_step_t     *step;
+
+  SC_ASSERT (coll->started);
+
+  for (;;) {
+    if (coll->waiting) {
+      mpiret = sc_MPI_Testall ((int) coll->requests.elem_count,
+                               (sc_MPI_Request *) coll->requests.array,
+                               &flag, sc_MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (!flag) {
+        return 0;
+      }
+      sc_array_truncate (&coll->requests);
+      coll->waiting = 0;
+    }
+    if (coll->next == coll->steps.elem_count) {
+      return 1;
+    }
+
+    step = (sc_coll_step_t *) sc_array_index (&coll->steps, coll->next++);
+    switch (step->type) {
+    case SC_COLL_SEND:
+      mpiret = sc_MPI_Isend ((void *) step->src, (int) step->size,
+                             sc_MPI_BYTE, step->peer, coll->tag,
+                             coll->mpicomm, (sc_MPI_Request *)
+                             sc_array_push (&coll->requests));
+      SC_CHECK_MPI (mpiret);
+      break;
+    case SC_COLL_RECV:
+      mpiret = sc_MPI_Irecv (step->dest, (int) step->size,
+                             sc_MPI_BYTE, step->peer, coll->tag,
+                             coll->mpicomm, (sc_MPI_Request *)
+                             sc_array_push (&coll->requests));
+      SC_CHECK_MPI (mpiret);
+      break;
+    case SC_COLL_FENCE:
+      coll->waiting = coll->requests.elem_count > 0;
+      break;
+    case SC_COLL_REDUCE:
+      step->reduce_fn ((void *) step->src, step->dest,
+                       step->count, step->datatype);
+      break;
+    case SC_COLL_COPY:
+      memcpy (step->dest, step->src, step->size);
+      break;
+    default:
+      SC_ABORT_NOT_REACHED ();
+    }
+  }
+}
+
+void
+sc_coll_start (sc_coll_t * coll)
+{
+  SC_ASSERT (!coll->started);
+
+  /* messages of the last round must complete before we are done */
+  sc_coll_fence (coll);
+  coll->started = 1;
+
+  (void) sc_coll_progress (coll);
+}
+
+int
+sc_coll_test (sc_coll_t ** coll, int *flag)
+{
+  SC_ASSERT (coll != NULL && flag != NULL);
+
+  if (*coll == NULL) {
+    *flag = 1;
+  }
+  else if ((*flag = sc_coll_progress (*coll))) {
+    sc_coll_destroy (*coll);
+    *coll = NULL;
+  }
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_coll_wait (sc_coll_t ** coll)
+{
+  int                 mpiret;
+  sc_coll_t          *c;
+
+  SC_ASSERT (coll != NULL);
+
+  if ((c = *coll) == NULL) {
+    return sc_MPI_SUCCESS;
+  }
+  while (!sc_coll_progress (c)) {
+    mpiret = sc_MPI_Waitall ((int) c->requests.elem_count,
+                             (sc_MPI_Request *) c->requests.array,
+                             sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  sc_coll_destroy (c);
+  *coll = NULL;
+
+  return sc_MPI_SUCCESS;
+}
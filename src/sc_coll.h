@@ -0,0 +1,141 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+
+/** \file sc_coll.h
+ * Schedules of point-to-point messages that execute a collective operation
+ * without blocking.  A schedule is a sequence of rounds separated by fences.
+ * The messages of a round are posted together, and the local reductions and
+ * copies that follow a fence run once all messages before it have completed.
+ * The nonblocking collectives \ref sc_iallgather and \ref sc_iallreduce are
+ * built this way; the caller drives them by \ref sc_coll_test or completes
+ * them by \ref sc_coll_wait.
+ */
+
+#ifndef SC_COLL_H
+#define SC_COLL_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Local operation run between rounds of a schedule.
+ * It has the signature of \ref sc_reduce_t and combines \b sendbuf into
+ * \b recvbuf.
+ */
+typedef void        (*sc_coll_reduce_t) (void *sendbuf, void *recvbuf,
+                                         int sendcount,
+                                         sc_MPI_Datatype sendtype);
+
+/** Opaque handle of a collective in progress. */
+typedef struct sc_coll sc_coll_t;
+
+/** Create an empty schedule.
+ * Must be called collectively in the same order on all processes of the
+ * communicator, since it chooses the message tag of the collective.
+ * At most \ref SC_COLL_MAX_PENDING schedules may be pending at a time.
+ * \param [in] mpicomm          MPI communicator for all messages.
+ * \return                      A schedule to be filled and then started.
+ */
+sc_coll_t          *sc_coll_new (sc_MPI_Comm mpicomm);
+
+/** Allocate scratch memory that lives as long as the schedule.
+ * \param [in,out] coll         Schedule that is not yet started.
+ * \param [in] size             Number of bytes to allocate.
+ * \return                      Memory that is freed with the schedule.
+ */
+void               *sc_coll_alloc (sc_coll_t * coll, size_t size);
+
+/** Add a message to the current round of a schedule.
+ * \param [in,out] coll         Schedule that is not yet started.
+ * \param [in] buf              Data to send; must be valid and unchanged
+ *                              until the round has completed.
+ * \param [in] size             Number of bytes to send.
+ * \param [in] peer             Receiving rank.
+ */
+void                sc_coll_send (sc_coll_t * coll, const void *buf,
+                                  size_t size, int peer);
+
+/** Add a receive to the current round of a schedule.
+ * \param [in,out] coll         Schedule that is not yet started.
+ * \param [out] buf             Memory for at least \b size bytes.
+ * \param [in] size             Number of bytes to receive.
+ * \param [in] peer             Sending rank.
+ */
+void                sc_coll_recv (sc_coll_t * coll, void *buf,
+                                  size_t size, int peer);
+
+/** End the current round of a schedule.
+ * Steps added later start after all messages of the round have completed.
+ * \param [in,out] coll         Schedule that is not yet started.
+ */
+void                sc_coll_fence (sc_coll_t * coll);
+
+/** Add a local reduction to a schedule.
+ * It should follow a fence if it reads received data.
+ * \param [in,out] coll         Schedule that is not yet started.
+ * \param [in] reduce_fn        Operation combining \b sendbuf into \b recvbuf.
+ * \param [in] sendbuf          First argument of \b reduce_fn.
+ * \param [in,out] recvbuf      Second argument of \b reduce_fn.
+ * \param [in] count            Number of items in both buffers.
+ * \param [in] datatype         MPI datatype of the items.
+ */
+void                sc_coll_reduce (sc_coll_t * coll,
+                                    sc_coll_reduce_t reduce_fn,
+                                    const void *sendbuf, void *recvbuf,
+                                    int count, sc_MPI_Datatype datatype);
+
+/** Add a local copy to a schedule.
+ * \param [in,out] coll         Schedule that is not yet started.
+ * \param [in] src              Source of the copy.
+ * \param [out] dest            Destination of the copy.
+ * \param [in] size             Number of bytes to copy.
+ */
+void                sc_coll_copy (sc_coll_t * coll, const void *src,
+                                  void *dest, size_t size);
+
+/** Begin executing a schedule.
+ * The first round is posted and no more steps may be added.
+ * \param [in,out] coll         Schedule to execute.
+ */
+void                sc_coll_start (sc_coll_t * coll);
+
+/** Advance a started schedule as far as possible without blocking.
+ * \param [in,out] coll         Pointer to a started schedule.  If it has
+ *                              completed, it is freed and set to NULL.
+ *                              A pointer to NULL is complete already.
+ * \param [out] flag            True if the collective has completed.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_coll_test (sc_coll_t ** coll, int *flag);
+
+/** Complete a started schedule.
+ * \param [in,out] coll         Pointer to a started schedule or to NULL.
+ *                              The schedule is freed and set to NULL.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_coll_wait (sc_coll_t ** coll);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_COLL_H */
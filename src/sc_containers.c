@@ -25,6 +25,15 @@
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef SC_ENABLE_OPENMP
+#include <omp.h>
+#endif
+#if defined SC_HAVE_SYS_MMAN_H && defined SC_HAVE_MADVISE
+#include <sys/mman.h>
+#endif
 
 /* array routines */
 
@@ -281,6 +290,427 @@ sc_array_sort (sc_array_t * array, int (*compar) (const void *, const void *))
   qsort (array->array, array->elem_count, array->elem_size, compar);
 }
 
+/* the radix sort uses 8 bit digits */
+#define SC_ARRAY_RADIX 256
+
+/* below this many elements the radix sort does not use threads */
+#define SC_ARRAY_RADIX_THREADED_MIN 65536
+
+static inline       uint64_t
+sc_array_radix_key (const char *key, size_t key_size)
+{
+  uint32_t            k32;
+  uint64_t            k64;
+
+  if (key_size == sizeof (uint64_t)) {
+    memcpy (&k64, key, sizeof (uint64_t));
+    return k64;
+  }
+  memcpy (&k32, key, sizeof (uint32_t));
+  return k32;
+}
+
+/** Count the digits first_digit to last_digit - 1 of a range of keys.
+ * \param [in,out] counts  Histograms of SC_ARRAY_RADIX entries per digit.
+ */
+static void
+sc_array_radix_count (const char *base, size_t lo, size_t hi,
+                      size_t elem_size, size_t key_offset, size_t key_size,
+                      int first_digit, int last_digit, size_t * counts)
+{
+  int                 p;
+  size_t              zz;
+  uint64_t            key;
+
+  for (zz = lo; zz < hi; ++zz) {
+    key = sc_array_radix_key (base + zz * elem_size + key_offset, key_size);
+    for (p = first_digit; p < last_digit; ++p) {
+      ++counts[p * SC_ARRAY_RADIX + ((key >> (8 * p)) & 0xff)];
+    }
+  }
+}
+
+/** Move a range of elements to the positions given by their digit.
+ * \param [in,out] offsets On input the first position for every digit value.
+ */
+static void
+sc_array_radix_scatter (const char *src, char *dst, size_t lo, size_t hi,
+                        size_t elem_size, size_t key_offset,
+                        size_t key_size, int p, size_t * offsets)
+{
+  size_t              zz;
+  uint64_t            key;
+  const char         *elem;
+
+  for (zz = lo; zz < hi; ++zz) {
+    elem = src + zz * elem_size;
+    key = sc_array_radix_key (elem + key_offset, key_size);
+    memcpy (dst + offsets[(key >> (8 * p)) & 0xff]++ * elem_size,
+            elem, elem_size);
+  }
+}
+
+/** Sort an array by an unsigned integer key with an LSD radix sort.
+ * Every thread counts and moves one contiguous chunk of the array.
+ * Offsets are assigned by digit value first and thread second,
+ * so each pass and thus the whole sort is stable.
+ */
+static void
+sc_array_sort_radix (sc_array_t * array, size_t key_offset, size_t key_size)
+{
+  const size_t        n = array->elem_count;
+  const size_t        elem_size = array->elem_size;
+  const int           num_digits = (int) key_size;
+  const size_t        stride = (size_t) num_digits * SC_ARRAY_RADIX;
+  int                 num_threads, t, p, d;
+  int                 moved, trivial;
+  size_t              sum, c;
+  size_t             *counts, *pc;
+  char               *src, *dst, *swap;
+
+  SC_ASSERT (key_size == sizeof (uint32_t) || key_size == sizeof (uint64_t));
+  SC_ASSERT (key_offset + key_size <= elem_size);
+
+  if (n <= 1) {
+    return;
+  }
+  num_threads = 1;
+#ifdef SC_ENABLE_OPENMP
+  if (n >= SC_ARRAY_RADIX_THREADED_MIN) {
+    num_threads = omp_get_max_threads ();
+  }
+#endif
+
+  /* count all digits of all keys in one parallel pass */
+  src = array->array;
+  counts = SC_ALLOC_ZERO (size_t, num_threads * stride);
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+#endif
+  for (t = 0; t < num_threads; ++t) {
+    sc_array_radix_count (src, n * t / num_threads,
+                          n * (t + 1) / num_threads, elem_size, key_offset,
+                          key_size, 0, num_digits, counts + t * stride);
+  }
+
+  dst = SC_ALLOC (char, n * elem_size);
+  moved = 0;
+  for (p = 0; p < num_digits; ++p) {
+    /* skip digits that are equal for all keys */
+    trivial = 0;
+    for (d = 0; d < SC_ARRAY_RADIX; ++d) {
+      for (sum = 0, t = 0; t < num_threads; ++t) {
+        sum += counts[t * stride + p * SC_ARRAY_RADIX + d];
+      }
+      if (sum == n) {
+        trivial = 1;
+      }
+      if (sum > 0) {
+        break;
+      }
+    }
+    if (trivial) {
+      continue;
+    }
+
+    /* the chunks have changed content since the counting pass */
+    if (moved && num_threads > 1) {
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+#endif
+      for (t = 0; t < num_threads; ++t) {
+        memset (counts + t * stride + p * SC_ARRAY_RADIX, 0,
+                SC_ARRAY_RADIX * sizeof (size_t));
+        sc_array_radix_count (src, n * t / num_threads,
+                              n * (t + 1) / num_threads, elem_size,
+                              key_offset, key_size, p, p + 1,
+                              counts + t * stride);
+      }
+    }
+
+    /* turn the counts into offsets by digit value and then by thread */
+    sum = 0;
+    for (d = 0; d < SC_ARRAY_RADIX; ++d) {
+      for (t = 0; t < num_threads; ++t) {
+        pc = counts + t * stride + p * SC_ARRAY_RADIX + d;
+        c = *pc;
+        *pc = sum;
+        sum += c;
+      }
+    }
+    SC_ASSERT (sum == n);
+
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+#endif
+    for (t = 0; t < num_threads; ++t) {
+      sc_array_radix_scatter (src, dst, n * t / num_threads,
+                              n * (t + 1) / num_threads, elem_size,
+                              key_offset, key_size, p,
+                              counts + t * stride + p * SC_ARRAY_RADIX);
+    }
+    swap = src;
+    src = dst;
+    dst = swap;
+    moved = 1;
+  }
+
+  /* the sorted data may be in the temporary buffer */
+  if (src != array->array) {
+    memcpy (array->array, src, n * elem_size);
+    dst = src;
+  }
+  SC_FREE (dst);
+  SC_FREE (counts);
+}
+
+void
+sc_array_sort_key32 (sc_array_t * array, size_t key_offset)
+{
+  sc_array_sort_radix (array, key_offset, sizeof (uint32_t));
+}
+
+void
+sc_array_sort_key64 (sc_array_t * array, size_t key_offset)
+{
+  sc_array_sort_radix (array, key_offset, sizeof (uint64_t));
+}
+
+/* below this many elements the k-way merge does not use threads */
+#define SC_ARRAY_MERGE_THREADED_MIN 65536
+
+/** The state of a k-way merge of ranges of sorted runs. */
+typedef struct sc_array_merge
+{
+  size_t              num_runs, elem_size;
+  const char        **cur, **end;
+  size_t             *tree;     /**< loser per internal node, winner at 0 */
+  int                 (*compar) (const void *, const void *);
+}
+sc_array_merge_t;
+
+/** Order the current elements of two runs; exhausted runs come last.
+ * Ties are resolved by run index, which makes the merge stable.
+ */
+static inline int
+sc_array_merge_less (const sc_array_merge_t * m, size_t i, size_t j)
+{
+  int                 c;
+
+  if (m->cur[i] == m->end[i]) {
+    return 0;
+  }
+  if (m->cur[j] == m->end[j]) {
+    return 1;
+  }
+  c = m->compar (m->cur[i], m->cur[j]);
+  return c < 0 || (c == 0 && i < j);
+}
+
+/** Merge the ranges [cur, end) of all runs into out with a loser tree.
+ * Leaf i of the tree is node num_runs + i, and node n has children 2n and
+ * 2n + 1.  After taking the winner, only its path to the root is replayed.
+ */
+static void
+sc_array_merge_ranges (sc_array_merge_t * m, char *out)
+{
+  const size_t        k = m->num_runs;
+  const size_t        size = m->elem_size;
+  size_t              n, w, swap;
+  size_t             *winners;
+
+  /* play the initial tournament bottom up */
+  winners = SC_ALLOC (size_t, 2 * k);
+  for (n = 0; n < k; ++n) {
+    winners[k + n] = n;
+  }
+  for (n = k - 1; n >= 1; --n) {
+    if (sc_array_merge_less (m, winners[2 * n], winners[2 * n + 1])) {
+      winners[n] = winners[2 * n];
+      m->tree[n] = winners[2 * n + 1];
+    }
+    else {
+      winners[n] = winners[2 * n + 1];
+      m->tree[n] = winners[2 * n];
+    }
+  }
+  w = k > 1 ? winners[1] : 0;
+  SC_FREE (winners);
+
+  while (m->cur[w] != m->end[w]) {
+    memcpy (out, m->cur[w], size);
+    out += size;
+    m->cur[w] += size;
+
+    for (n = (k + w) / 2; n >= 1; n /= 2) {
+      if (sc_array_merge_less (m, m->tree[n], w)) {
+        swap = m->tree[n];
+        m->tree[n] = w;
+        w = swap;
+      }
+    }
+  }
+}
+
+/** Count the elements of a sorted run below an element.
+ * \param [in] upper    If true, count elements that are less or equal.
+ */
+static              size_t
+sc_array_merge_bound (sc_array_t * run, const void *elem, int upper,
+                      int (*compar) (const void *, const void *))
+{
+  size_t              lo, hi, mid;
+  int                 c;
+
+  lo = 0;
+  hi = run->elem_count;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    c = compar (sc_array_index (run, mid), elem);
+    if (c < 0 || (upper && c == 0)) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/** Find how many elements of each run are among the first d of the merge.
+ * We take the middle of the widest remaining window as a pivot, compute its
+ * rank in the merged output, and narrow the windows of all runs around it.
+ * \param [out] pos     The counts per run, which sum up to d.
+ */
+static void
+sc_array_merge_corank (sc_array_t ** runs, size_t num_runs, size_t d,
+                       int (*compar) (const void *, const void *),
+                       size_t * pos)
+{
+  size_t              i, j, p, r, width;
+  size_t             *hi, *cnt;
+  const void         *pivot;
+
+  hi = SC_ALLOC (size_t, num_runs);
+  cnt = SC_ALLOC (size_t, num_runs);
+  for (i = 0; i < num_runs; ++i) {
+    pos[i] = 0;
+    hi[i] = runs[i]->elem_count;
+  }
+  for (;;) {
+    j = 0;
+    width = 0;
+    for (i = 0; i < num_runs; ++i) {
+      if (hi[i] - pos[i] > width) {
+        j = i;
+        width = hi[i] - pos[i];
+      }
+    }
+    if (width == 0) {
+      break;
+    }
+
+    /* the rank of the pivot counts earlier runs' equal elements */
+    p = pos[j] + width / 2;
+    pivot = sc_array_index (runs[j], p);
+    r = 0;
+    for (i = 0; i < num_runs; ++i) {
+      cnt[i] = i == j ? p : sc_array_merge_bound (runs[i], pivot, i < j,
+                                                  compar);
+      r += cnt[i];
+    }
+    if (r < d) {
+      /* the pivot and everything before it are among the first d */
+      for (i = 0; i < num_runs; ++i) {
+        pos[i] = SC_MAX (pos[i], cnt[i] + (i == j));
+      }
+    }
+    else {
+      for (i = 0; i < num_runs; ++i) {
+        hi[i] = SC_MIN (hi[i], cnt[i]);
+      }
+    }
+  }
+#ifdef SC_ENABLE_DEBUG
+  for (r = 0, i = 0; i < num_runs; ++i) {
+    r += pos[i];
+  }
+  SC_ASSERT (r == d);
+#endif
+  SC_FREE (hi);
+  SC_FREE (cnt);
+}
+
+void
+sc_array_merge_k (sc_array_t * dest, sc_array_t ** runs, size_t num_runs,
+                  int (*compar) (const void *, const void *),
+                  int num_threads)
+{
+  const size_t        size = dest->elem_size;
+  int                 t;
+  size_t              i, total;
+  size_t             *splits;
+
+  total = 0;
+  for (i = 0; i < num_runs; ++i) {
+    SC_ASSERT (runs[i]->elem_size == size);
+    SC_ASSERT (runs[i] != dest);
+    total += runs[i]->elem_count;
+  }
+  sc_array_resize (dest, total);
+  if (total == 0) {
+    return;
+  }
+
+  if (num_threads <= 0) {
+#ifdef SC_ENABLE_OPENMP
+    num_threads = omp_get_max_threads ();
+#else
+    num_threads = 1;
+#endif
+  }
+  if (total < SC_ARRAY_MERGE_THREADED_MIN) {
+    num_threads = 1;
+  }
+
+  /* split the output evenly by co-ranking, unless there is one thread */
+  splits = SC_ALLOC (size_t, (num_threads + 1) * num_runs);
+  for (i = 0; i < num_runs; ++i) {
+    splits[i] = 0;
+    splits[num_threads * num_runs + i] = runs[i]->elem_count;
+  }
+  for (t = 1; t < num_threads; ++t) {
+    sc_array_merge_corank (runs, num_runs, total * t / num_threads,
+                           compar, splits + t * num_runs);
+  }
+
+#ifdef SC_ENABLE_OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+#endif
+  for (t = 0; t < num_threads; ++t) {
+    size_t              j, offset;
+    sc_array_merge_t    m;
+
+    m.num_runs = num_runs;
+    m.elem_size = size;
+    m.compar = compar;
+    m.cur = SC_ALLOC (const char *, num_runs);
+    m.end = SC_ALLOC (const char *, num_runs);
+    m.tree = SC_ALLOC (size_t, num_runs);
+    offset = 0;
+    for (j = 0; j < num_runs; ++j) {
+      m.cur[j] = runs[j]->array + splits[t * num_runs + j] * size;
+      m.end[j] = runs[j]->array + splits[(t + 1) * num_runs + j] * size;
+      offset += splits[t * num_runs + j];
+    }
+    sc_array_merge_ranges (&m, dest->array + offset * size);
+    SC_FREE (m.cur);
+    SC_FREE (m.end);
+    SC_FREE (m.tree);
+  }
+  SC_FREE (splits);
+}
+
 int
 sc_array_is_sorted (sc_array_t * array,
                     int (*compar) (const void *, const void *))
@@ -590,116 +1020,206 @@ sc_array_checksum (sc_array_t * array)
 #endif
 }
 
-size_t
-sc_array_pqueue_add (sc_array_t * array, void *temp,
-                     int (*compar) (const void *, const void *))
+/** Move an element up the heap until its parent is not greater.
+ * Instead of swapping, parents move down into a hole, and the element is
+ * written once at its final position.
+ * \param [in] temp    Memory of elem_size that holds the element meanwhile.
+ * \return             The number of levels moved.
+ */
+static              size_t
+sc_array_pqueue_sift_up (sc_array_t * array, size_t child, size_t arity,
+                         void *temp,
+                         int (*compar) (const void *, const void *))
 {
-  int                 comp;
-  size_t              parent, child, swaps;
   const size_t        size = array->elem_size;
-  void               *p, *c;
-
-  /* this works on a pre-allocated array that is not a view */
-  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
-  SC_ASSERT (array->elem_count > 0);
+  size_t              parent, moves;
+  char               *p;
 
-  /* PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED. */
-  SC_ABORT_NOT_REACHED ();
-
-  swaps = 0;
-  child = array->elem_count - 1;
-  c = array->array + (size * child);
+  moves = 0;
+  memcpy (temp, array->array + size * child, size);
   while (child > 0) {
-    parent = (child - 1) / 2;
-    p = array->array + (size * parent);
-
-    /* compare child to parent */
-    comp = compar (p, c);
-    if (comp <= 0) {
+    parent = (child - 1) / arity;
+    p = array->array + size * parent;
+    if (compar (p, temp) <= 0) {
       break;
     }
-
-    /* swap child and parent */
-    memcpy (temp, c, size);
-    memcpy (c, p, size);
-    memcpy (p, temp, size);
-    ++swaps;
-
-    /* walk up the tree */
+    memcpy (array->array + size * child, p, size);
     child = parent;
-    c = p;
+    ++moves;
+  }
+  if (moves > 0) {
+    memcpy (array->array + size * child, temp, size);
   }
 
-  return swaps;
+  return moves;
 }
 
-size_t
-sc_array_pqueue_pop (sc_array_t * array, void *result,
-                     int (*compar) (const void *, const void *))
+/** Fill a hole at parent with an element by moving it down the heap.
+ * The smallest child moves up into the hole while it is less than elem.
+ * \param [in] count   The number of valid heap elements.
+ * \param [in] elem    The element to place; must not be in [0, count).
+ * \return             The number of levels moved.
+ */
+static              size_t
+sc_array_pqueue_sift_down (sc_array_t * array, size_t parent, size_t count,
+                           size_t arity, const void *elem,
+                           int (*compar) (const void *, const void *))
 {
-  int                 comp;
-  size_t              new_count, swaps;
-  size_t              parent, child, child1;
   const size_t        size = array->elem_size;
-  void               *p, *c, *c1;
-  void               *temp;
+  size_t              first, last, child, best, moves;
+  char               *c, *b;
+
+  moves = 0;
+  while ((first = arity * parent + 1) < count) {
+    /* find the smallest of up to arity children */
+    last = SC_MIN (first + arity, count);
+    best = first;
+    b = array->array + size * first;
+    for (child = first + 1; child < last; ++child) {
+      c = array->array + size * child;
+      if (compar (c, b) < 0) {
+        best = child;
+        b = c;
+      }
+    }
+    if (compar (elem, b) <= 0) {
+      break;
+    }
+    memcpy (array->array + size * parent, b, size);
+    parent = best;
+    ++moves;
+  }
+  memcpy (array->array + size * parent, elem, size);
+
+  return moves;
+}
+
+static              size_t
+sc_array_pqueue_pop_arity (sc_array_t * array, void *result, size_t arity,
+                           int (*compar) (const void *, const void *))
+{
+  const size_t        new_count = array->elem_count - 1;
+  size_t              moves;
 
   /* array must not be empty or a view */
   SC_ASSERT (SC_ARRAY_IS_OWNER (array));
   SC_ASSERT (array->elem_count > 0);
 
-  /* PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED. */
-  SC_ABORT_NOT_REACHED ();
+  /* extract root and fill the hole with the last element */
+  memcpy (result, array->array, array->elem_size);
+  moves = 0;
+  if (new_count > 0) {
+    moves = sc_array_pqueue_sift_down (array, 0, new_count, arity,
+                                       array->array +
+                                       array->elem_size * new_count, compar);
+  }
 
-  swaps = 0;
-  new_count = array->elem_count - 1;
+  /* we can resize down here only since we need the last element above */
+  sc_array_resize (array, new_count);
 
-  /* extract root */
-  parent = 0;
-  p = array->array + (size * parent);
-  memcpy (result, p, size);
+  return moves;
+}
 
-  /* copy the last element to the top and reuse it as temp storage */
-  temp = array->array + (size * new_count);
-  if (new_count > 0) {
-    memcpy (p, temp, size);
+static              size_t
+sc_array_pqueue_pop_push_arity (sc_array_t * array, void *result,
+                                const void *elem, size_t arity,
+                                int (*compar) (const void *, const void *))
+{
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+  SC_ASSERT (array->elem_count > 0);
+  SC_ASSERT (result != elem);
+
+  memcpy (result, array->array, array->elem_size);
+  return sc_array_pqueue_sift_down (array, 0, array->elem_count, arity,
+                                    elem, compar);
+}
+
+static void
+sc_array_pqueue_heapify_arity (sc_array_t * array, void *temp, size_t arity,
+                               int (*compar) (const void *, const void *))
+{
+  const size_t        count = array->elem_count;
+  size_t              parent;
+
+  if (count <= 1) {
+    return;
   }
 
-  /* sift down the tree */
-  while ((child = 2 * parent + 1) < new_count) {
-    c = array->array + (size * child);
+  /* sift down every parent from the last one up, which is O(count) */
+  parent = (count - 2) / arity + 1;
+  while (parent-- > 0) {
+    memcpy (temp, array->array + array->elem_size * parent,
+            array->elem_size);
+    (void) sc_array_pqueue_sift_down (array, parent, count, arity, temp,
+                                      compar);
+  }
+}
 
-    /* check if child has a sibling and use that one if it is smaller */
-    if ((child1 = 2 * parent + 2) < new_count) {
-      c1 = array->array + (size * child1);
-      comp = compar (c, c1);
-      if (comp > 0) {
-        child = child1;
-        c = c1;
-      }
-    }
+size_t
+sc_array_pqueue_add (sc_array_t * array, void *temp,
+                     int (*compar) (const void *, const void *))
+{
+  /* this works on a pre-allocated array that is not a view */
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+  SC_ASSERT (array->elem_count > 0);
 
-    /* sift down the parent if it is larger */
-    comp = compar (p, c);
-    if (comp <= 0) {
-      break;
-    }
+  return sc_array_pqueue_sift_up (array, array->elem_count - 1, 2, temp,
+                                  compar);
+}
 
-    /* swap child and parent */
-    memcpy (temp, c, size);
-    memcpy (c, p, size);
-    memcpy (p, temp, size);
-    ++swaps;
+size_t
+sc_array_pqueue_pop (sc_array_t * array, void *result,
+                     int (*compar) (const void *, const void *))
+{
+  return sc_array_pqueue_pop_arity (array, result, 2, compar);
+}
 
-    /* walk down the tree */
-    parent = child;
-    p = c;
-  }
+size_t
+sc_array_pqueue_pop_push (sc_array_t * array, void *result,
+                          const void *elem,
+                          int (*compar) (const void *, const void *))
+{
+  return sc_array_pqueue_pop_push_arity (array, result, elem, 2, compar);
+}
 
-  /* we can resize down here only since we need the temp element above */
-  sc_array_resize (array, new_count);
+void
+sc_array_pqueue_heapify (sc_array_t * array, void *temp,
+                         int (*compar) (const void *, const void *))
+{
+  sc_array_pqueue_heapify_arity (array, temp, 2, compar);
+}
+
+size_t
+sc_array_pqueue4_add (sc_array_t * array, void *temp,
+                      int (*compar) (const void *, const void *))
+{
+  SC_ASSERT (SC_ARRAY_IS_OWNER (array));
+  SC_ASSERT (array->elem_count > 0);
+
+  return sc_array_pqueue_sift_up (array, array->elem_count - 1, 4, temp,
+                                  compar);
+}
+
+size_t
+sc_array_pqueue4_pop (sc_array_t * array, void *result,
+                      int (*compar) (const void *, const void *))
+{
+  return sc_array_pqueue_pop_arity (array, result, 4, compar);
+}
+
+size_t
+sc_array_pqueue4_pop_push (sc_array_t * array, void *result,
+                           const void *elem,
+                           int (*compar) (const void *, const void *))
+{
+  return sc_array_pqueue_pop_push_arity (array, result, elem, 4, compar);
+}
 
-  return swaps;
+void
+sc_array_pqueue4_heapify (sc_array_t * array, void *temp,
+                          int (*compar) (const void *, const void *))
+{
+  sc_array_pqueue_heapify_arity (array, temp, 4, compar);
 }
 
 /* mempool routines */
@@ -728,37 +1248,87 @@ sc_containers_free (void *p)
 
 static void         (*obstack_chunk_free) (void *) = sc_containers_free;
 
+/** Allocate a page-aligned obstack chunk.
+ * The pointer returned by sc_malloc is stored right in front of the chunk.
+ */
+static void        *
+sc_containers_malloc_pages (size_t n)
+{
+  size_t              page;
+  char               *alloc_ptr, *ptr;
+
+  page = (size_t) sysconf (_SC_PAGESIZE);
+  SC_ASSERT (page >= sizeof (void *) && (page & (page - 1)) == 0);
+
+  alloc_ptr = (char *) sc_malloc (sc_package_id, n + page + sizeof (void *));
+  ptr = (char *) SC_ALIGN_UP ((size_t) (alloc_ptr + sizeof (void *)), page);
+  ((char **) ptr)[-1] = alloc_ptr;
+
+#if defined SC_HAVE_MADVISE && defined MADV_HUGEPAGE
+  if (n >= ((size_t) 1 << 21)) {
+    /* this is only a hint; the system may ignore or reject it */
+    (void) madvise (ptr, n / page * page, MADV_HUGEPAGE);
+  }
+#endif
+
+  return ptr;
+}
+
+static void
+sc_containers_free_pages (void *p)
+{
+  sc_free (sc_package_id, ((char **) p)[-1]);
+}
+
+static void
+sc_mempool_obstack_init (sc_mempool_t * mempool)
+{
+  if (mempool->chunk_bytes == 0) {
+    obstack_init (&mempool->obstack);
+  }
+  else {
+    obstack_specify_allocation (&mempool->obstack,
+                                (int) mempool->chunk_bytes, 0,
+                                sc_containers_malloc_pages,
+                                sc_containers_free_pages);
+  }
+}
+
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static void
 sc_mempool_init_ext (sc_mempool_t * mempool, size_t elem_size,
-                     int zero_and_persist)
+                     int zero_and_persist, size_t chunk_bytes)
 {
   mempool->elem_size = elem_size;
   mempool->elem_count = 0;
   mempool->zero_and_persist = zero_and_persist;
+  mempool->chunk_bytes = chunk_bytes;
 
-  obstack_init (&mempool->obstack);
+  sc_mempool_obstack_init (mempool);
   sc_array_init (&mempool->freed, sizeof (void *));
 }
 
 void
 sc_mempool_init (sc_mempool_t * mempool, size_t elem_size)
 {
-  sc_mempool_init_ext (mempool, elem_size, 0);
+  sc_mempool_init_ext (mempool, elem_size, 0, 0);
 }
 
 /** This function is static; we do not like to expose _ext functions in libsc. */
 static sc_mempool_t *
-sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
+sc_mempool_new_ext (size_t elem_size, int zero_and_persist,
+                    size_t chunk_bytes)
 {
   sc_mempool_t       *mempool;
 
   SC_ASSERT (elem_size > 0);
   SC_ASSERT (elem_size <= (size_t) INT_MAX);    /* obstack limited to int */
+  SC_ASSERT (chunk_bytes == 0 ||
+             (elem_size < chunk_bytes && chunk_bytes <= (size_t) INT_MAX));
 
   mempool = SC_ALLOC (sc_mempool_t, 1);
 
-  sc_mempool_init_ext (mempool, elem_size, zero_and_persist);
+  sc_mempool_init_ext (mempool, elem_size, zero_and_persist, chunk_bytes);
 
   return mempool;
 }
@@ -766,13 +1336,20 @@ sc_mempool_new_ext (size_t elem_size, int zero_and_persist)
 sc_mempool_t       *
 sc_mempool_new (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 0);
+  return sc_mempool_new_ext (elem_size, 0, 0);
 }
 
 sc_mempool_t       *
 sc_mempool_new_zero_and_persist (size_t elem_size)
 {
-  return sc_mempool_new_ext (elem_size, 1);
+  return sc_mempool_new_ext (elem_size, 1, 0);
+}
+
+sc_mempool_t       *
+sc_mempool_new_chunked (size_t elem_size, size_t chunk_bytes)
+{
+  SC_ASSERT (chunk_bytes > 0);
+  return sc_mempool_new_ext (elem_size, 0, chunk_bytes);
 }
 
 void
@@ -794,18 +1371,271 @@ sc_mempool_truncate (sc_mempool_t * mempool)
 {
   sc_array_reset (&mempool->freed);
   obstack_free (&mempool->obstack, NULL);
-  obstack_init (&mempool->obstack);
+  sc_mempool_obstack_init (mempool);
   mempool->elem_count = 0;
 }
 
-/* list routines */
-
-size_t
-sc_list_memory_used (sc_list_t * list, int is_dynamic)
-{
-  return (is_dynamic ? sizeof (sc_list_t) : 0) +
-    (list->allocator_owned ? sc_mempool_memory_used (list->allocator) : 0);
-}
+void
+sc_mempool_alloc_many (sc_mempool_t * mempool, size_t n, void **ptrs)
+{
+  size_t              i, k, stride;
+  char               *block;
+  sc_array_t         *freed = &mempool->freed;
+  struct obstack     *obstack = &mempool->obstack;
+
+  mempool->elem_count += n;
+
+  /* recycle previously freed elements */
+  k = SC_MIN (n, freed->elem_count);
+  if (k > 0) {
+    memcpy (ptrs, sc_array_index (freed, freed->elem_count - k),
+            k * sizeof (void *));
+    sc_array_resize (freed, freed->elem_count - k);
+  }
+
+  /* carve the remaining elements from the chunks with obstack alignment */
+  stride = SC_ALIGN_UP (mempool->elem_size,
+                        (size_t) obstack_alignment_mask (obstack) + 1);
+  i = k;
+  while (i < n) {
+    k = SC_MIN (n - i, (size_t) obstack_room (obstack) / stride);
+    if (k == 0) {
+      /* the current chunk is full and this call starts a new one */
+      k = 1;
+      block = (char *) obstack_alloc (obstack, (int) mempool->elem_size);
+    }
+    else {
+      block = (char *) obstack_alloc (obstack, (int) (k * stride));
+    }
+    if (mempool->zero_and_persist) {
+      memset (block, 0, (k - 1) * stride + mempool->elem_size);
+    }
+    for (; k > 0; --k, ++i, block += stride) {
+      ptrs[i] = block;
+    }
+  }
+
+#ifdef SC_ENABLE_DEBUG
+  if (!mempool->zero_and_persist) {
+    for (i = 0; i < n; ++i) {
+      memset (ptrs[i], -1, mempool->elem_size);
+    }
+  }
+#endif
+}
+
+/** The header in front of each element of a multithreaded pool. */
+typedef struct sc_mempool_mt_elem
+{
+  struct sc_mempool_mt_elem *next;      /**< next free element */
+  int                 owner;    /**< index of the allocating thread */
+}
+sc_mempool_mt_elem_t;
+
+/** The pool of one thread.  Only the return queue is accessed by other
+ * threads.  The padding keeps the queues of neighbors on separate cache lines.
+ */
+struct sc_mempool_mt_local
+{
+  struct obstack      obstack;  /**< holds the elements of this thread */
+  sc_mempool_mt_elem_t *free;   /**< elements freed by this thread */
+  sc_mempool_mt_elem_t *volatile queue; /**< elements freed by others */
+  long                count;    /**< allocations minus frees by this thread */
+  char                padding[64];
+};
+
+/** Push an element onto the return queue of another thread. */
+static inline void
+sc_mempool_mt_push (struct sc_mempool_mt_local *local,
+                    sc_mempool_mt_elem_t * elem)
+{
+#if defined __GNUC__ || defined __clang__
+  sc_mempool_mt_elem_t *head;
+
+  do {
+    head = local->queue;
+    elem->next = head;
+  } while (!__sync_bool_compare_and_swap (&local->queue, head, elem));
+#else
+  elem->next = local->queue;
+  local->queue = elem;
+#endif
+}
+
+/** Take all elements from the return queue of the calling thread.
+ * Since only the owner removes elements, this is free of the ABA problem.
+ */
+static inline sc_mempool_mt_elem_t *
+sc_mempool_mt_take (struct sc_mempool_mt_local *local)
+{
+#if defined __GNUC__ || defined __clang__
+  return __sync_lock_test_and_set (&local->queue, NULL);
+#else
+  sc_mempool_mt_elem_t *head = local->queue;
+
+  local->queue = NULL;
+  return head;
+#endif
+}
+
+size_t
+sc_mempool_mt_memory_used (sc_mempool_mt_t * mempool)
+{
+  int                 i;
+  size_t              size;
+
+  size = sizeof (sc_mempool_mt_t) +
+    mempool->num_threads * sizeof (struct sc_mempool_mt_local);
+  for (i = 0; i < mempool->num_threads; ++i) {
+    size += obstack_memory_used (&mempool->locals[i].obstack);
+  }
+  return size;
+}
+
+sc_mempool_mt_t    *
+sc_mempool_mt_new (size_t elem_size, int num_threads)
+{
+  int                 i;
+  sc_mempool_mt_t    *mempool;
+  struct sc_mempool_mt_local *local;
+
+  SC_ASSERT (elem_size > 0);
+  SC_ASSERT (num_threads > 0);
+
+  mempool = SC_ALLOC (sc_mempool_mt_t, 1);
+  mempool->elem_size = elem_size;
+  mempool->num_threads = num_threads;
+
+  /* keep the element as aligned as the header */
+  mempool->header_size = SC_ALIGN_UP (sizeof (sc_mempool_mt_elem_t),
+                                      2 * sizeof (void *));
+  SC_ASSERT (mempool->header_size + elem_size <= (size_t) INT_MAX);
+
+  mempool->locals = SC_ALLOC (struct sc_mempool_mt_local, num_threads);
+  for (i = 0; i < num_threads; ++i) {
+    local = mempool->locals + i;
+    obstack_init (&local->obstack);
+    local->free = NULL;
+    local->queue = NULL;
+    local->count = 0;
+  }
+
+  return mempool;
+}
+
+void
+sc_mempool_mt_destroy (sc_mempool_mt_t * mempool)
+{
+  int                 i;
+
+  for (i = 0; i < mempool->num_threads; ++i) {
+    obstack_free (&mempool->locals[i].obstack, NULL);
+  }
+  SC_FREE (mempool->locals);
+  SC_FREE (mempool);
+}
+
+void               *
+sc_mempool_mt_alloc (sc_mempool_mt_t * mempool, int thread)
+{
+  struct sc_mempool_mt_local *local;
+  sc_mempool_mt_elem_t *elem;
+
+  SC_ASSERT (0 <= thread && thread < mempool->num_threads);
+  local = mempool->locals + thread;
+  ++local->count;
+
+  /* recycle elements freed by this thread, then those freed by others */
+  if (local->free == NULL && local->queue != NULL) {
+    local->free = sc_mempool_mt_take (local);
+  }
+  if (local->free != NULL) {
+    elem = local->free;
+    local->free = elem->next;
+  }
+  else {
+    elem = (sc_mempool_mt_elem_t *)
+      obstack_alloc (&local->obstack,
+                     (int) (mempool->header_size + mempool->elem_size));
+    elem->owner = thread;
+  }
+  SC_ASSERT (elem->owner == thread);
+
+#ifdef SC_ENABLE_DEBUG
+  memset ((char *) elem + mempool->header_size, -1, mempool->elem_size);
+#endif
+
+  return (char *) elem + mempool->header_size;
+}
+
+void
+sc_mempool_mt_free (sc_mempool_mt_t * mempool, int thread, void *elem)
+{
+  sc_mempool_mt_elem_t *header;
+  struct sc_mempool_mt_local *local;
+
+  SC_ASSERT (0 <= thread && thread < mempool->num_threads);
+  header = (sc_mempool_mt_elem_t *) ((char *) elem - mempool->header_size);
+  SC_ASSERT (0 <= header->owner && header->owner < mempool->num_threads);
+
+#ifdef SC_ENABLE_DEBUG
+  memset (elem, -1, mempool->elem_size);
+#endif
+
+  local = mempool->locals + thread;
+  --local->count;
+  if (header->owner == thread) {
+    header->next = local->free;
+    local->free = header;
+  }
+  else {
+    sc_mempool_mt_push (mempool->locals + header->owner, header);
+  }
+}
+
+size_t
+sc_mempool_mt_count (sc_mempool_mt_t * mempool)
+{
+  int                 i;
+  long                count;
+
+  count = 0;
+  for (i = 0; i < mempool->num_threads; ++i) {
+    count += mempool->locals[i].count;
+  }
+  return (size_t) SC_MAX (count, 0);
+}
+
+/* list routines */
+
+/** Allocate a link from the allocator of the list. */
+static inline sc_link_t *
+sc_list_alloc_link (sc_list_t * list)
+{
+  if (list->allocator_mt != NULL) {
+    return (sc_link_t *) sc_mempool_mt_alloc (list->allocator_mt,
+                                              list->allocator_thread);
+  }
+  return (sc_link_t *) sc_mempool_alloc (list->allocator);
+}
+
+/** Return a link to the allocator of the list. */
+static inline void
+sc_list_free_link (sc_list_t * list, sc_link_t * lynk)
+{
+  if (list->allocator_mt != NULL) {
+    sc_mempool_mt_free (list->allocator_mt, list->allocator_thread, lynk);
+    return;
+  }
+  sc_mempool_free (list->allocator, lynk);
+}
+
+size_t
+sc_list_memory_used (sc_list_t * list, int is_dynamic)
+{
+  return (is_dynamic ? sizeof (sc_list_t) : 0) +
+    (list->allocator_owned ? sc_mempool_memory_used (list->allocator) : 0);
+}
 
 sc_list_t          *
 sc_list_new (sc_mempool_t * allocator)
@@ -819,7 +1649,7 @@ sc_list_new (sc_mempool_t * allocator)
   list->last = NULL;
 
   if (allocator != NULL) {
-    SC_ASSERT (allocator->elem_size == sizeof (sc_link_t));
+    SC_ASSERT (allocator->elem_size >= sizeof (sc_link_t));
     list->allocator = allocator;
     list->allocator_owned = 0;
   }
@@ -827,6 +1657,19 @@ sc_list_new (sc_mempool_t * allocator)
     list->allocator = sc_mempool_new (sizeof (sc_link_t));
     list->allocator_owned = 1;
   }
+  list->allocator_mt = NULL;
+  list->allocator_thread = 0;
+
+  return list;
+}
+
+sc_list_t          *
+sc_list_new_mt (sc_mempool_mt_t * allocator, int thread)
+{
+  sc_list_t          *list;
+
+  list = SC_ALLOC (sc_list_t, 1);
+  sc_list_init_mt (list, allocator, thread);
 
   return list;
 }
@@ -853,10 +1696,38 @@ sc_list_init (sc_list_t * list, sc_mempool_t * allocator)
   list->last = NULL;
 
   SC_ASSERT (allocator != NULL);
-  SC_ASSERT (allocator->elem_size == sizeof (sc_link_t));
+  SC_ASSERT (allocator->elem_size >= sizeof (sc_link_t));
 
   list->allocator = allocator;
   list->allocator_owned = 0;
+  list->allocator_mt = NULL;
+  list->allocator_thread = 0;
+}
+
+void
+sc_list_init_mt (sc_list_t * list, sc_mempool_mt_t * allocator, int thread)
+{
+  list->elem_count = 0;
+  list->first = NULL;
+  list->last = NULL;
+
+  SC_ASSERT (allocator != NULL);
+  SC_ASSERT (allocator->elem_size >= sizeof (sc_link_t));
+  SC_ASSERT (0 <= thread && thread < allocator->num_threads);
+
+  list->allocator = NULL;
+  list->allocator_owned = 0;
+  list->allocator_mt = allocator;
+  list->allocator_thread = thread;
+}
+
+void
+sc_list_set_thread (sc_list_t * list, int thread)
+{
+  SC_ASSERT (list->allocator_mt != NULL);
+  SC_ASSERT (0 <= thread && thread < list->allocator_mt->num_threads);
+
+  list->allocator_thread = thread;
 }
 
 void
@@ -868,7 +1739,7 @@ sc_list_reset (sc_list_t * list)
   lynk = list->first;
   while (lynk != NULL) {
     temp = lynk->next;
-    sc_mempool_free (list->allocator, lynk);
+    sc_list_free_link (list, lynk);
     lynk = temp;
     --list->elem_count;
   }
@@ -889,7 +1760,7 @@ sc_list_prepend (sc_list_t * list, void *data)
 {
   sc_link_t          *lynk;
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = list->first;
   list->first = lynk;
@@ -906,7 +1777,7 @@ sc_list_append (sc_list_t * list, void *data)
 {
   sc_link_t          *lynk;
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = NULL;
   if (list->last != NULL) {
@@ -928,7 +1799,7 @@ sc_list_insert (sc_list_t * list, sc_link_t * pred, void *data)
 
   SC_ASSERT (pred != NULL);
 
-  lynk = (sc_link_t *) sc_mempool_alloc (list->allocator);
+  lynk = sc_list_alloc_link (list);
   lynk->data = data;
   lynk->next = pred->next;
   pred->next = lynk;
@@ -959,7 +1830,7 @@ sc_list_remove (sc_list_t * list, sc_link_t * pred)
   if (list->last == lynk) {
     list->last = pred;
   }
-  sc_mempool_free (list->allocator, lynk);
+  sc_list_free_link (list, lynk);
 
   --list->elem_count;
   return data;
@@ -976,7 +1847,7 @@ sc_list_pop (sc_list_t * list)
   lynk = list->first;
   list->first = lynk->next;
   data = lynk->data;
-  sc_mempool_free (list->allocator, lynk);
+  sc_list_free_link (list, lynk);
   if (list->first == NULL) {
     list->last = NULL;
   }
@@ -987,44 +1858,80 @@ sc_list_pop (sc_list_t * list)
 
 /* hash table routines */
 
+unsigned
+sc_hash_function_bytes (const void *ptr, size_t len)
+{
+  /* This is MurmurHash64A by Austin Appleby, public domain.
+   * We load eight bytes per step with memcpy, which is safe for any
+   * alignment and compiles into a single load on common architectures. */
+  const uint64_t      m = 0xc6a4a7935bd1e995ULL;
+  const int           r = 47;
+  const unsigned char *p = (const unsigned char *) ptr;
+  const unsigned char *end = p + (len & ~(size_t) 7);
+  uint64_t            h, k;
+
+  h = 0x8445d61a4e774912ULL ^ ((uint64_t) len * m);
+  for (; p != end; p += 8) {
+    memcpy (&k, p, 8);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  switch (len & 7) {
+  case 7:
+    h ^= (uint64_t) p[6] << 48;
+    /* fall through */
+  case 6:
+    h ^= (uint64_t) p[5] << 40;
+    /* fall through */
+  case 5:
+    h ^= (uint64_t) p[4] << 32;
+    /* fall through */
+  case 4:
+    h ^= (uint64_t) p[3] << 24;
+    /* fall through */
+  case 3:
+    h ^= (uint64_t) p[2] << 16;
+    /* fall through */
+  case 2:
+    h ^= (uint64_t) p[1] << 8;
+    /* fall through */
+  case 1:
+    h ^= (uint64_t) p[0];
+    h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+
+  return (unsigned) (h ^ (h >> 32));
+}
+
 unsigned
 sc_hash_function_string (const void *s, const void *u)
 {
-  int                 j;
-  unsigned            h;
-  unsigned            a, b, c;
-  const char         *sp = (const char *) s;
+  /* strlen never reads beyond the terminating null byte's memory page */
+  return sc_hash_function_bytes (s, strlen ((const char *) s));
+}
 
-  j = 0;
-  h = 0;
-  a = b = c = 0;
-  for (;;) {
-    if (*sp) {
-      h += *sp++;
-    }
+/** Scramble the user's hash value where we only use its lowest bits.
+ * This is the finalizer of MurmurHash3 by Austin Appleby, public domain. */
+static inline       uint32_t
+sc_hash_scramble (unsigned h)
+{
+  uint32_t            x = (uint32_t) h;
 
-    if (++j == 4) {
-      a += h;
-      h = 0;
-    }
-    else if (j == 8) {
-      b += h;
-      h = 0;
-    }
-    else if (j == 12) {
-      c += h;
-      sc_hash_mix (a, b, c);
-      if (!*sp) {
-        sc_hash_final (a, b, c);
-        return c;
-      }
-      j = 0;
-      h = 0;
-    }
-    else {
-      h <<= 8;
-    }
-  }
+  x ^= x >> 16;
+  x *= 0x85ebca6bU;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35U;
+  x ^= x >> 16;
+
+  return x;
 }
 
 size_t
@@ -1036,33 +1943,98 @@ sc_hash_memory_used (sc_hash_t * hash)
 }
 
 static const size_t sc_hash_minimal_size = (size_t) ((1 << 8) - 1);
+static const size_t sc_hash_minimal_size_pow2 = (size_t) (1 << 8);
 static const size_t sc_hash_shrink_interval = (size_t) (1 << 8);
 
+/** Compute the index of a slot from the return value of hash_fn.
+ * \param [out] hval   The hash value, scrambled in power-of-two mode.
+ * \return             The slot index.
+ */
+static inline       size_t
+sc_hash_slot_of (sc_hash_t * hash, unsigned h, uint32_t * hval)
+{
+  if (hash->pow2_mode) {
+    *hval = sc_hash_scramble (h);
+    return (size_t) *hval & (hash->slots->elem_count - 1);
+  }
+  *hval = (uint32_t) h;
+  return h % hash->slots->elem_count;
+}
+
+/** Compute the hash value of an object and the index of its slot.
+ * \param [out] hval   The hash value, scrambled in power-of-two mode.
+ * \return             The slot index.
+ */
+static inline       size_t
+sc_hash_slot (sc_hash_t * hash, void *v, uint32_t * hval)
+{
+  return sc_hash_slot_of (hash, hash->hash_fn (v, hash->user_data), hval);
+}
+
+/** Compare the cached hash value, if any, before calling equal_fn. */
+static inline int
+sc_hash_link_equal (sc_hash_t * hash, sc_link_t * lynk, void *v,
+                    uint32_t hval)
+{
+  return (!hash->pow2_mode || ((sc_hash_link_t *) lynk)->hval == hval) &&
+    hash->equal_fn (lynk->data, v, hash->user_data);
+}
+
+/** Move all links of the old slots to the new slots without allocation.
+ * The cached hash values determine the new slot of each link.
+ */
 static void
-sc_hash_maybe_resize (sc_hash_t * hash)
+sc_hash_relink_pow2 (sc_array_t * old_slots, sc_array_t * new_slots)
 {
   size_t              i, j;
-  size_t              new_size, new_count;
+  const size_t        mask = new_slots->elem_count - 1;
   sc_list_t          *old_list, *new_list;
   sc_link_t          *lynk, *temp;
-  sc_array_t         *new_slots;
-  sc_array_t         *old_slots = hash->slots;
 
-  SC_ASSERT (old_slots->elem_count > 0);
+  for (i = 0; i < old_slots->elem_count; ++i) {
+    old_list = (sc_list_t *) sc_array_index (old_slots, i);
+    lynk = old_list->first;
+    while (lynk != NULL) {
+      temp = lynk->next;
+
+      /* prepend link to the new slot list */
+      j = (size_t) ((sc_hash_link_t *) lynk)->hval & mask;
+      new_list = (sc_list_t *) sc_array_index (new_slots, j);
+      lynk->next = new_list->first;
+      new_list->first = lynk;
+      if (new_list->last == NULL) {
+        new_list->last = lynk;
+      }
+      ++new_list->elem_count;
 
-  ++hash->resize_checks;
-  if (hash->elem_count >= 4 * old_slots->elem_count) {
-    new_size = 4 * old_slots->elem_count - 1;
-  }
-  else if (hash->elem_count <= old_slots->elem_count / 4) {
-    new_size = old_slots->elem_count / 4 + 1;
-    if (new_size < sc_hash_minimal_size) {
-      return;
+      lynk = temp;
     }
+    sc_list_unlink (old_list);
+  }
+}
+
+/** Initialize a slot list with the link allocator of the hash table. */
+static inline void
+sc_hash_list_init (sc_hash_t * hash, sc_list_t * list)
+{
+  if (hash->allocator_mt != NULL) {
+    sc_list_init_mt (list, hash->allocator_mt, hash->allocator_thread);
   }
   else {
-    return;
+    sc_list_init (list, hash->allocator);
   }
+}
+
+static void
+sc_hash_resize (sc_hash_t * hash, size_t new_size)
+{
+  size_t              i, j;
+  size_t              new_count;
+  sc_list_t          *old_list, *new_list;
+  sc_link_t          *lynk, *temp;
+  sc_array_t         *new_slots;
+  sc_array_t         *old_slots = hash->slots;
+
   ++hash->resize_actions;
 
   /* allocate new slot array */
@@ -1070,7 +2042,15 @@ sc_hash_maybe_resize (sc_hash_t * hash)
   sc_array_resize (new_slots, new_size);
   for (i = 0; i < new_size; ++i) {
     new_list = (sc_list_t *) sc_array_index (new_slots, i);
-    sc_list_init (new_list, hash->allocator);
+    sc_hash_list_init (hash, new_list);
+  }
+
+  if (hash->pow2_mode) {
+    /* the links are reused and the hash function is not called */
+    sc_hash_relink_pow2 (old_slots, new_slots);
+    sc_array_destroy (old_slots);
+    hash->slots = new_slots;
+    return;
   }
 
   /* go through the old slots and move data to the new slots */
@@ -1087,7 +2067,7 @@ sc_hash_maybe_resize (sc_hash_t * hash)
 
       /* remove old list element */
       temp = lynk->next;
-      sc_mempool_free (old_list->allocator, lynk);
+      sc_list_free_link (old_list, lynk);
       lynk = temp;
       --old_list->elem_count;
     }
@@ -1101,26 +2081,90 @@ sc_hash_maybe_resize (sc_hash_t * hash)
   hash->slots = new_slots;
 }
 
-sc_hash_t          *
-sc_hash_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
-             void *user_data, sc_mempool_t * allocator)
+static void
+sc_hash_maybe_resize (sc_hash_t * hash)
+{
+  size_t              new_size;
+  const size_t        old_size = hash->slots->elem_count;
+
+  SC_ASSERT (old_size > 0);
+
+  ++hash->resize_checks;
+  if (hash->elem_count >= 4 * old_size) {
+    new_size = 4 * old_size - (hash->pow2_mode ? 0 : 1);
+  }
+  else if (hash->elem_count <= old_size / 4) {
+    if (hash->pow2_mode) {
+      new_size = old_size / 4;
+      if (new_size < sc_hash_minimal_size_pow2) {
+        return;
+      }
+    }
+    else {
+      new_size = old_size / 4 + 1;
+      if (new_size < sc_hash_minimal_size) {
+        return;
+      }
+    }
+  }
+  else {
+    return;
+  }
+  sc_hash_resize (hash, new_size);
+}
+
+/** Grow the slot array at once to the size that the automatic resizing
+ * would reach after inserting objects up to a total of \a count.
+ * \return             True if the slot array has been reallocated.
+ */
+static int
+sc_hash_presize (sc_hash_t * hash, size_t count)
+{
+  size_t              new_size = hash->slots->elem_count;
+
+  while (count >= 4 * new_size) {
+    new_size = 4 * new_size - (hash->pow2_mode ? 0 : 1);
+  }
+  if (new_size == hash->slots->elem_count) {
+    return 0;
+  }
+  ++hash->resize_checks;
+  sc_hash_resize (hash, new_size);
+  return 1;
+}
+
+/** This function is static; we do not like to expose _ext functions in libsc. */
+static sc_hash_t   *
+sc_hash_new_ext (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+                 void *user_data, sc_mempool_t * allocator,
+                 sc_mempool_mt_t * allocator_mt, int thread, int pow2_mode)
 {
   size_t              i;
+  const size_t        link_size =
+    pow2_mode ? sizeof (sc_hash_link_t) : sizeof (sc_link_t);
   sc_hash_t          *hash;
   sc_list_t          *list;
   sc_array_t         *slots;
 
   hash = SC_ALLOC (sc_hash_t, 1);
 
-  if (allocator != NULL) {
-    SC_ASSERT (allocator->elem_size == sizeof (sc_link_t));
+  if (allocator_mt != NULL) {
+    SC_ASSERT (allocator == NULL);
+    SC_ASSERT (allocator_mt->elem_size == link_size);
+    hash->allocator = NULL;
+    hash->allocator_owned = 0;
+  }
+  else if (allocator != NULL) {
+    SC_ASSERT (allocator->elem_size == link_size);
     hash->allocator = allocator;
     hash->allocator_owned = 0;
   }
   else {
-    hash->allocator = sc_mempool_new (sizeof (sc_link_t));
+    hash->allocator = sc_mempool_new (link_size);
     hash->allocator_owned = 1;
   }
+  hash->allocator_mt = allocator_mt;
+  hash->allocator_thread = thread;
 
   hash->elem_count = 0;
   hash->resize_checks = 0;
@@ -1128,17 +2172,60 @@ sc_hash_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
   hash->hash_fn = hash_fn;
   hash->equal_fn = equal_fn;
   hash->user_data = user_data;
+  hash->pow2_mode = pow2_mode;
 
   hash->slots = slots = sc_array_new (sizeof (sc_list_t));
-  sc_array_resize (slots, sc_hash_minimal_size);
+  sc_array_resize (slots, pow2_mode ?
+                   sc_hash_minimal_size_pow2 : sc_hash_minimal_size);
   for (i = 0; i < slots->elem_count; ++i) {
     list = (sc_list_t *) sc_array_index (slots, i);
-    sc_list_init (list, hash->allocator);
+    sc_hash_list_init (hash, list);
   }
 
   return hash;
 }
 
+sc_hash_t          *
+sc_hash_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+             void *user_data, sc_mempool_t * allocator)
+{
+  return sc_hash_new_ext (hash_fn, equal_fn, user_data, allocator,
+                          NULL, 0, 0);
+}
+
+sc_hash_t          *
+sc_hash_new_pow2 (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+                  void *user_data, sc_mempool_t * allocator)
+{
+  return sc_hash_new_ext (hash_fn, equal_fn, user_data, allocator,
+                          NULL, 0, 1);
+}
+
+sc_hash_t          *
+sc_hash_new_mt (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+                void *user_data, sc_mempool_mt_t * allocator, int thread)
+{
+  SC_ASSERT (allocator != NULL);
+  SC_ASSERT (0 <= thread && thread < allocator->num_threads);
+
+  return sc_hash_new_ext (hash_fn, equal_fn, user_data, NULL,
+                          allocator, thread, 1);
+}
+
+void
+sc_hash_set_thread (sc_hash_t * hash, int thread)
+{
+  size_t              i;
+
+  SC_ASSERT (hash->allocator_mt != NULL);
+
+  hash->allocator_thread = thread;
+  for (i = 0; i < hash->slots->elem_count; ++i) {
+    sc_list_set_thread ((sc_list_t *) sc_array_index (hash->slots, i),
+                        thread);
+  }
+}
+
 void
 sc_hash_destroy (sc_hash_t * hash)
 {
@@ -1212,19 +2299,19 @@ sc_hash_unlink_destroy (sc_hash_t * hash)
   SC_FREE (hash);
 }
 
-int
-sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
+/** Lookup with the slot and hash value computed by sc_hash_slot. */
+static int
+sc_hash_lookup_slot (sc_hash_t * hash, void *v, size_t slot, uint32_t hval,
+                     void ***found)
 {
-  size_t              hval;
   sc_list_t          *list;
   sc_link_t          *lynk;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
-  list = (sc_list_t *) sc_array_index (hash->slots, hval);
+  list = (sc_list_t *) sc_array_index (hash->slots, slot);
 
   for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
     /* check if an equal object is contained in the hash table */
-    if (hash->equal_fn (lynk->data, v, hash->user_data)) {
+    if (sc_hash_link_equal (hash, lynk, v, hval)) {
       if (found != NULL) {
         *found = &lynk->data;
       }
@@ -1235,18 +2322,28 @@ sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
 }
 
 int
-sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
+sc_hash_lookup (sc_hash_t * hash, void *v, void ***found)
 {
-  size_t              hval;
-  sc_list_t          *list;
-  sc_link_t          *lynk;
+  size_t              slot;
+  uint32_t            hval;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
-  list = (sc_list_t *) sc_array_index (hash->slots, hval);
+  slot = sc_hash_slot (hash, v, &hval);
+  return sc_hash_lookup_slot (hash, v, slot, hval, found);
+}
+
+/** Insertion with the slot and hash value computed by sc_hash_slot. */
+static int
+sc_hash_insert_unique_slot (sc_hash_t * hash, void *v, size_t slot,
+                            uint32_t hval, void ***found)
+{
+  sc_list_t          *list;
+  sc_link_t          *lynk;
+
+  list = (sc_list_t *) sc_array_index (hash->slots, slot);
 
   /* check if an equal object is already contained in the hash table */
   for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
-    if (hash->equal_fn (lynk->data, v, hash->user_data)) {
+    if (sc_hash_link_equal (hash, lynk, v, hval)) {
       if (found != NULL) {
         *found = &lynk->data;
       }
@@ -1255,7 +2352,10 @@ sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
   }
 
   /* append new object to the list */
-  (void) sc_list_append (list, v);
+  lynk = sc_list_append (list, v);
+  if (hash->pow2_mode) {
+    ((sc_hash_link_t *) lynk)->hval = hval;
+  }
   if (found != NULL) {
     *found = &list->last->data;
   }
@@ -1273,19 +2373,29 @@ sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
 }
 
 int
-sc_hash_remove (sc_hash_t * hash, void *v, void **found)
+sc_hash_insert_unique (sc_hash_t * hash, void *v, void ***found)
+{
+  size_t              slot;
+  uint32_t            hval;
+
+  slot = sc_hash_slot (hash, v, &hval);
+  return sc_hash_insert_unique_slot (hash, v, slot, hval, found);
+}
+
+/** Removal with the slot and hash value computed by sc_hash_slot. */
+static int
+sc_hash_remove_slot (sc_hash_t * hash, void *v, size_t slot, uint32_t hval,
+                     void **found)
 {
-  size_t              hval;
   sc_list_t          *list;
   sc_link_t          *lynk, *prev;
 
-  hval = hash->hash_fn (v, hash->user_data) % hash->slots->elem_count;
-  list = (sc_list_t *) sc_array_index (hash->slots, hval);
+  list = (sc_list_t *) sc_array_index (hash->slots, slot);
 
   prev = NULL;
   for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
     /* check if an equal object is contained in the hash table */
-    if (hash->equal_fn (lynk->data, v, hash->user_data)) {
+    if (sc_hash_link_equal (hash, lynk, v, hval)) {
       if (found != NULL) {
         *found = lynk->data;
       }
@@ -1303,6 +2413,16 @@ sc_hash_remove (sc_hash_t * hash, void *v, void **found)
   return 0;
 }
 
+int
+sc_hash_remove (sc_hash_t * hash, void *v, void **found)
+{
+  size_t              slot;
+  uint32_t            hval;
+
+  slot = sc_hash_slot (hash, v, &hval);
+  return sc_hash_remove_slot (hash, v, slot, hval, found);
+}
+
 void
 sc_hash_foreach (sc_hash_t * hash, sc_hash_foreach_t fn)
 {
@@ -1350,6 +2470,578 @@ sc_hash_print_statistics (int package_id, int log_priority, sc_hash_t * hash)
                (unsigned long) hash->resize_actions);
 }
 
+/* open addressing hash table routines */
+
+/** One slot of an open addressing hash table.
+ * The probe distance dist is zero for an empty slot and otherwise one
+ * plus the number of positions the entry is displaced from its home slot.
+ */
+typedef struct sc_hash_open_entry
+{
+  void               *data;
+  uint32_t            hval;
+  uint32_t            dist;
+}
+sc_hash_open_entry_t;
+
+static const size_t sc_hash_open_minimal_size = (size_t) (1 << 8);
+
+static sc_array_t  *
+sc_hash_open_new_slots (size_t size)
+{
+  sc_array_t         *slots;
+
+  SC_ASSERT (size > 0 && (size & (size - 1)) == 0);
+
+  slots = sc_array_new_count (sizeof (sc_hash_open_entry_t), size);
+  sc_array_memset (slots, 0);
+
+  return slots;
+}
+
+/** Place an object known not to be contained, starting at a given position.
+ * Entries that are closer to their home slot are displaced further.
+ * \return      The address of the data pointer of the placed object.
+ */
+static void       **
+sc_hash_open_place (sc_array_t * slots, void *v, uint32_t hval,
+                    size_t pos, uint32_t dist)
+{
+  const size_t        mask = slots->elem_count - 1;
+  sc_hash_open_entry_t *entries = (sc_hash_open_entry_t *) slots->array;
+  sc_hash_open_entry_t cur, temp, *e;
+  void              **result = NULL;
+
+  cur.data = v;
+  cur.hval = hval;
+  cur.dist = dist;
+  for (;; pos = (pos + 1) & mask, ++cur.dist) {
+    e = entries + pos;
+    if (e->dist == 0) {
+      *e = cur;
+      return result != NULL ? result : &e->data;
+    }
+    if (e->dist < cur.dist) {
+      /* the resident entry is richer than the current one: swap */
+      temp = *e;
+      *e = cur;
+      cur = temp;
+      if (result == NULL) {
+        result = &e->data;
+      }
+    }
+  }
+}
+
+static void
+sc_hash_open_rehash (sc_hash_open_t * hash, size_t new_size)
+{
+  size_t              zz;
+  sc_array_t         *old_slots = hash->slots;
+  sc_array_t         *new_slots;
+  sc_hash_open_entry_t *e;
+
+  ++hash->resize_actions;
+  new_slots = sc_hash_open_new_slots (new_size);
+
+  /* the cached hash values make calling hash_fn again unnecessary */
+  e = (sc_hash_open_entry_t *) old_slots->array;
+  for (zz = 0; zz < old_slots->elem_count; ++zz, ++e) {
+    if (e->dist > 0) {
+      (void) sc_hash_open_place (new_slots, e->data, e->hval,
+                                 e->hval & (new_size - 1), 1);
+    }
+  }
+
+  sc_array_destroy (old_slots);
+  hash->slots = new_slots;
+}
+
+size_t
+sc_hash_open_memory_used (sc_hash_open_t * hash)
+{
+  return sizeof (sc_hash_open_t) + sc_array_memory_used (hash->slots, 1);
+}
+
+sc_hash_open_t     *
+sc_hash_open_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+                  void *user_data)
+{
+  sc_hash_open_t     *hash;
+
+  hash = SC_ALLOC (sc_hash_open_t, 1);
+
+  hash->elem_count = 0;
+  hash->resize_checks = 0;
+  hash->resize_actions = 0;
+  hash->hash_fn = hash_fn;
+  hash->equal_fn = equal_fn;
+  hash->user_data = user_data;
+  hash->slots = sc_hash_open_new_slots (sc_hash_open_minimal_size);
+
+  return hash;
+}
+
+void
+sc_hash_open_destroy (sc_hash_open_t * hash)
+{
+  sc_array_destroy (hash->slots);
+
+  SC_FREE (hash);
+}
+
+void
+sc_hash_open_truncate (sc_hash_open_t * hash)
+{
+  if (hash->slots->elem_count == sc_hash_open_minimal_size) {
+    sc_array_memset (hash->slots, 0);
+  }
+  else {
+    sc_array_destroy (hash->slots);
+    hash->slots = sc_hash_open_new_slots (sc_hash_open_minimal_size);
+  }
+  hash->elem_count = 0;
+}
+
+/** Search for an object.
+ * \param [out] pos     The slot of the object if found, otherwise the
+ *                      slot where the object would be placed.
+ * \param [out] dist    The probe distance corresponding to \a pos.
+ * \return              True if the object is found.
+ */
+static int
+sc_hash_open_probe (sc_hash_open_t * hash, void *v, uint32_t hval,
+                    size_t * pos, uint32_t * dist)
+{
+  const size_t        mask = hash->slots->elem_count - 1;
+  sc_hash_open_entry_t *entries =
+    (sc_hash_open_entry_t *) hash->slots->array;
+  sc_hash_open_entry_t *e;
+  size_t              p;
+  uint32_t            d;
+
+  for (p = hval & mask, d = 1;; p = (p + 1) & mask, ++d) {
+    e = entries + p;
+    if (e->dist < d) {
+      /* an empty slot or an entry closer to home ends the search */
+      break;
+    }
+    if (e->hval == hval && hash->equal_fn (e->data, v, hash->user_data)) {
+      *pos = p;
+      *dist = d;
+      return 1;
+    }
+  }
+  *pos = p;
+  *dist = d;
+  return 0;
+}
+
+int
+sc_hash_open_lookup (sc_hash_open_t * hash, void *v, void ***found)
+{
+  size_t              pos;
+  uint32_t            dist;
+
+  if (sc_hash_open_probe (hash, v, sc_hash_scramble
+                          (hash->hash_fn (v, hash->user_data)),
+                          &pos, &dist)) {
+    if (found != NULL) {
+      *found = &((sc_hash_open_entry_t *) hash->slots->array)[pos].data;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+int
+sc_hash_open_insert_unique (sc_hash_open_t * hash, void *v, void ***found)
+{
+  size_t              pos, size;
+  uint32_t            hval, dist;
+  void              **placed;
+
+  hval = sc_hash_scramble (hash->hash_fn (v, hash->user_data));
+  if (sc_hash_open_probe (hash, v, hval, &pos, &dist)) {
+    if (found != NULL) {
+      *found = &((sc_hash_open_entry_t *) hash->slots->array)[pos].data;
+    }
+    return 0;
+  }
+
+  /* keep the load factor at or below 7/8 */
+  ++hash->resize_checks;
+  size = hash->slots->elem_count;
+  if (8 * (hash->elem_count + 1) > 7 * size) {
+    sc_hash_open_rehash (hash, 2 * size);
+    pos = hval & (2 * size - 1);
+    dist = 1;
+  }
+
+  placed = sc_hash_open_place (hash->slots, v, hval, pos, dist);
+  if (found != NULL) {
+    *found = placed;
+  }
+  ++hash->elem_count;
+
+  return 1;
+}
+
+int
+sc_hash_open_remove (sc_hash_open_t * hash, void *v, void **found)
+{
+  size_t              pos, next, mask, size;
+  uint32_t            dist;
+  sc_hash_open_entry_t *entries;
+
+  if (!sc_hash_open_probe (hash, v, sc_hash_scramble
+                           (hash->hash_fn (v, hash->user_data)),
+                           &pos, &dist)) {
+    return 0;
+  }
+
+  size = hash->slots->elem_count;
+  mask = size - 1;
+  entries = (sc_hash_open_entry_t *) hash->slots->array;
+  if (found != NULL) {
+    *found = entries[pos].data;
+  }
+
+  /* shift the following displaced entries back by one slot */
+  for (next = (pos + 1) & mask; entries[next].dist > 1;
+       pos = next, next = (next + 1) & mask) {
+    entries[pos] = entries[next];
+    --entries[pos].dist;
+  }
+  entries[pos].data = NULL;
+  entries[pos].dist = 0;
+  --hash->elem_count;
+
+  /* shrink when the load factor drops below 1/8 */
+  ++hash->resize_checks;
+  if (size > sc_hash_open_minimal_size && 8 * hash->elem_count < size) {
+    sc_hash_open_rehash (hash, size / 2);
+  }
+
+  return 1;
+}
+
+void
+sc_hash_open_foreach (sc_hash_open_t * hash, sc_hash_foreach_t fn)
+{
+  size_t              zz;
+  sc_hash_open_entry_t *e;
+
+  e = (sc_hash_open_entry_t *) hash->slots->array;
+  for (zz = 0; zz < hash->slots->elem_count; ++zz, ++e) {
+    if (e->dist > 0 && !fn (&e->data, hash->user_data)) {
+      return;
+    }
+  }
+}
+
+void
+sc_hash_open_print_statistics (int package_id, int log_priority,
+                               sc_hash_open_t * hash)
+{
+  size_t              zz, count, maxdist;
+  double              a, sum, squaresum;
+  double              avg, sqr, std;
+  sc_hash_open_entry_t *e;
+
+  count = maxdist = 0;
+  sum = squaresum = 0.;
+  e = (sc_hash_open_entry_t *) hash->slots->array;
+  for (zz = 0; zz < hash->slots->elem_count; ++zz, ++e) {
+    if (e->dist > 0) {
+      ++count;
+      a = (double) e->dist;
+      sum += a;
+      squaresum += a * a;
+      maxdist = SC_MAX (maxdist, (size_t) e->dist);
+    }
+  }
+  SC_ASSERT (count == hash->elem_count);
+
+  avg = count > 0 ? sum / (double) count : 0.;
+  sqr = count > 0 ? squaresum / (double) count - avg * avg : 0.;
+  std = sqrt (SC_MAX (sqr, 0.));
+  SC_GEN_LOGF (package_id, SC_LC_NORMAL, log_priority,
+               "Hash size %lu load %.3g probe avg %.3g std %.3g max %lu"
+               " checks %lu %lu\n", (unsigned long) hash->slots->elem_count,
+               (double) count / (double) hash->slots->elem_count, avg, std,
+               (unsigned long) maxdist, (unsigned long) hash->resize_checks,
+               (unsigned long) hash->resize_actions);
+}
+
+/* concurrent hash table routines */
+
+/** One stripe of a concurrent hash table: a lock and the objects it guards.
+ * The padding keeps the locks of neighboring stripes on separate cache lines.
+ */
+struct sc_hash_mt_stripe
+{
+  sc_hash_t          *hash;
+#ifdef SC_ENABLE_PTHREAD
+  pthread_mutex_t     mutex;
+#elif defined SC_ENABLE_OPENMP
+  omp_lock_t          lock;
+#endif
+  char                padding[64];
+};
+
+static const int    sc_hash_mt_default_stripes = 64;
+
+static inline void
+sc_hash_mt_stripe_init (struct sc_hash_mt_stripe *stripe)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_init (&stripe->mutex, NULL);
+  SC_CHECK_ABORT (pth == 0, "sc_hash_mt mutex init");
+#elif defined SC_ENABLE_OPENMP
+  omp_init_lock (&stripe->lock);
+#endif
+}
+
+static inline void
+sc_hash_mt_stripe_reset (struct sc_hash_mt_stripe *stripe)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_destroy (&stripe->mutex);
+  SC_CHECK_ABORT (pth == 0, "sc_hash_mt mutex destroy");
+#elif defined SC_ENABLE_OPENMP
+  omp_destroy_lock (&stripe->lock);
+#endif
+}
+
+static inline void
+sc_hash_mt_stripe_lock (struct sc_hash_mt_stripe *stripe)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_lock (&stripe->mutex);
+  SC_CHECK_ABORT (pth == 0, "sc_hash_mt mutex lock");
+#elif defined SC_ENABLE_OPENMP
+  omp_set_lock (&stripe->lock);
+#endif
+}
+
+static inline void
+sc_hash_mt_stripe_unlock (struct sc_hash_mt_stripe *stripe)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_mutex_unlock (&stripe->mutex);
+  SC_CHECK_ABORT (pth == 0, "sc_hash_mt mutex unlock");
+#elif defined SC_ENABLE_OPENMP
+  omp_unset_lock (&stripe->lock);
+#endif
+}
+
+/** Call hash_fn once and find the stripe and the slot within it.
+ * The stripe is chosen by the high bits of the scrambled hash value,
+ * while the power-of-two table in each stripe uses its low bits.
+ * The stripe is returned locked, since its table may be resized by other
+ * threads and the slot must only be computed while holding the lock.
+ */
+static inline struct sc_hash_mt_stripe *
+sc_hash_mt_locate (sc_hash_mt_t * hash, void *v, size_t * slot,
+                   uint32_t * hval)
+{
+  unsigned            h;
+  uint64_t            x;
+  struct sc_hash_mt_stripe *stripe;
+
+  h = hash->hash_fn (v, hash->user_data);
+  x = (uint64_t) sc_hash_scramble (h);
+  stripe = hash->stripes + ((x * (uint64_t) hash->num_stripes) >> 32);
+
+  sc_hash_mt_stripe_lock (stripe);
+  *slot = sc_hash_slot_of (stripe->hash, h, hval);
+  return stripe;
+}
+
+size_t
+sc_hash_mt_memory_used (sc_hash_mt_t * hash)
+{
+  int                 i;
+  size_t              size;
+
+  size = sizeof (sc_hash_mt_t) +
+    hash->num_stripes * sizeof (struct sc_hash_mt_stripe);
+  for (i = 0; i < hash->num_stripes; ++i) {
+    size += sc_hash_memory_used (hash->stripes[i].hash);
+  }
+  return size;
+}
+
+sc_hash_mt_t       *
+sc_hash_mt_new (sc_hash_function_t hash_fn, sc_equal_function_t equal_fn,
+                void *user_data, int num_stripes)
+{
+  int                 i;
+  sc_hash_mt_t       *hash;
+  struct sc_hash_mt_stripe *stripe;
+
+  SC_ASSERT (num_stripes >= 0);
+  if (num_stripes == 0) {
+    num_stripes = sc_hash_mt_default_stripes;
+  }
+
+  hash = SC_ALLOC (sc_hash_mt_t, 1);
+  hash->num_stripes = num_stripes;
+  hash->user_data = user_data;
+  hash->hash_fn = hash_fn;
+  hash->equal_fn = equal_fn;
+  hash->stripes = SC_ALLOC (struct sc_hash_mt_stripe, num_stripes);
+  for (i = 0; i < num_stripes; ++i) {
+    stripe = hash->stripes + i;
+    stripe->hash = sc_hash_new_pow2 (hash_fn, equal_fn, user_data, NULL);
+    sc_hash_mt_stripe_init (stripe);
+  }
+
+  return hash;
+}
+
+void
+sc_hash_mt_destroy (sc_hash_mt_t * hash)
+{
+  int                 i;
+  struct sc_hash_mt_stripe *stripe;
+
+  for (i = 0; i < hash->num_stripes; ++i) {
+    stripe = hash->stripes + i;
+    sc_hash_mt_stripe_reset (stripe);
+    sc_hash_destroy (stripe->hash);
+  }
+  SC_FREE (hash->stripes);
+  SC_FREE (hash);
+}
+
+void
+sc_hash_mt_truncate (sc_hash_mt_t * hash)
+{
+  int                 i;
+
+  for (i = 0; i < hash->num_stripes; ++i) {
+    sc_hash_truncate (hash->stripes[i].hash);
+  }
+}
+
+size_t
+sc_hash_mt_count (sc_hash_mt_t * hash)
+{
+  int                 i;
+  size_t              count;
+  struct sc_hash_mt_stripe *stripe;
+
+  count = 0;
+  for (i = 0; i < hash->num_stripes; ++i) {
+    stripe = hash->stripes + i;
+    sc_hash_mt_stripe_lock (stripe);
+    count += stripe->hash->elem_count;
+    sc_hash_mt_stripe_unlock (stripe);
+  }
+  return count;
+}
+
+int
+sc_hash_mt_lookup (sc_hash_mt_t * hash, void *v, void ***found)
+{
+  int                 retval;
+  size_t              slot;
+  uint32_t            hval;
+  struct sc_hash_mt_stripe *stripe;
+
+  stripe = sc_hash_mt_locate (hash, v, &slot, &hval);
+  retval = sc_hash_lookup_slot (stripe->hash, v, slot, hval, found);
+  sc_hash_mt_stripe_unlock (stripe);
+
+  return retval;
+}
+
+int
+sc_hash_mt_insert_unique (sc_hash_mt_t * hash, void *v, void ***found)
+{
+  int                 retval;
+  size_t              slot;
+  uint32_t            hval;
+  struct sc_hash_mt_stripe *stripe;
+
+  stripe = sc_hash_mt_locate (hash, v, &slot, &hval);
+  retval = sc_hash_insert_unique_slot (stripe->hash, v, slot, hval, found);
+  sc_hash_mt_stripe_unlock (stripe);
+
+  return retval;
+}
+
+int
+sc_hash_mt_remove (sc_hash_mt_t * hash, void *v, void **found)
+{
+  int                 retval;
+  size_t              slot;
+  uint32_t            hval;
+  struct sc_hash_mt_stripe *stripe;
+
+  stripe = sc_hash_mt_locate (hash, v, &slot, &hval);
+  retval = sc_hash_remove_slot (stripe->hash, v, slot, hval, found);
+  sc_hash_mt_stripe_unlock (stripe);
+
+  return retval;
+}
+
+void
+sc_hash_mt_foreach (sc_hash_mt_t * hash, sc_hash_foreach_t fn)
+{
+  int                 i;
+  size_t              slot;
+  sc_list_t          *list;
+  sc_link_t          *lynk;
+  sc_hash_t          *h;
+
+  for (i = 0; i < hash->num_stripes; ++i) {
+    h = hash->stripes[i].hash;
+    for (slot = 0; slot < h->slots->elem_count; ++slot) {
+      list = (sc_list_t *) sc_array_index (h->slots, slot);
+      for (lynk = list->first; lynk != NULL; lynk = lynk->next) {
+        if (!fn (&lynk->data, hash->user_data)) {
+          return;
+        }
+      }
+    }
+  }
+}
+
+void
+sc_hash_mt_print_statistics (int package_id, int log_priority,
+                             sc_hash_mt_t * hash)
+{
+  int                 i;
+  size_t              count, minc, maxc, slots;
+  sc_hash_t          *h;
+
+  count = slots = maxc = 0;
+  minc = (size_t) -1;
+  for (i = 0; i < hash->num_stripes; ++i) {
+    h = hash->stripes[i].hash;
+    count += h->elem_count;
+    slots += h->slots->elem_count;
+    minc = SC_MIN (minc, h->elem_count);
+    maxc = SC_MAX (maxc, h->elem_count);
+  }
+  SC_GEN_LOGF (package_id, SC_LC_NORMAL, log_priority,
+               "Hash stripes %d size %lu avg %.3g stripe min %lu max %lu\n",
+               hash->num_stripes, (unsigned long) slots,
+               (double) count / (double) slots, (unsigned long) minc,
+               (unsigned long) maxc);
+}
+
 /* hash array routines */
 
 size_t
@@ -1359,6 +3051,17 @@ sc_hash_array_memory_used (sc_hash_array_t * ha)
     sc_array_memory_used (&ha->a, 0) + sc_hash_memory_used (ha->h);
 }
 
+/** Hash an array element with the user's function or by its bytes. */
+static inline unsigned
+sc_hash_array_hash_item (const sc_hash_array_data_t * internal_data,
+                         const void *p)
+{
+  if (internal_data->hash_fn == NULL) {
+    return sc_hash_function_bytes (p, internal_data->pa->elem_size);
+  }
+  return internal_data->hash_fn (p, internal_data->user_data);
+}
+
 static unsigned
 sc_hash_array_hash_fn (const void *v, const void *u)
 {
@@ -1370,7 +3073,7 @@ sc_hash_array_hash_fn (const void *v, const void *u)
   p = (l == -1L) ? internal_data->current_item :
     sc_array_index_long (internal_data->pa, l);
 
-  return internal_data->hash_fn (p, internal_data->user_data);
+  return sc_hash_array_hash_item (internal_data, p);
 }
 
 static int
@@ -1387,6 +3090,9 @@ sc_hash_array_equal_fn (const void *v1, const void *v2, const void *u)
   p2 = (l2 == -1L) ? internal_data->current_item :
     sc_array_index_long (internal_data->pa, l2);
 
+  if (internal_data->equal_fn == NULL) {
+    return !memcmp (p1, p2, internal_data->pa->elem_size);
+  }
   return internal_data->equal_fn (p1, p2, internal_data->user_data);
 }
 
@@ -1494,6 +3200,158 @@ sc_hash_array_insert_unique (sc_hash_array_t * hash_array, void *v,
   }
 }
 
+/** Distance in objects to prefetch the slot of an upcoming batch entry.
+ * The first link of a slot is prefetched at half this distance.
+ */
+static const size_t sc_hash_array_prefetch_distance = 16;
+
+/** Compute the slot and hash value of every object of a batch.
+ * \param [out] slots  Resized to the batch count, of type size_t.
+ * \param [out] hvals  Resized to the batch count, of type uint32_t.
+ */
+static void
+sc_hash_array_batch_slots (sc_hash_array_t * hash_array, sc_array_t * batch,
+                           sc_array_t * slots, sc_array_t * hvals)
+{
+  size_t              zz;
+  size_t             *slot;
+  uint32_t           *hval;
+  sc_hash_array_data_t *internal_data = &hash_array->internal_data;
+
+  sc_array_resize (slots, batch->elem_count);
+  sc_array_resize (hvals, batch->elem_count);
+  for (zz = 0; zz < batch->elem_count; ++zz) {
+    slot = (size_t *) sc_array_index (slots, zz);
+    hval = (uint32_t *) sc_array_index (hvals, zz);
+    *slot = sc_hash_slot_of (hash_array->h, sc_hash_array_hash_item
+                             (internal_data, sc_array_index (batch, zz)),
+                             hval);
+  }
+}
+
+/** Prefetch the slot list and first link used by upcoming batch entries. */
+static inline void
+sc_hash_array_batch_prefetch (sc_hash_array_t * hash_array,
+                              sc_array_t * slots, size_t zz)
+{
+  const size_t        dist = sc_hash_array_prefetch_distance;
+  sc_array_t         *hslots = hash_array->h->slots;
+
+  if (zz + dist < slots->elem_count) {
+    SC_PREFETCH (sc_array_index (hslots, *(size_t *) sc_array_index
+                                 (slots, zz + dist)));
+  }
+  if (zz + dist / 2 < slots->elem_count) {
+    SC_PREFETCH (((sc_list_t *) sc_array_index
+                  (hslots, *(size_t *) sc_array_index
+                   (slots, zz + dist / 2)))->first);
+  }
+}
+
+size_t
+sc_hash_array_insert_batch (sc_hash_array_t * hash_array, sc_array_t * batch,
+                            sc_array_t * positions)
+{
+  int                 added;
+  size_t              zz, position, num_added;
+  void               *v, **found_void;
+  sc_array_t          slots, hvals;
+
+  SC_ASSERT (batch->elem_size == hash_array->a.elem_size);
+  SC_ASSERT (hash_array->a.elem_count == hash_array->h->elem_count);
+  SC_ASSERT (positions == NULL || positions->elem_size == sizeof (size_t));
+
+  if (positions != NULL) {
+    sc_array_resize (positions, batch->elem_count);
+  }
+  if (batch->elem_count == 0) {
+    return 0;
+  }
+
+  /* grow once such that no resize happens during the insertion */
+  (void) sc_hash_presize (hash_array->h,
+                          hash_array->a.elem_count + batch->elem_count);
+
+  sc_array_init (&slots, sizeof (size_t));
+  sc_array_init (&hvals, sizeof (uint32_t));
+  sc_hash_array_batch_slots (hash_array, batch, &slots, &hvals);
+
+  num_added = 0;
+  for (zz = 0; zz < batch->elem_count; ++zz) {
+    sc_hash_array_batch_prefetch (hash_array, &slots, zz);
+
+    v = sc_array_index (batch, zz);
+    hash_array->internal_data.current_item = v;
+    added = sc_hash_insert_unique_slot
+      (hash_array->h, (void *) (-1L), *(size_t *) sc_array_index (&slots, zz),
+       *(uint32_t *) sc_array_index (&hvals, zz), &found_void);
+    hash_array->internal_data.current_item = NULL;
+
+    if (added) {
+      position = hash_array->a.elem_count;
+      *found_void = (void *) position;
+      memcpy (sc_array_push (&hash_array->a), v, batch->elem_size);
+      ++num_added;
+    }
+    else {
+      position = (size_t) (*found_void);
+    }
+    if (positions != NULL) {
+      *(size_t *) sc_array_index (positions, zz) = position;
+    }
+  }
+
+  sc_array_reset (&slots);
+  sc_array_reset (&hvals);
+
+  return num_added;
+}
+
+size_t
+sc_hash_array_lookup_batch (sc_hash_array_t * hash_array, sc_array_t * batch,
+                            sc_array_t * positions)
+{
+  size_t              zz, num_found;
+  size_t             *position;
+  void              **found_void;
+  sc_array_t          slots, hvals;
+
+  SC_ASSERT (batch->elem_size == hash_array->a.elem_size);
+  SC_ASSERT (positions != NULL && positions->elem_size == sizeof (size_t));
+
+  sc_array_resize (positions, batch->elem_count);
+  if (batch->elem_count == 0) {
+    return 0;
+  }
+
+  sc_array_init (&slots, sizeof (size_t));
+  sc_array_init (&hvals, sizeof (uint32_t));
+  sc_hash_array_batch_slots (hash_array, batch, &slots, &hvals);
+
+  num_found = 0;
+  for (zz = 0; zz < batch->elem_count; ++zz) {
+    sc_hash_array_batch_prefetch (hash_array, &slots, zz);
+
+    position = (size_t *) sc_array_index (positions, zz);
+    hash_array->internal_data.current_item = sc_array_index (batch, zz);
+    if (sc_hash_lookup_slot
+        (hash_array->h, (void *) (-1L), *(size_t *) sc_array_index (&slots, zz),
+         *(uint32_t *) sc_array_index (&hvals, zz), &found_void)) {
+      *position = (size_t) (*found_void);
+      ++num_found;
+    }
+    else {
+      *position = (size_t) -1;
+    }
+    hash_array->internal_data.current_item = NULL;
+  }
+
+  sc_array_reset (&slots);
+  sc_array_reset (&hvals);
+
+  return num_found;
+}
+
 void
 sc_hash_array_rip (sc_hash_array_t * hash_array, sc_array_t * rip)
 {
@@ -87,7 +87,8 @@ typedef int         (*sc_hash_foreach_t) (void **v, const void *u);
  * \ref sc_array_resize and \ref sc_array_rewind.
  * Elements can be sorted with \ref sc_array_sort.
  * If the array is sorted, it can be searched with \ref sc_array_bsearch.
- * A priority queue is implemented with pqueue_add and pqueue_pop (untested).
+ * A priority queue is implemented with pqueue_add and pqueue_pop,
+ * and with pqueue4_add and pqueue4_pop as a 4-ary heap.
  */
 typedef struct sc_array
 {
@@ -277,6 +278,55 @@ void                sc_array_sort (sc_array_t * array,
                                    int (*compar) (const void *,
                                                   const void *));
 
+/** Sorts the array in ascending order by a 64-bit unsigned integer key.
+ * Each element holds the key at a fixed byte offset, which is useful for
+ * integer and space filling curve indices in an array of structs.
+ * This is an LSD radix sort with 8-bit digits and no comparison callback.
+ * The sort is stable: elements with equal keys keep their relative order.
+ * Digits that are equal for all keys are skipped.
+ * The histograms and element moves are parallel with OpenMP if configured.
+ * Requires temporary memory of the same size as the array.
+ * \param [in,out] array    The array to sort.
+ * \param [in] key_offset  Byte offset of the uint64_t key in an element.
+ *                          The key need not be aligned.
+ */
+void                sc_array_sort_key64 (sc_array_t * array,
+                                         size_t key_offset);
+
+/** Sorts the array in ascending order by a 32-bit unsigned integer key.
+ * Works like \ref sc_array_sort_key64 and is stable as well.
+ * \param [in,out] array    The array to sort.
+ * \param [in] key_offset  Byte offset of the uint32_t key in an element.
+ */
+void                sc_array_sort_key32 (sc_array_t * array,
+                                         size_t key_offset);
+
+/** Merge sorted arrays into one sorted array.
+ * The merge uses a loser tree of the runs and copies every element once,
+ * directly into the destination.  It is stable: equal elements keep their
+ * order within a run and are taken from runs with lower index first.
+ * With several threads, the output is split evenly by co-ranking, which
+ * finds the number of elements each run contributes before a split, and
+ * each thread merges one part independently.
+ * \param [in,out] dest     Array (not a view) that is resized to hold the
+ *                          elements of all runs.  Its element size must
+ *                          match that of the runs.
+ * \param [in] runs         Array of num_runs arrays, each sorted wrt.
+ *                          compar.  They are not changed and must not
+ *                          overlap with dest.
+ * \param [in] num_runs     Number of runs.
+ * \param [in] compar       The comparison function to be used.
+ * \param [in] num_threads  Number of threads to use.  If <= 0, use
+ *                          omp_get_max_threads () with OpenMP and 1
+ *                          otherwise.  Threads are only used if libsc is
+ *                          configured with OpenMP and the output is large.
+ */
+void                sc_array_merge_k (sc_array_t * dest, sc_array_t ** runs,
+                                      size_t num_runs,
+                                      int (*compar) (const void *,
+                                                     const void *),
+                                      int num_threads);
+
 /** Check whether the array is sorted wrt. the comparison function.
  * \param [in] array    The array to check.
  * \param [in] compar   The comparison function to be used.
@@ -372,15 +422,15 @@ void                sc_array_permute (sc_array_t * array,
 unsigned            sc_array_checksum (sc_array_t * array);
 
 /** Adds an element to a priority queue.
- * PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED.
  * This function is not allowed for views.
  * The priority queue is implemented as a heap in ascending order.
  * A heap is a binary tree where the children are not less than their parent.
  * Assumes that elements [0]..[elem_count-2] form a valid heap.
- * Then propagates [elem_count-1] upward by swapping if necessary.
+ * Then propagates [elem_count-1] upward, moving larger parents down into
+ * the hole and writing the new element once at its final position.
  * \param [in] temp    Pointer to unused allocated memory of elem_size.
  * \param [in] compar  The comparison function to be used.
- * \return Returns the number of swap operations.
+ * \return Returns the number of levels the element moved up.
  * \note  If the return value is zero for all elements in an array,
  *        the array is sorted linearly and unchanged.
  */
@@ -390,12 +440,11 @@ size_t              sc_array_pqueue_add (sc_array_t * array,
                                                         const void *));
 
 /** Pops the smallest element from a priority queue.
- * PQUEUE FUNCTIONS ARE UNTESTED AND CURRENTLY DISABLED.
  * This function is not allowed for views.
  * This function assumes that the array forms a valid heap in ascending order.
  * \param [out] result  Pointer to unused allocated memory of elem_size.
  * \param [in]  compar  The comparison function to be used.
- * \return Returns the number of swap operations.
+ * \return Returns the number of levels the last element moved down.
  * \note This function resizes the array to elem_count-1.
  */
 size_t              sc_array_pqueue_pop (sc_array_t * array,
@@ -403,6 +452,69 @@ size_t              sc_array_pqueue_pop (sc_array_t * array,
                                          int (*compar) (const void *,
                                                         const void *));
 
+/** Pops the smallest element and adds another one in a single sift down.
+ * This is cheaper than a pop followed by an add, and the count of the
+ * array is not changed.  This function is not allowed for views.
+ * This function assumes that the array forms a valid heap in ascending order.
+ * \param [out] result  Pointer to unused allocated memory of elem_size.
+ * \param [in]  elem    The element to add; must not overlap result or the
+ *                      array.
+ * \param [in]  compar  The comparison function to be used.
+ * \return Returns the number of levels the new element moved down.
+ */
+size_t              sc_array_pqueue_pop_push (sc_array_t * array,
+                                              void *result,
+                                              const void *elem,
+                                              int (*compar) (const void *,
+                                                             const void *));
+
+/** Rearranges an array into a priority queue in O(elem_count) time.
+ * This is faster than adding the elements one by one.
+ * \param [in,out] array    Any array; a view is allowed.
+ * \param [in] temp        Pointer to unused allocated memory of elem_size.
+ * \param [in] compar      The comparison function to be used.
+ */
+void                sc_array_pqueue_heapify (sc_array_t * array, void *temp,
+                                             int (*compar) (const void *,
+                                                            const void *));
+
+/** Adds an element to a priority queue stored as a 4-ary heap.
+ * A node i has the children 4i+1 to 4i+4.  The tree is half as deep as a
+ * binary heap, and the children of a node share one or two cache lines,
+ * which makes popping faster.  The 4-ary functions must not be mixed with
+ * the binary ones on the same array.
+ * Otherwise this function works like \ref sc_array_pqueue_add.
+ */
+size_t              sc_array_pqueue4_add (sc_array_t * array,
+                                          void *temp,
+                                          int (*compar) (const void *,
+                                                         const void *));
+
+/** Pops the smallest element from a priority queue stored as a 4-ary heap.
+ * Otherwise this function works like \ref sc_array_pqueue_pop.
+ */
+size_t              sc_array_pqueue4_pop (sc_array_t * array,
+                                          void *result,
+                                          int (*compar) (const void *,
+                                                         const void *));
+
+/** Pops the smallest element and adds another one to a 4-ary heap.
+ * Otherwise this function works like \ref sc_array_pqueue_pop_push.
+ */
+size_t              sc_array_pqueue4_pop_push (sc_array_t * array,
+                                               void *result,
+                                               const void *elem,
+                                               int (*compar) (const void *,
+                                                              const void *));
+
+/** Rearranges an array into a 4-ary heap in O(elem_count) time.
+ * Otherwise this function works like \ref sc_array_pqueue_heapify.
+ */
+void                sc_array_pqueue4_heapify (sc_array_t * array,
+                                              void *temp,
+                                              int (*compar) (const void *,
+                                                             const void *));
+
 /** Returns a pointer to an array element.
  * \param [in] index needs to be in [0]..[elem_count-1].
  */
@@ -548,6 +660,7 @@ typedef struct sc_mempool
   int                 zero_and_persist; /**< Boolean; is set in constructor. */
 
   /* implementation variables */
+  size_t              chunk_bytes;      /**< obstack chunk size or 0 */
   struct obstack      obstack;  /**< holds the allocated elements */
   sc_array_t          freed;    /**< buffers the freed elements */
 }
@@ -574,6 +687,19 @@ sc_mempool_t       *sc_mempool_new (size_t elem_size);
  */
 sc_mempool_t       *sc_mempool_new_zero_and_persist (size_t elem_size);
 
+/** Creates a new mempool structure that allocates memory in large chunks.
+ * The chunks are aligned to the page size of the system.  Where supported,
+ * chunks of at least 2 MiB are advised to be backed by huge pages.
+ * This reduces TLB misses when creating and traversing many elements.
+ * The contents of any elements returned by sc_mempool_alloc are undefined.
+ * \param [in] elem_size   Size of one element in bytes.
+ * \param [in] chunk_bytes Size of the chunks requested from sc_malloc.
+ *                         Must be larger than elem_size and at most INT_MAX.
+ * \return Returns an allocated and initialized memory pool.
+ */
+sc_mempool_t       *sc_mempool_new_chunked (size_t elem_size,
+                                            size_t chunk_bytes);
+
 /** Same as sc_mempool_new, but for an already allocated sc_mempool_t pointer. */
 void                sc_mempool_init (sc_mempool_t * mempool,
                                      size_t elem_size);
@@ -622,6 +748,16 @@ sc_mempool_alloc (sc_mempool_t * mempool)
   return ret;
 }
 
+/** Allocate multiple elements at once.
+ * Elements previously returned to the pool are recycled first.
+ * The remaining elements are taken from the current chunk in one sweep.
+ * \param [in] n      Number of elements to allocate.
+ * \param [out] ptrs  Array of length at least n that receives the
+ *                    new or recycled element pointers.
+ */
+void                sc_mempool_alloc_many (sc_mempool_t * mempool,
+                                           size_t n, void **ptrs);
+
 /** Return a previously allocated element to the pool.
  * \param [in] elem  The element to be returned to the pool.
  */
@@ -644,6 +780,70 @@ sc_mempool_free (sc_mempool_t * mempool, void *elem)
   *(void **) sc_array_push (freed) = elem;
 }
 
+/** The sc_mempool_mt object provides equal-size elements to multiple threads.
+ * Each thread allocates from its own obstack and keeps its own free list,
+ * so allocating and freeing does not require a lock.  An element may be
+ * freed by a different thread than the one that allocated it; it is then
+ * pushed onto a lock-free return queue of the allocating thread, which
+ * takes over the queue when its own free list runs empty.
+ * The threads are identified by an index passed to each call that must be
+ * unique among the threads accessing the pool at the same time.
+ * The atomic operations require a GNU compatible compiler; otherwise the
+ * pool must not be accessed by more than one thread at a time.
+ */
+typedef struct sc_mempool_mt
+{
+  /* interface variables */
+  size_t              elem_size;        /**< size of a single element */
+  int                 num_threads;      /**< number of thread indices */
+
+  /* implementation variables */
+  size_t              header_size;      /**< bytes in front of each element */
+  struct sc_mempool_mt_local *locals;   /**< one opaque pool per thread */
+}
+sc_mempool_mt_t;
+
+/** Calculate the memory used by a multithreaded memory pool.
+ * \param [in] mempool     The memory pool.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_mempool_mt_memory_used (sc_mempool_mt_t * mempool);
+
+/** Creates a new multithreaded memory pool.
+ * The contents of any elements returned by sc_mempool_mt_alloc are undefined.
+ * \param [in] elem_size   Size of one element in bytes.
+ * \param [in] num_threads Number of threads that may access the pool.
+ * \return Returns an allocated and initialized memory pool.
+ */
+sc_mempool_mt_t    *sc_mempool_mt_new (size_t elem_size, int num_threads);
+
+/** Destroys a multithreaded memory pool.
+ * All elements that are still in use are invalidated.
+ * Must not be called concurrently with any other access to the pool.
+ */
+void                sc_mempool_mt_destroy (sc_mempool_mt_t * mempool);
+
+/** Allocate a single element.
+ * Elements previously returned to the pool by any thread are recycled.
+ * \param [in] thread  Index of the calling thread, 0 <= thread < num_threads.
+ * \return Returns a new or recycled element pointer.
+ */
+void               *sc_mempool_mt_alloc (sc_mempool_mt_t * mempool,
+                                         int thread);
+
+/** Return a previously allocated element to the pool.
+ * \param [in] thread  Index of the calling thread, 0 <= thread < num_threads.
+ *                     The element may have been allocated by another thread.
+ * \param [in] elem    The element to be returned to the pool.
+ */
+void                sc_mempool_mt_free (sc_mempool_mt_t * mempool,
+                                        int thread, void *elem);
+
+/** Return the number of elements currently allocated from the pool.
+ * When called concurrently with allocations the result is approximate.
+ */
+size_t              sc_mempool_mt_count (sc_mempool_mt_t * mempool);
+
 /** The sc_link structure is one link of a linked list.
  */
 typedef struct sc_link
@@ -664,7 +864,9 @@ typedef struct sc_list
 
   /* implementation variables */
   int                 allocator_owned;
-  sc_mempool_t       *allocator;        /* must allocate sc_link_t */
+  sc_mempool_t       *allocator;        /* must allocate sc_link_t or larger */
+  sc_mempool_mt_t    *allocator_mt;     /* if not NULL, used instead */
+  int                 allocator_thread; /* thread index for allocator_mt */
 }
 sc_list_t;
 
@@ -679,6 +881,8 @@ size_t              sc_list_memory_used (sc_list_t * list, int is_dynamic);
 /** Allocate a new, empty linked list.
  * \param [in] allocator    Memory allocator for sc_link_t, can be NULL
  *                          in which case an internal allocator is created.
+ *                          It may allocate a larger type that begins with
+ *                          an sc_link_t, such as sc_hash_link_t.
  * \return                  Pointer to a newly allocated, empty list object.
  */
 sc_list_t          *sc_list_new (sc_mempool_t * allocator);
@@ -692,10 +896,41 @@ void                sc_list_destroy (sc_list_t * list);
 /** Initialize a list object with an external link allocator.
  * \param [in,out]  list       List structure to be initialized.
  * \param [in]      allocator  External memory allocator for sc_link_t,
- *                             which must exist already.
+ *                             which must exist already.  It may allocate
+ *                             a larger type that begins with an sc_link_t.
  */
 void                sc_list_init (sc_list_t * list, sc_mempool_t * allocator);
 
+/** Allocate a new, empty linked list with a multithreaded link allocator.
+ * Each list may only be accessed by one thread at a time, but lists of
+ * different threads can share the allocator without a lock.
+ * \param [in] allocator    External memory allocator for sc_link_t,
+ *                          which must exist already and outlive the list.
+ *                          It may allocate a larger type that begins with
+ *                          an sc_link_t, such as sc_hash_link_t.
+ * \param [in] thread       Index of the thread accessing the list.
+ * \return                  Pointer to a newly allocated, empty list object.
+ */
+sc_list_t          *sc_list_new_mt (sc_mempool_mt_t * allocator, int thread);
+
+/** Initialize a list object with a multithreaded link allocator.
+ * \param [in,out]  list       List structure to be initialized.
+ * \param [in]      allocator  External memory allocator for sc_link_t.
+ * \param [in]      thread     Index of the thread accessing the list.
+ */
+void                sc_list_init_mt (sc_list_t * list,
+                                     sc_mempool_mt_t * allocator,
+                                     int thread);
+
+/** Hand a list with a multithreaded allocator over to another thread.
+ * Links removed afterwards are returned to the pool by the new thread,
+ * which is legal for links allocated by any thread.
+ * \param [in,out]  list       List created by sc_list_new_mt or
+ *                             initialized by sc_list_init_mt.
+ * \param [in]      thread     Index of the thread accessing the list.
+ */
+void                sc_list_set_thread (sc_list_t * list, int thread);
+
 /** Remove all elements from a list in O(N).
  * \param [in,out]  list       List structure to be emptied.
  * \note Calling sc_list_init, then any list operations,
@@ -763,10 +998,35 @@ typedef struct sc_hash
   size_t              resize_checks, resize_actions;
   int                 allocator_owned;
   sc_mempool_t       *allocator;        /**< must allocate sc_link_t */
+  sc_mempool_mt_t    *allocator_mt;     /**< if not NULL, used instead */
+  int                 allocator_thread; /**< thread index for allocator_mt */
+  int                 pow2_mode;        /**< power-of-two slots, cached hash,
+                                             links are sc_hash_link_t */
 }
 sc_hash_t;
 
+/** The link type of a hash table created by \ref sc_hash_new_pow2.
+ * It extends sc_link_t by the cached full 32-bit hash value of the data.
+ */
+typedef struct sc_hash_link
+{
+  sc_link_t           link;     /**< must be the first member */
+  uint32_t            hval;     /**< hash value of link.data */
+}
+sc_hash_link_t;
+
+/** Compute a hash value from a memory range of given length.
+ * The bytes are processed eight at a time; the range may have any alignment.
+ * This hash function is NOT cryptographically safe! Use libcrypt then.
+ * \param [in] ptr      Start of the memory range to be hashed.
+ * \param [in] len      Length of the memory range in bytes.
+ * \return              The computed hash value as an unsigned integer.
+ */
+unsigned            sc_hash_function_bytes (const void *ptr, size_t len);
+
 /** Compute a hash value from a null-terminated string.
+ * This is \ref sc_hash_function_bytes applied to the string's length,
+ * so no memory beyond the terminating null byte is accessed.
  * This hash function is NOT cryptographically safe! Use libcrypt then.
  * \param [in] s        Null-terminated string to be hashed.
  * \param [in] u        Not used.
@@ -791,6 +1051,46 @@ sc_hash_t          *sc_hash_new (sc_hash_function_t hash_fn,
                                  sc_equal_function_t equal_fn,
                                  void *user_data, sc_mempool_t * allocator);
 
+/** Create a new hash table with a power-of-two number of slots.
+ * The slot of an object is found by a bit mask instead of an integer division.
+ * The full hash value is cached in each link and compared before equal_fn
+ * is called.  Resizing reuses the cached values and does not call hash_fn.
+ * The hash value is scrambled internally, such that hash_fn need not
+ * provide well-distributed lowest bits.
+ * All other hash functions can be used on the result as usual.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ * \param [in] allocator   Memory allocator for sc_hash_link_t, can be NULL.
+ */
+sc_hash_t          *sc_hash_new_pow2 (sc_hash_function_t hash_fn,
+                                      sc_equal_function_t equal_fn,
+                                      void *user_data,
+                                      sc_mempool_t * allocator);
+
+/** Create a new power-of-two hash table with a multithreaded link allocator.
+ * The table behaves as one created by \ref sc_hash_new_pow2.
+ * Each table may only be accessed by one thread at a time, but tables of
+ * different threads can share the allocator without a lock.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ * \param [in] allocator   Memory allocator for sc_hash_link_t, not NULL.
+ *                         It must outlive the hash table.
+ * \param [in] thread      Index of the thread accessing the table.
+ */
+sc_hash_t          *sc_hash_new_mt (sc_hash_function_t hash_fn,
+                                    sc_equal_function_t equal_fn,
+                                    void *user_data,
+                                    sc_mempool_mt_t * allocator, int thread);
+
+/** Hand a hash table with a multithreaded allocator to another thread.
+ * This runs in O(number of slots).
+ * \param [in,out] hash    Hash table created by sc_hash_new_mt.
+ * \param [in] thread      Index of the thread accessing the table.
+ */
+void                sc_hash_set_thread (sc_hash_t * hash, int thread);
+
 /** Destroy a hash table.
  *
  * If the allocator is owned, this runs in O(1), otherwise in O(N).
@@ -857,6 +1157,197 @@ void                sc_hash_print_statistics (int package_id,
                                               int log_priority,
                                               sc_hash_t * hash);
 
+/** The sc_hash_open implements a hash table with open addressing.
+ * The entries are stored in one contiguous array of a power-of-two size,
+ * together with a cached copy of their hash value.  Collisions are resolved
+ * by linear probing with Robin Hood displacement, so a lookup touches
+ * consecutive memory and usually calls equal_fn only for the matching entry.
+ * Removal shifts the following entries backwards and leaves no tombstones.
+ * The hash_fn, equal_fn and user_data contract is the same as for sc_hash.
+ * Contrary to sc_hash, the addresses returned in the found parameters
+ * remain valid only until the next insertion or removal.
+ */
+typedef struct sc_hash_open
+{
+  /* interface variables */
+  size_t              elem_count;       /**< total number of objects contained */
+
+  /* implementation variables */
+  sc_array_t         *slots;    /**< the slot count is a power of two */
+  void               *user_data;        /**< user data passed to hash function */
+  sc_hash_function_t  hash_fn;
+  sc_equal_function_t equal_fn;
+  size_t              resize_checks, resize_actions;
+}
+sc_hash_open_t;
+
+/** Calculate the memory used by an open addressing hash table.
+ * \param [in] hash        The hash table.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_hash_open_memory_used (sc_hash_open_t * hash);
+
+/** Create a new open addressing hash table.
+ * The number of hash slots is chosen dynamically.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ */
+sc_hash_open_t     *sc_hash_open_new (sc_hash_function_t hash_fn,
+                                      sc_equal_function_t equal_fn,
+                                      void *user_data);
+
+/** Destroy an open addressing hash table in O(1).
+ */
+void                sc_hash_open_destroy (sc_hash_open_t * hash);
+
+/** Remove all entries from an open addressing hash table.
+ * The slot array is shrunk to its minimal size.
+ */
+void                sc_hash_open_truncate (sc_hash_open_t * hash);
+
+/** Check if an object is contained in the open addressing hash table.
+ * \param [in]  v      The object to be looked up.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained object if the object
+ *                     is found.  You can assign to **found to override.
+ *                     The address is valid until the table is modified.
+ * \return Returns true if object is found, false otherwise.
+ */
+int                 sc_hash_open_lookup (sc_hash_open_t * hash, void *v,
+                                         void ***found);
+
+/** Insert an object into an open addressing hash table if not contained yet.
+ * \param [in]  v      The object to be inserted.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained, or if not present,
+ *                     the new object.  You can assign to **found to override.
+ *                     The address is valid until the table is modified.
+ * \return Returns true if object is added, false if it is already contained.
+ */
+int                 sc_hash_open_insert_unique (sc_hash_open_t * hash,
+                                                void *v, void ***found);
+
+/** Remove an object from an open addressing hash table.
+ * \param [in]  v      The object to be removed.
+ * \param [out] found  If found != NULL, *found is set to the object
+                       that is removed if that exists.
+ * \return Returns true if object is found, false if is not contained.
+ */
+int                 sc_hash_open_remove (sc_hash_open_t * hash, void *v,
+                                         void **found);
+
+/** Invoke a callback for every member of the open addressing hash table.
+ * The functions hash_fn and equal_fn are not called by this function.
+ * The callback must not insert into or remove from the table.
+ */
+void                sc_hash_open_foreach (sc_hash_open_t * hash,
+                                          sc_hash_foreach_t fn);
+
+/** Compute and print statistical information about the probe lengths.
+ */
+void                sc_hash_open_print_statistics (int package_id,
+                                                   int log_priority,
+                                                   sc_hash_open_t * hash);
+
+/** The sc_hash_mt implements a hash table for concurrent access by threads.
+ * The objects are distributed over a number of stripes by their hash value.
+ * Each stripe is a power-of-two sc_hash protected by its own lock, so
+ * threads that access different stripes do not wait for each other.
+ * The locks are pthread mutexes if SC_ENABLE_PTHREAD is defined and OpenMP
+ * locks if only SC_ENABLE_OPENMP is defined; otherwise there is no locking.
+ * The hash_fn and equal_fn must be safe to call from multiple threads.
+ * Lookup, insertion, removal and sc_hash_mt_count may be called concurrently.
+ * All other functions must not run concurrently with any other access.
+ * The addresses returned in the found parameters remain valid until the
+ * object is removed; synchronizing access to the object itself is up to
+ * the caller.
+ */
+typedef struct sc_hash_mt
+{
+  /* implementation variables */
+  int                 num_stripes;      /**< number of independent locks */
+  struct sc_hash_mt_stripe *stripes;    /**< the stripes are opaque */
+  void               *user_data;        /**< user data passed to hash function */
+  sc_hash_function_t  hash_fn;
+  sc_equal_function_t equal_fn;
+}
+sc_hash_mt_t;
+
+/** Calculate the memory used by a concurrent hash table.
+ * \param [in] hash        The hash table.
+ * \return                 Memory used in bytes.
+ */
+size_t              sc_hash_mt_memory_used (sc_hash_mt_t * hash);
+
+/** Create a new concurrent hash table.
+ * The number of hash slots in each stripe is chosen dynamically.
+ * \param [in] hash_fn     Function to compute the hash value.
+ * \param [in] equal_fn    Function to test two objects for equality.
+ * \param [in] user_data   User data passed through to the hash function.
+ * \param [in] num_stripes Number of stripes with independent locks.
+ *                         Should be well above the number of threads.
+ *                         If 0, a default number is chosen.
+ */
+sc_hash_mt_t       *sc_hash_mt_new (sc_hash_function_t hash_fn,
+                                    sc_equal_function_t equal_fn,
+                                    void *user_data, int num_stripes);
+
+/** Destroy a concurrent hash table.
+ */
+void                sc_hash_mt_destroy (sc_hash_mt_t * hash);
+
+/** Remove all entries from a concurrent hash table.
+ */
+void                sc_hash_mt_truncate (sc_hash_mt_t * hash);
+
+/** Return the number of objects in a concurrent hash table.
+ * When called concurrently with modifications the result is approximate.
+ */
+size_t              sc_hash_mt_count (sc_hash_mt_t * hash);
+
+/** Check if an object is contained in the concurrent hash table.
+ * \param [in]  v      The object to be looked up.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained object if the object
+ *                     is found.  You can assign to **found to override.
+ * \return Returns true if object is found, false otherwise.
+ */
+int                 sc_hash_mt_lookup (sc_hash_mt_t * hash, void *v,
+                                       void ***found);
+
+/** Insert an object into a concurrent hash table if it is not contained yet.
+ * Of several threads inserting equal objects exactly one succeeds.
+ * \param [in]  v      The object to be inserted.
+ * \param [out] found  If found != NULL, *found is set to the address of the
+ *                     pointer to the already contained, or if not present,
+ *                     the new object.  You can assign to **found to override.
+ * \return Returns true if object is added, false if it is already contained.
+ */
+int                 sc_hash_mt_insert_unique (sc_hash_mt_t * hash, void *v,
+                                              void ***found);
+
+/** Remove an object from a concurrent hash table.
+ * \param [in]  v      The object to be removed.
+ * \param [out] found  If found != NULL, *found is set to the object
+                       that is removed if that exists.
+ * \return Returns true if object is found, false if is not contained.
+ */
+int                 sc_hash_mt_remove (sc_hash_mt_t * hash, void *v,
+                                       void **found);
+
+/** Invoke a callback for every member of the concurrent hash table.
+ * The functions hash_fn and equal_fn are not called by this function.
+ */
+void                sc_hash_mt_foreach (sc_hash_mt_t * hash,
+                                        sc_hash_foreach_t fn);
+
+/** Print the occupancy of the table and the balance of its stripes.
+ */
+void                sc_hash_mt_print_statistics (int package_id,
+                                                 int log_priority,
+                                                 sc_hash_mt_t * hash);
+
 typedef struct sc_hash_array_data
 {
   sc_array_t         *pa;
@@ -888,7 +1379,12 @@ size_t              sc_hash_array_memory_used (sc_hash_array_t * ha);
 /** Create a new hash array.
  * \param [in] elem_size   Size of one array element in bytes.
  * \param [in] hash_fn     Function to compute the hash value.
+ *                         If NULL, \ref sc_hash_function_bytes is applied
+ *                         to the elem_size bytes of an element.
  * \param [in] equal_fn    Function to test two objects for equality.
+ *                         If NULL, the elem_size bytes are compared.
+ *                         Passing NULL for either function requires that
+ *                         elements contain no uninitialized padding.
  */
 sc_hash_array_t    *sc_hash_array_new (size_t elem_size,
                                        sc_hash_function_t hash_fn,
@@ -933,6 +1429,41 @@ int                 sc_hash_array_lookup (sc_hash_array_t * hash_array,
 void               *sc_hash_array_insert_unique (sc_hash_array_t * hash_array,
                                                  void *v, size_t * position);
 
+/** Insert a batch of objects into a hash array, copying the new ones.
+ * The hash table is grown once for the whole batch beforehand.  All hash
+ * values are computed in a first pass, and the slots of upcoming objects
+ * are prefetched while the current ones are inserted.
+ * The result is the same as calling \ref sc_hash_array_insert_unique
+ * for every object in order and copying each new object into the array.
+ * Duplicates within the batch are resolved to their first occurrence.
+ *
+ * \param [in] batch       Objects of the hash array's element size.
+ *                         Must not be a view on the hash array itself.
+ * \param [out] positions  If not NULL, an initialized array of size_t
+ *                         that is resized to the count of \a batch.
+ *                         Entry i is set to the array position of the
+ *                         already contained or newly added object i.
+ * \return                 The number of objects newly added.
+ */
+size_t              sc_hash_array_insert_batch (sc_hash_array_t * hash_array,
+                                                sc_array_t * batch,
+                                                sc_array_t * positions);
+
+/** Check a batch of objects for being contained in a hash array.
+ * All hash values are computed in a first pass, and the slots of upcoming
+ * objects are prefetched while the current ones are looked up.
+ *
+ * \param [in] batch       Objects of the hash array's element size.
+ * \param [out] positions  An initialized array of size_t that is resized
+ *                         to the count of \a batch.  Entry i is set to the
+ *                         array position of object i if found, and to
+ *                         (size_t) -1 otherwise.
+ * \return                 The number of objects found.
+ */
+size_t              sc_hash_array_lookup_batch (sc_hash_array_t * hash_array,
+                                                sc_array_t * batch,
+                                                sc_array_t * positions);
+
 /** Extract the array data from a hash array and destroy everything else.
  * \param [in] hash_array   The hash array is destroyed after extraction.
  * \param [in] rip          Array structure that will be overwritten.
@@ -360,6 +360,31 @@ sc_MPI_Alltoall (void *p, int np, sc_MPI_Datatype tp,
   return sc_MPI_Gather (p, np, tp, q, nq, tq, 0, comm);
 }
 
+int
+sc_MPI_Alltoallv (void *p, int *sendc, int *sdispl, sc_MPI_Datatype tp,
+                  void *q, int *recvc, int *rdispl,
+                  sc_MPI_Datatype tq, sc_MPI_Comm comm)
+{
+  size_t              lp;
+#ifdef SC_ENABLE_DEBUG
+  size_t              lq;
+#endif
+  SC_ASSERT (sendc[0] >= 0 && recvc[0] >= 0);
+
+/* *INDENT-OFF* horrible indent bug */
+  lp = (size_t) sendc[0] * sc_mpi_sizeof (tp);
+#ifdef SC_ENABLE_DEBUG
+  lq = (size_t) recvc[0] * sc_mpi_sizeof (tq);
+#endif
+/* *INDENT-ON* */
+
+  SC_ASSERT (lp == lq);
+  memcpy ((char *) q + rdispl[0] * sc_mpi_sizeof (tq),
+          (char *) p + sdispl[0] * sc_mpi_sizeof (tp), lp);
+
+  return sc_MPI_SUCCESS;
+}
+
 int
 sc_MPI_Reduce (void *p, void *q, int n, sc_MPI_Datatype t,
                sc_MPI_Op op, int rank, sc_MPI_Comm comm)
@@ -492,6 +517,29 @@ sc_MPI_Waitall (int count, sc_MPI_Request * array_of_requests,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_MPI_Test (sc_MPI_Request * request, int *flag, sc_MPI_Status * status)
+{
+  SC_CHECK_ABORT (*request == sc_MPI_REQUEST_NULL,
+                  "non-MPI MPI_Test handles NULL request only");
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_MPI_Testall (int count, sc_MPI_Request * array_of_requests, int *flag,
+                sc_MPI_Status * array_of_statuses)
+{
+  int                 i;
+
+  for (i = 0; i < count; ++i) {
+    SC_CHECK_ABORT (array_of_requests[i] == sc_MPI_REQUEST_NULL,
+                    "non-MPI MPI_Testall handles NULL requests only");
+  }
+  *flag = 1;
+  return sc_MPI_SUCCESS;
+}
+
 double
 sc_MPI_Wtime (void)
 {
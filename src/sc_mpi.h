@@ -39,8 +39,8 @@
  * Some send and receive routines are wrapped.  They can thus be used
  * in code outside of `#ifdef SC_ENABLE_MPI` even though they will abort.  If
  * no messages are sent to the same processor when mpisize == 1, such aborts
- * will not occur.  The `MPI_Wait*` routines are safe to call as long as no or
- * only MPI_REQUEST_NULL requests are passed in.
+ * will not occur.  The `MPI_Wait*` and `MPI_Test*` routines are safe to
+ * call as long as no or only MPI_REQUEST_NULL requests are passed in.
  */
 
 #ifndef SC_MPI_H
@@ -50,6 +50,10 @@
 
 SC_EXTERN_C_BEGIN;
 
+/* number of nonblocking collectives that may be pending on a communicator;
+   each of them uses its own tag starting at SC_TAG_COLL */
+#define SC_COLL_MAX_PENDING 32
+
 typedef enum
 {
   SC_TAG_FIRST = 's' + 'c',     /* anything really */
@@ -62,7 +66,10 @@ typedef enum
   SC_TAG_REDUCE = SC_TAG_NOTIFY_NARY + 32,
   SC_TAG_PSORT_LO,
   SC_TAG_PSORT_HI,
-  SC_TAG_LAST
+  SC_TAG_PSORT_SAMPLE,
+  SC_TAG_NOTIFY_NBX,
+  SC_TAG_COLL = SC_TAG_NOTIFY_NBX + 2,
+  SC_TAG_LAST = SC_TAG_COLL + SC_COLL_MAX_PENDING
 }
 sc_tag_t;
 
@@ -168,6 +175,7 @@ sc_tag_t;
 #define sc_MPI_Allgather           MPI_Allgather
 #define sc_MPI_Allgatherv          MPI_Allgatherv
 #define sc_MPI_Alltoall            MPI_Alltoall
+#define sc_MPI_Alltoallv           MPI_Alltoallv
 #define sc_MPI_Reduce              MPI_Reduce
 #define sc_MPI_Allreduce           MPI_Allreduce
 #define sc_MPI_Scan                MPI_Scan
@@ -183,6 +191,8 @@ sc_tag_t;
 #define sc_MPI_Wait                MPI_Wait
 #define sc_MPI_Waitsome            MPI_Waitsome
 #define sc_MPI_Waitall             MPI_Waitall
+#define sc_MPI_Test                MPI_Test
+#define sc_MPI_Testall             MPI_Testall
 
 #else /* !SC_ENABLE_MPI */
 
@@ -316,6 +326,9 @@ int                 sc_MPI_Allgatherv (void *, int, sc_MPI_Datatype, void *,
                                        sc_MPI_Comm);
 int                 sc_MPI_Alltoall (void *, int, sc_MPI_Datatype, void *,
                                      int, sc_MPI_Datatype, sc_MPI_Comm);
+int                 sc_MPI_Alltoallv (void *, int *, int *, sc_MPI_Datatype,
+                                      void *, int *, int *, sc_MPI_Datatype,
+                                      sc_MPI_Comm);
 int                 sc_MPI_Reduce (void *, void *, int, sc_MPI_Datatype,
                                    sc_MPI_Op, int, sc_MPI_Comm);
 int                 sc_MPI_Allreduce (void *, void *, int, sc_MPI_Datatype,
@@ -349,6 +362,9 @@ int                 sc_MPI_Wait (sc_MPI_Request *, sc_MPI_Status *);
 int                 sc_MPI_Waitsome (int, sc_MPI_Request *,
                                      int *, int *, sc_MPI_Status *);
 int                 sc_MPI_Waitall (int, sc_MPI_Request *, sc_MPI_Status *);
+int                 sc_MPI_Test (sc_MPI_Request *, int *, sc_MPI_Status *);
+int                 sc_MPI_Testall (int, sc_MPI_Request *, int *,
+                                    sc_MPI_Status *);
 
 #endif /* !SC_ENABLE_MPI */
 
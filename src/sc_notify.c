@@ -23,10 +23,18 @@
 
 #include <sc_functions.h>
 #include <sc_notify.h>
+#include <sc_private.h>
 
 int                 sc_notify_nary_ntop = 2;
 int                 sc_notify_nary_nint = 2;
 int                 sc_notify_nary_nbot = 2;
+sc_notify_type_t    sc_notify_type = SC_NOTIFY_BINARY;
+
+/** Number of timed runs of each algorithm in \ref sc_notify_tune */
+#define SC_NOTIFY_TUNE_RUNS 3
+
+/** Largest fanout of the n-ary tree tried in \ref sc_notify_tune */
+#define SC_NOTIFY_TUNE_MAX_FANOUT 16
 
 #if 0
 
@@ -106,9 +114,11 @@ sc_notify_allgather (int *receivers, int num_receivers,
   return sc_MPI_SUCCESS;
 }
 
-int
-sc_notify_nary (int *receivers, int num_receivers,
-                int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+/** Call \ref sc_notify_ext with the interface of \ref sc_notify. */
+static int
+sc_notify_nary_fanout (int *receivers, int num_receivers,
+                       int *senders, int *num_senders,
+                       int ntop, int nint, int nbot, sc_MPI_Comm mpicomm)
 {
   sc_array_t          reca, snda;
 
@@ -119,9 +129,7 @@ sc_notify_nary (int *receivers, int num_receivers,
   SC_ASSERT (senders != NULL && num_senders != NULL);
   sc_array_init (&snda, sizeof (int));
 
-  sc_notify_ext (&reca, &snda, NULL,
-                 sc_notify_nary_ntop, sc_notify_nary_nint,
-                 sc_notify_nary_nbot, mpicomm);
+  sc_notify_ext (&reca, &snda, NULL, ntop, nint, nbot, mpicomm);
   sc_array_reset (&reca);
 
   *num_senders = (int) snda.elem_count;
@@ -131,23 +139,72 @@ sc_notify_nary (int *receivers, int num_receivers,
   return sc_MPI_SUCCESS;
 }
 
+int
+sc_notify_nary (int *receivers, int num_receivers,
+                int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+{
+  return sc_notify_nary_fanout (receivers, num_receivers,
+                                senders, num_senders,
+                                sc_notify_nary_ntop, sc_notify_nary_nint,
+                                sc_notify_nary_nbot, mpicomm);
+}
+
+/** Number of integers needed to store a payload of a given byte size */
+#define SC_NOTIFY_WORDS(b) ((int) (((b) + sizeof (int) - 1) / sizeof (int)))
+
+/** Return the number of integers taken by one (fromrank, payload) entry.
+ * \param [in] entry        Pointer to the fromrank of the entry.
+ * \param [in] pwords       Number of integers of a fixed-size payload.
+ * \param [in] pvar         If true, the payload has variable size and is
+ *                          stored as byte count followed by the data.
+ */
+static int
+sc_notify_entry_len (const int *entry, int pwords, int pvar)
+{
+  return pvar ? 2 + SC_NOTIFY_WORDS (entry[1]) : 1 + pwords;
+}
+
+/** Return the number of integers taken by one (torank, howmanyfroms, list)
+ * record.  The arguments \b pwords and \b pvar are as above.
+ */
+static int
+sc_notify_record_len (const int *record, int pwords, int pvar)
+{
+  int                 j, len;
+
+  SC_ASSERT (record[1] > 0);
+  if (!pvar) {
+    return 2 + (1 + pwords) * record[1];
+  }
+  for (len = 2, j = 0; j < record[1]; ++j) {
+    len += sc_notify_entry_len (record + len, pwords, pvar);
+  }
+  return len;
+}
+
 /** Encode the receiver list into an array for input.
  * \param [out] input       This function initializes the array.
  *                          All prior content will be overwritten and lost.
  *                          On output, array holding integers.
  * \param [in] receivers        See \ref sc_notify.
  * \param [in] num_receivers    See \ref sc_notify.
+ * \param [in,out] payload      See \ref sc_notify_ext and \ref
+ *                              sc_notify_extv.  Reset on output.
+ * \param [in] offsets          See \ref sc_notify_extv.  If NULL, the payload
+ *                              has one element per receiver.
  * \param [in] mpisize          Number of MPI processes.
  * \param [in] mpirank          MPI rank of this process.
  */
 static void
 sc_notify_init_input (sc_array_t * input, int *receivers, int num_receivers,
-                      sc_array_t * payload, int mpisize, int mpirank)
+                      sc_array_t * payload, sc_array_t * offsets,
+                      int mpisize, int mpirank)
 {
-  int                 withp;
+  int                 pwords;
   int                 rec;
   int                 i;
   int                *pint;
+  size_t              bytes, *poffs;
 
   SC_ASSERT (input != NULL);
 
@@ -155,22 +212,44 @@ sc_notify_init_input (sc_array_t * input, int *receivers, int num_receivers,
   SC_ASSERT (num_receivers >= 0);
   SC_ASSERT (0 <= mpirank && mpirank < mpisize);
 
-  SC_ASSERT (payload == NULL || (int) payload->elem_count == num_receivers);
-  withp = payload != NULL;
+  SC_ASSERT (payload == NULL || offsets != NULL ||
+             (int) payload->elem_count == num_receivers);
+  SC_ASSERT (offsets == NULL ||
+             (payload != NULL &&
+              (int) offsets->elem_count == num_receivers + 1));
+  pwords = payload == NULL || offsets != NULL ? 0 :
+    SC_NOTIFY_WORDS (payload->elem_size);
+  poffs = offsets == NULL ? NULL : (size_t *) offsets->array;
 
-  sc_array_init_count (input, sizeof (int), (3 + withp) * num_receivers);
+  sc_array_init (input, sizeof (int));
   rec = -1;
   for (i = 0; i < num_receivers; ++i) {
     SC_ASSERT (rec < receivers[i]);
     rec = receivers[i];
     SC_ASSERT (0 <= rec && rec < mpisize);
-    pint = (int *) sc_array_index_int (input, (3 + withp) * i);
+    if (poffs == NULL) {
+      pint = (int *) sc_array_push_count (input, 3 + pwords);
+      if (pwords > 0) {
+        /* zero the padding of the last integer before copying */
+        pint[2 + pwords] = 0;
+        memcpy (pint + 3, sc_array_index_int (payload, i),
+                payload->elem_size);
+      }
+    }
+    else {
+      SC_ASSERT (poffs[i] <= poffs[i + 1]);
+      bytes = (poffs[i + 1] - poffs[i]) * payload->elem_size;
+      pint = (int *) sc_array_push_count (input,
+                                          4 + SC_NOTIFY_WORDS (bytes));
+      pint[3] = (int) bytes;
+      if (bytes > 0) {
+        pint[3 + SC_NOTIFY_WORDS (bytes)] = 0;
+        memcpy (pint + 4, sc_array_index (payload, poffs[i]), bytes);
+      }
+    }
     pint[0] = rec;
     pint[1] = 1;
     pint[2] = mpirank;
-    if (withp) {
-      pint[3] = *(int *) sc_array_index_int (payload, i);
-    }
   }
 
   if (payload != NULL) {
@@ -183,19 +262,23 @@ sc_notify_init_input (sc_array_t * input, int *receivers, int num_receivers,
  *                          This function calls \ref sc_array_reset on it.
  * \param [in] senders      See \ref sc_notify.
  * \param [in] num_senders  See \ref sc_notify.
+ * \param [in,out] payload  If not NULL, resized and filled with the payload
+ *                          received from the senders.
+ * \param [in,out] offsets  If not NULL, resized to \b num_senders + 1 and
+ *                          filled with the offsets into \b payload.
  * \param [in] mpisize      Number of MPI processes.
  * \param [in] mpirank      MPI rank of this process.
  */
 static void
 sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
-                        sc_array_t * payload, int mpisize, int mpirank)
+                        sc_array_t * payload, sc_array_t * offsets,
+                        int mpisize, int mpirank)
 {
-#ifdef SC_ENABLE_DEBUG
-  int                 withp, multi;
-#endif
+  int                 pwords, pvar;
   int                 found_num_senders;
-  int                 i;
+  int                 i, k;
   int                *pint;
+  size_t              total, *poffs;
 
   SC_ASSERT (output != NULL);
   SC_ASSERT (output->elem_size == sizeof (int));
@@ -203,11 +286,11 @@ sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
 
   SC_ASSERT (num_senders != NULL);
 
-#ifdef SC_ENABLE_DEBUG
   SC_ASSERT (payload == NULL || (int) payload->elem_count == 0);
-  withp = payload != NULL;
-  multi = 1 + withp;
-#endif
+  SC_ASSERT (offsets == NULL || payload != NULL);
+  pvar = offsets != NULL;
+  pwords = payload == NULL || pvar ? 0 :
+    SC_NOTIFY_WORDS (payload->elem_size);
 
   found_num_senders = 0;
   if (output->elem_count > 0) {
@@ -217,19 +300,49 @@ sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
     SC_ASSERT (pint[0] == mpirank);
     found_num_senders = pint[1];
     SC_ASSERT (found_num_senders > 0);
-    SC_ASSERT ((int) output->elem_count == 2 + multi * found_num_senders);
+    SC_ASSERT ((int) output->elem_count ==
+               sc_notify_record_len (pint, pwords, pvar));
 
     if (payload == NULL) {
       memcpy (senders, pint + 2, found_num_senders * sizeof (int));
     }
-    else {
+    else if (!pvar) {
       sc_array_resize (payload, found_num_senders);
       for (i = 0; i < found_num_senders; ++i) {
-        senders[i] = pint[2 + 2 * i];
-        *(int *) sc_array_index_int (payload, i) = pint[3 + 2 * i];
+        senders[i] = pint[2 + (1 + pwords) * i];
+        memcpy (sc_array_index_int (payload, i),
+                pint + 3 + (1 + pwords) * i, payload->elem_size);
+      }
+    }
+    else {
+      /* first pass to count the payload elements */
+      sc_array_resize (offsets, found_num_senders + 1);
+      poffs = (size_t *) offsets->array;
+      total = 0;
+      for (i = 0, k = 2; i < found_num_senders; ++i) {
+        SC_ASSERT (pint[k + 1] % payload->elem_size == 0);
+        poffs[i] = total;
+        total += pint[k + 1] / payload->elem_size;
+        k += sc_notify_entry_len (pint + k, pwords, pvar);
+      }
+      poffs[found_num_senders] = total;
+
+      /* second pass to copy the payload */
+      sc_array_resize (payload, total);
+      for (i = 0, k = 2; i < found_num_senders; ++i) {
+        senders[i] = pint[k];
+        if (pint[k + 1] > 0) {
+          memcpy (sc_array_index (payload, poffs[i]), pint + k + 2,
+                  pint[k + 1]);
+        }
+        k += sc_notify_entry_len (pint + k, pwords, pvar);
       }
     }
   }
+  else if (pvar) {
+    sc_array_resize (offsets, 1);
+    *(size_t *) sc_array_index (offsets, 0) = 0;
+  }
   *num_senders = found_num_senders;
 
   sc_array_reset (output);
@@ -239,24 +352,27 @@ sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
  * Format of variable-length records:
  * forall(torank): (torank, howmanyfroms, listof(fromrank, payload)).
  * The records must be ordered ascending by torank.
- * The payload is optional and depends on the calling context via \b withp.
+ * The payload is optional and depends on the calling context via \b pwords
+ * and \b pvar.  A fixed-size payload takes \b pwords integers.  A variable
+ * payload is stored as its byte count followed by the padded data.
  */
 static void
 sc_notify_merge (sc_array_t * output, sc_array_t * input, sc_array_t * second,
-                 int withp)
+                 int pwords, int pvar)
 {
   int                 i, ir, j, jr, k;
   int                 torank, numfroms;
-  int                 multi, itemlen;
+  int                 len, lensec;
+  int                 elen, itemlen;
   int                *pint, *psec, *pout;
+  int                *pj, *pjr;
 
   SC_ASSERT (input->elem_size == sizeof (int));
   SC_ASSERT (second->elem_size == sizeof (int));
   SC_ASSERT (output->elem_size == sizeof (int));
   SC_ASSERT (output->elem_count == 0);
 
-  SC_ASSERT (withp == 0 || withp == 1);
-  multi = 1 + withp;
+  SC_ASSERT (pwords >= 0 && (pvar == 0 || pwords == 0));
 
   i = ir = 0;
   torank = -1;
@@ -266,7 +382,7 @@ sc_notify_merge (sc_array_t * output, sc_array_t * input, sc_array_t * second,
       /* ignore data that was sent to the peer earlier */
       pint = (int *) sc_array_index_int (input, i);
       if (pint[0] == -1) {
-        i += 2 + multi * pint[1];
+        i += sc_notify_record_len (pint, pwords, pvar);
         SC_ASSERT (i <= (int) input->elem_count);
         pint = NULL;
       }
@@ -302,39 +418,40 @@ sc_notify_merge (sc_array_t * output, sc_array_t * input, sc_array_t * second,
         SC_ASSERT (torank < pint[0] && pint[0] == psec[0]);
         torank = pint[0];
         SC_ASSERT (pint[1] > 0 && psec[1] > 0);
-        SC_ASSERT (i + 2 + multi * pint[1] <= (int) input->elem_count);
-        SC_ASSERT (ir + 2 + multi * psec[1] <= (int) second->elem_count);
+        len = sc_notify_record_len (pint, pwords, pvar);
+        lensec = sc_notify_record_len (psec, pwords, pvar);
+        SC_ASSERT (i + len <= (int) input->elem_count);
+        SC_ASSERT (ir + lensec <= (int) second->elem_count);
         numfroms = pint[1] + psec[1];
-        itemlen = 2 + multi * numfroms;
+        itemlen = len + lensec - 2;
         pout = (int *) sc_array_push_count (output, itemlen);
         pout[0] = torank;
         pout[1] = numfroms;
         k = 2;
         j = jr = 0;
+        pj = pint + 2;
+        pjr = psec + 2;
 
         while (j < pint[1] || jr < psec[1]) {
-          SC_ASSERT (j >= pint[1] || jr >= psec[1] ||
-                     pint[2 + multi * j] != psec[2 + multi * jr]);
-          if (j < pint[1] &&
-              (jr >= psec[1] || pint[2 + multi * j] < psec[2 + multi * jr])) {
-            pout[k++] = pint[2 + multi * j];
-            if (withp) {
-              pout[k++] = pint[3 + 2 * j];
-            }
+          SC_ASSERT (j >= pint[1] || jr >= psec[1] || pj[0] != pjr[0]);
+          if (j < pint[1] && (jr >= psec[1] || pj[0] < pjr[0])) {
+            elen = sc_notify_entry_len (pj, pwords, pvar);
+            memcpy (pout + k, pj, elen * sizeof (int));
+            pj += elen;
             ++j;
           }
           else {
             SC_ASSERT (jr < psec[1]);
-            pout[k++] = psec[2 + multi * jr];
-            if (withp) {
-              pout[k++] = psec[3 + 2 * jr];
-            }
+            elen = sc_notify_entry_len (pjr, pwords, pvar);
+            memcpy (pout + k, pjr, elen * sizeof (int));
+            pjr += elen;
             ++jr;
           }
+          k += elen;
         }
         SC_ASSERT (k == itemlen);
-        i += 2 + multi * pint[1];
-        ir += 2 + multi * psec[1];
+        i += len;
+        ir += lensec;
         continue;
       }
     }
@@ -344,10 +461,8 @@ sc_notify_merge (sc_array_t * output, sc_array_t * input, sc_array_t * second,
       SC_ASSERT (pint != NULL);
       SC_ASSERT (torank < pint[0]);
       torank = pint[0];
-      SC_ASSERT (i + 2 + multi * pint[1] <= (int) input->elem_count);
-      numfroms = pint[1];
-      SC_ASSERT (numfroms > 0);
-      itemlen = 2 + multi * numfroms;
+      itemlen = sc_notify_record_len (pint, pwords, pvar);
+      SC_ASSERT (i + itemlen <= (int) input->elem_count);
       pout = (int *) sc_array_push_count (output, itemlen);
       memcpy (pout, pint, itemlen * sizeof (int));
       i += itemlen;
@@ -356,10 +471,8 @@ sc_notify_merge (sc_array_t * output, sc_array_t * input, sc_array_t * second,
       SC_ASSERT (pint == NULL);
       SC_ASSERT (torank < psec[0]);
       torank = psec[0];
-      SC_ASSERT (ir + 2 + multi * psec[1] <= (int) second->elem_count);
-      numfroms = psec[1];
-      SC_ASSERT (numfroms > 0);
-      itemlen = 2 + multi * numfroms;
+      itemlen = sc_notify_record_len (psec, pwords, pvar);
+      SC_ASSERT (ir + itemlen <= (int) second->elem_count);
       pout = (int *) sc_array_push_count (output, itemlen);
       memcpy (pout, psec, itemlen * sizeof (int));
       ir += itemlen;
@@ -485,7 +598,7 @@ sc_notify_recursive (sc_MPI_Comm mpicomm, int start, int me, int length,
       if (peer2 >= 0) {
         /* merge the owned and received arrays */
         sc_array_init (&morebuf, sizeof (int));
-        sc_notify_merge (&morebuf, array, recvbuf, 0);
+        sc_notify_merge (&morebuf, array, recvbuf, 0, 0);
         sc_array_reset (array);
 
         /* receive second message */
@@ -500,13 +613,13 @@ sc_notify_recursive (sc_MPI_Comm mpicomm, int start, int me, int length,
         SC_CHECK_MPI (mpiret);
 
         /* merge the second received array */
-        sc_notify_merge (array, &morebuf, recvbuf, 0);
+        sc_notify_merge (array, &morebuf, recvbuf, 0, 0);
         sc_array_reset (&morebuf);
       }
     }
     if (peer2 == -1) {
       sc_array_init (&morebuf, sizeof (int));
-      sc_notify_merge (&morebuf, array, recvbuf, 0);
+      sc_notify_merge (&morebuf, array, recvbuf, 0, 0);
       sc_array_reset (array);
       *array = morebuf;
     }
@@ -544,9 +657,10 @@ sc_notify_recursive (sc_MPI_Comm mpicomm, int start, int me, int length,
 #endif
 }
 
-int
-sc_notify (int *receivers, int num_receivers,
-           int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+/** Execute the binary tree algorithm documented with \ref sc_notify. */
+static int
+sc_notify_binary (int *receivers, int num_receivers,
+                  int *senders, int *num_senders, sc_MPI_Comm mpicomm)
 {
   int                 mpiret;
   int                 mpisize, mpirank;
@@ -564,19 +678,123 @@ sc_notify (int *receivers, int num_receivers,
   SC_ASSERT (pow2length / 2 < mpisize && mpisize <= pow2length);
 
   /* convert input variables into internal format */
-  sc_notify_init_input (&array, receivers, num_receivers, NULL,
+  sc_notify_init_input (&array, receivers, num_receivers, NULL, NULL,
                         mpisize, mpirank);
 
   /* execute the recursive algorithm */
   sc_notify_recursive (mpicomm, 0, mpirank, pow2length, mpisize, &array);
 
   /* convert internal format to output variables */
-  sc_notify_reset_output (&array, senders, num_senders, NULL,
+  sc_notify_reset_output (&array, senders, num_senders, NULL, NULL,
                           mpisize, mpirank);
 
   return sc_MPI_SUCCESS;
 }
 
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+
+static int          sc_notify_nbx_keyval = MPI_KEYVAL_INVALID;
+
+/** Alternate the message tag between successive calls on a communicator.
+ * A process may leave \ref sc_notify_nbx and send the messages of its next
+ * call while another process is still receiving.  Such a process may be at
+ * most one call behind, so two tags suffice.  We count the calls in an
+ * attribute that is stored in the communicator.
+ */
+static int
+sc_notify_nbx_tag (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 flag;
+  void               *value;
+  intptr_t            count;
+
+  if (sc_notify_nbx_keyval == MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_notify_nbx_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Comm_get_attr (mpicomm, sc_notify_nbx_keyval, &value, &flag);
+  SC_CHECK_MPI (mpiret);
+  count = flag ? (intptr_t) value : 0;
+  mpiret = MPI_Comm_set_attr (mpicomm, sc_notify_nbx_keyval,
+                              (void *) (count + 1));
+  SC_CHECK_MPI (mpiret);
+
+  return SC_TAG_NOTIFY_NBX + (int) (count & 1);
+}
+
+#endif
+
+int
+sc_notify_nbx (int *receivers, int num_receivers,
+               int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+{
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+  int                 i;
+  int                 mpiret;
+  int                 found_num_senders;
+  int                 tag;
+  int                 flag, sent, done;
+  char                dummy;
+  MPI_Request        *sendreqs, barrier;
+  MPI_Status          status;
+
+  SC_ASSERT (receivers != NULL || num_receivers == 0);
+  SC_ASSERT (num_receivers >= 0);
+  SC_ASSERT (senders != NULL && num_senders != NULL);
+
+  /* synchronous sends complete only when matched by the receiver */
+  tag = sc_notify_nbx_tag (mpicomm);
+  sendreqs = SC_ALLOC (MPI_Request, num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    mpiret = MPI_Issend (&dummy, 0, MPI_BYTE, receivers[i], tag,
+                         mpicomm, sendreqs + i);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* receive until all processes have had their sends matched */
+  found_num_senders = 0;
+  sent = done = 0;
+  barrier = MPI_REQUEST_NULL;
+  while (!done) {
+    mpiret = MPI_Iprobe (MPI_ANY_SOURCE, tag, mpicomm, &flag, &status);
+    SC_CHECK_MPI (mpiret);
+    if (flag) {
+      mpiret = MPI_Recv (&dummy, 0, MPI_BYTE, status.MPI_SOURCE, tag,
+                         mpicomm, MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      senders[found_num_senders++] = status.MPI_SOURCE;
+    }
+    if (!sent) {
+      mpiret = MPI_Testall (num_receivers, sendreqs, &sent,
+                            MPI_STATUSES_IGNORE);
+      SC_CHECK_MPI (mpiret);
+      if (sent) {
+        mpiret = MPI_Ibarrier (mpicomm, &barrier);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    else {
+      mpiret = MPI_Test (&barrier, &done, MPI_STATUS_IGNORE);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  SC_FREE (sendreqs);
+
+  /* messages arrive in any order */
+  qsort (senders, found_num_senders, sizeof (int), sc_int_compare);
+  *num_senders = found_num_senders;
+
+  return sc_MPI_SUCCESS;
+#else
+  /* without nonblocking collectives we use the n-ary tree */
+  return sc_notify_nary (receivers, num_receivers,
+                         senders, num_senders, mpicomm);
+#endif
+}
+
 typedef struct sc_notify_nary
 {
   sc_MPI_Comm         mpicomm;
@@ -584,7 +802,7 @@ typedef struct sc_notify_nary
   int                 mpirank;
   int                 ntop, nint, nbot;
   int                 depth;
-  int                 withp;
+  int                 pwords, pvar;
 }
 sc_notify_nary_t;
 
@@ -605,10 +823,10 @@ sc_notify_recursive_nary (const sc_notify_nary_t * nary, int level,
   int                 i, j;
   int                 mpiret;
   int                 num_ta;
-  int                 torank, numfroms;
+  int                 torank;
 #ifdef SC_ENABLE_DEBUG
   int                 fromrank, num_out, missing;
-  int                 freed, multi;
+  int                 freed, k, numfroms;
 #endif
   int                 peer, source;
   int                 tag, count;
@@ -732,9 +950,8 @@ sc_notify_recursive_nary (const sc_notify_nary_t * nary, int level,
       torank = pint[0];
       SC_ASSERT (0 <= torank && torank < groupsize);
       SC_ASSERT (torank % lengthn == me % lengthn);
-      numfroms = pint[1];
-      SC_ASSERT (numfroms > 0);
-      itemlen = 2 + (1 + nary->withp) * numfroms;
+      SC_ASSERT (pint[1] > 0);
+      itemlen = sc_notify_record_len (pint, nary->pwords, nary->pvar);
       topart = (torank % length) / lengthn;
       sendbuf = (sc_array_t *) sc_array_index_int
         (topart == mypart ? &recvbufs : &sendbufs, topart);
@@ -818,7 +1035,7 @@ sc_notify_recursive_nary (const sc_notify_nary_t * nary, int level,
         aone = (sc_array_t *) sc_array_index_int (&recvbufs, i);
         atwo = (sc_array_t *) sc_array_index_int (&recvbufs, i + power);
         sc_array_init (array, sizeof (int));
-        sc_notify_merge (array, aone, atwo, nary->withp);
+        sc_notify_merge (array, aone, atwo, nary->pwords, nary->pvar);
 
         /* the surviving array lives on in aone */
         sc_array_reset (aone);
@@ -864,22 +1081,27 @@ sc_notify_recursive_nary (const sc_notify_nary_t * nary, int level,
     SC_ASSERT (torank % length == me % length);
     numfroms = pint[1];
     SC_ASSERT (numfroms > 0);
-    multi = 1 + nary->withp;
     fromrank = -1;
-    for (j = 0; j < numfroms; ++j) {
-      SC_ASSERT (fromrank < pint[2 + multi * j]);
-      fromrank = pint[2 + multi * j];
+    for (k = 2, j = 0; j < numfroms; ++j) {
+      SC_ASSERT (fromrank < pint[k]);
+      fromrank = pint[k];
+      k += sc_notify_entry_len (pint + k, nary->pwords, nary->pvar);
     }
-    i += 2 + multi * numfroms;
+    i += k;
   }
   SC_ASSERT (i == num_out);
 #endif
 }
 
-void
-sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
-               sc_array_t * payload,
-               int ntop, int nint, int nbot, sc_MPI_Comm mpicomm)
+/** Execute \ref sc_notify_ext or \ref sc_notify_extv.
+ * \param [in,out] offsets  If NULL, \b payload has one element per receiver
+ *                          or is NULL itself.  Otherwise, see \ref
+ *                          sc_notify_extv.
+ */
+static void
+sc_notify_ext_internal (sc_array_t * receivers, sc_array_t * senders,
+                        sc_array_t * payload, sc_array_t * offsets,
+                        int ntop, int nint, int nbot, sc_MPI_Comm mpicomm)
 {
   int                 mpiret;
   int                 mpisize, mpirank;
@@ -901,9 +1123,15 @@ sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
   }
 
   SC_ASSERT (payload == NULL ||
-             (SC_ARRAY_IS_OWNER (payload) &&
-              payload->elem_size == sizeof (int) &&
-              (int) payload->elem_count == num_receivers));
+             (SC_ARRAY_IS_OWNER (payload) && payload->elem_size > 0 &&
+              (offsets != NULL ||
+               (int) payload->elem_count == num_receivers)));
+  SC_ASSERT (offsets == NULL ||
+             (payload != NULL && SC_ARRAY_IS_OWNER (offsets) &&
+              offsets->elem_size == sizeof (size_t) &&
+              (int) offsets->elem_count == num_receivers + 1 &&
+              *(size_t *) sc_array_index_int (offsets, num_receivers) ==
+              payload->elem_count));
 
   mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
   SC_CHECK_MPI (mpiret);
@@ -952,11 +1180,13 @@ sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
   nary->nint = nint;
   nary->nbot = nbot;
   nary->depth = depth;
-  nary->withp = payload != NULL;
+  nary->pvar = offsets != NULL;
+  nary->pwords = payload == NULL || nary->pvar ? 0 :
+    SC_NOTIFY_WORDS (payload->elem_size);
 
   /* convert input variables into internal format */
   sc_notify_init_input (array, (int *) receivers->array, num_receivers,
-                        payload, mpisize, mpirank);
+                        payload, offsets, mpisize, mpirank);
   if (senders == NULL) {
     sc_array_reset (receivers);
     senders = receivers;
@@ -972,5 +1202,421 @@ sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
     sc_array_resize (senders, num_senders);
   }
   sc_notify_reset_output (array, (int *) senders->array, &num_senders,
-                          payload, mpisize, mpirank);
+                          payload, offsets, mpisize, mpirank);
+}
+
+void
+sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
+               sc_array_t * payload,
+               int ntop, int nint, int nbot, sc_MPI_Comm mpicomm)
+{
+  sc_notify_ext_internal (receivers, senders, payload, NULL,
+                          ntop, nint, nbot, mpicomm);
+}
+
+void
+sc_notify_extv (sc_array_t * receivers, sc_array_t * senders,
+                sc_array_t * payload, sc_array_t * offsets,
+                int ntop, int nint, int nbot, sc_MPI_Comm mpicomm)
+{
+  SC_ASSERT (payload != NULL && offsets != NULL);
+
+  sc_notify_ext_internal (receivers, senders, payload, offsets,
+                          ntop, nint, nbot, mpicomm);
+}
+
+#ifdef SC_ENABLE_MPI
+
+static int          sc_notify_tune_keyval = MPI_KEYVAL_INVALID;
+
+#else
+
+/* without MPI there is only one communicator to remember the choice for */
+static intptr_t     sc_notify_tune_value = 0;
+
+#endif
+
+/** Remember the choice of \ref sc_notify_tune for a communicator.
+ * The choice is encoded in the attribute value to avoid allocation.
+ */
+static void
+sc_notify_tune_store (sc_MPI_Comm mpicomm, sc_notify_type_t type, int fanout)
+{
+  const intptr_t      value = (intptr_t) type + 256 * fanout;
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+  if (sc_notify_tune_keyval == MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN,
+                                     MPI_COMM_NULL_DELETE_FN,
+                                     &sc_notify_tune_keyval, NULL);
+    SC_CHECK_MPI (mpiret);
+  }
+  mpiret = MPI_Comm_set_attr (mpicomm, sc_notify_tune_keyval, (void *) value);
+  SC_CHECK_MPI (mpiret);
+#else
+  sc_notify_tune_value = value;
+#endif
+}
+
+int
+sc_notify_tune_lookup (sc_MPI_Comm mpicomm,
+                       sc_notify_type_t * type, int *fanout)
+{
+  int                 flag;
+  intptr_t            value;
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+  void               *attr;
+
+  flag = 0;
+  value = 0;
+  if (sc_notify_tune_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_get_attr (mpicomm, sc_notify_tune_keyval,
+                                &attr, &flag);
+    SC_CHECK_MPI (mpiret);
+    value = (intptr_t) attr;
+  }
+#else
+  value = sc_notify_tune_value;
+  flag = value != 0;
+#endif
+  if (flag) {
+    SC_ASSERT (type != NULL && fanout != NULL);
+    *type = (sc_notify_type_t) (value % 256);
+    *fanout = (int) (value / 256);
+  }
+  return flag;
+}
+
+/** Time one algorithm by the slowest process in the best of a few runs.
+ * \param [in] fanout       Number of children for \ref SC_NOTIFY_NARY.
+ */
+static double
+sc_notify_tune_time (sc_notify_type_t type, int fanout,
+                     int *receivers, int num_receivers,
+                     int *senders, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 num_senders;
+  int                 i;
+  double              elapsed, gelapsed, best;
+
+  best = -1.;
+  for (i = 0; i < SC_NOTIFY_TUNE_RUNS; ++i) {
+    /* successive calls must not receive each other's messages */
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+
+    elapsed = -sc_MPI_Wtime ();
+    switch (type) {
+    case SC_NOTIFY_ALLGATHER:
+      mpiret = sc_notify_allgather (receivers, num_receivers,
+                                    senders, &num_senders, mpicomm);
+      break;
+    case SC_NOTIFY_BINARY:
+      mpiret = sc_notify_binary (receivers, num_receivers,
+                                 senders, &num_senders, mpicomm);
+      break;
+    case SC_NOTIFY_NARY:
+      mpiret = sc_notify_nary_fanout (receivers, num_receivers,
+                                      senders, &num_senders,
+                                      fanout, fanout, fanout, mpicomm);
+      break;
+    case SC_NOTIFY_NBX:
+      mpiret = sc_notify_nbx (receivers, num_receivers,
+                              senders, &num_senders, mpicomm);
+      break;
+    default:
+      SC_ABORT_NOT_REACHED ();
+    }
+    SC_CHECK_MPI (mpiret);
+    elapsed += sc_MPI_Wtime ();
+
+    mpiret = sc_MPI_Allreduce (&elapsed, &gelapsed, 1, sc_MPI_DOUBLE,
+                               sc_MPI_MAX, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (best < 0. || gelapsed < best) {
+      best = gelapsed;
+    }
+  }
+
+  return best;
+}
+
+sc_notify_type_t
+sc_notify_tune (int *receivers, int num_receivers, int *fanout,
+                sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 k, best_fanout;
+  int                *senders;
+  double              elapsed, best_elapsed;
+  sc_notify_type_t    best_type;
+
+  SC_ASSERT (receivers != NULL || num_receivers == 0);
+  SC_ASSERT (fanout != NULL);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  best_type = SC_NOTIFY_BINARY;
+  best_fanout = 2;
+  if (mpisize == 1) {
+    /* every algorithm only copies the receivers, so there is no contest */
+    sc_notify_tune_store (mpicomm, best_type, best_fanout);
+    *fanout = best_fanout;
+    return best_type;
+  }
+  senders = SC_ALLOC (int, mpisize);
+
+  /* time the candidates, where larger trees would all be the same */
+  best_elapsed = sc_notify_tune_time (SC_NOTIFY_BINARY, 0, receivers,
+                                      num_receivers, senders, mpicomm);
+  elapsed = sc_notify_tune_time (SC_NOTIFY_ALLGATHER, 0, receivers,
+                                 num_receivers, senders, mpicomm);
+  if (elapsed < best_elapsed) {
+    best_type = SC_NOTIFY_ALLGATHER;
+    best_elapsed = elapsed;
+  }
+  for (k = 2; k <= SC_NOTIFY_TUNE_MAX_FANOUT; k *= 2) {
+    elapsed = sc_notify_tune_time (SC_NOTIFY_NARY, k, receivers,
+                                   num_receivers, senders, mpicomm);
+    if (elapsed < best_elapsed) {
+      best_type = SC_NOTIFY_NARY;
+      best_fanout = k;
+      best_elapsed = elapsed;
+    }
+    if (k >= mpisize) {
+      break;
+    }
+  }
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+  elapsed = sc_notify_tune_time (SC_NOTIFY_NBX, 0, receivers,
+                                 num_receivers, senders, mpicomm);
+  if (elapsed < best_elapsed) {
+    best_type = SC_NOTIFY_NBX;
+    best_elapsed = elapsed;
+  }
+#endif
+  SC_FREE (senders);
+  SC_GLOBAL_LDEBUGF ("Notify tuned to type %d fanout %d time %g\n",
+                     (int) best_type, best_fanout, best_elapsed);
+  sc_notify_tune_store (mpicomm, best_type, best_fanout);
+
+  *fanout = best_fanout;
+  return best_type;
+}
+
+int
+sc_notify (int *receivers, int num_receivers,
+           int *senders, int *num_senders, sc_MPI_Comm mpicomm)
+{
+  int                 fanout;
+  sc_notify_type_t    type;
+
+  type = sc_notify_type;
+  fanout = 2;
+  if (type == SC_NOTIFY_AUTO) {
+    /* the attribute is set on all processes in the same call */
+    if (!sc_notify_tune_lookup (mpicomm, &type, &fanout)) {
+      type = sc_notify_tune (receivers, num_receivers, &fanout, mpicomm);
+    }
+  }
+
+  switch (type) {
+  case SC_NOTIFY_BINARY:
+    return sc_notify_binary (receivers, num_receivers,
+                             senders, num_senders, mpicomm);
+  case SC_NOTIFY_ALLGATHER:
+    return sc_notify_allgather (receivers, num_receivers,
+                                senders, num_senders, mpicomm);
+  case SC_NOTIFY_NARY:
+    if (sc_notify_type == SC_NOTIFY_NARY) {
+      return sc_notify_nary (receivers, num_receivers,
+                             senders, num_senders, mpicomm);
+    }
+    return sc_notify_nary_fanout (receivers, num_receivers,
+                                  senders, num_senders,
+                                  fanout, fanout, fanout, mpicomm);
+  case SC_NOTIFY_NBX:
+    return sc_notify_nbx (receivers, num_receivers,
+                          senders, num_senders, mpicomm);
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+sc_notify_plan_t   *
+sc_notify_plan_new (sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  sc_notify_plan_t   *plan;
+
+  plan = SC_ALLOC (sc_notify_plan_t, 1);
+  plan->mpicomm = mpicomm;
+  mpiret = sc_MPI_Comm_size (mpicomm, &plan->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &plan->mpirank);
+  SC_CHECK_MPI (mpiret);
+  plan->num_executed = plan->num_unchanged = 0;
+
+  sc_array_init (&plan->receivers, sizeof (int));
+  sc_array_init (&plan->senders, sizeof (int));
+  sc_array_init (&plan->delta, sizeof (int));
+  sc_array_init (&plan->scratch, sizeof (int));
+
+  return plan;
+}
+
+void
+sc_notify_plan_destroy (sc_notify_plan_t * plan)
+{
+  SC_ASSERT (plan != NULL);
+
+  sc_array_reset (&plan->receivers);
+  sc_array_reset (&plan->senders);
+  sc_array_reset (&plan->delta);
+  sc_array_reset (&plan->scratch);
+
+  SC_FREE (plan);
+}
+
+/** Compare the new receivers with the cached ones.
+ * \param [in,out] plan     The added and removed ranks are placed into
+ *                          plan->delta in ascending order.
+ */
+static void
+sc_notify_plan_diff (sc_notify_plan_t * plan,
+                     const int *receivers, int num_receivers)
+{
+  int                 i, j, num_old;
+  const int          *old;
+
+  sc_array_truncate (&plan->delta);
+
+  old = (const int *) plan->receivers.array;
+  num_old = (int) plan->receivers.elem_count;
+  for (i = j = 0; i < num_receivers || j < num_old;) {
+    if (j == num_old || (i < num_receivers && receivers[i] < old[j])) {
+      SC_ASSERT (0 <= receivers[i] && receivers[i] < plan->mpisize);
+      SC_ASSERT (i == 0 || receivers[i - 1] < receivers[i]);
+      *(int *) sc_array_push (&plan->delta) = receivers[i++];
+    }
+    else if (i == num_receivers || old[j] < receivers[i]) {
+      *(int *) sc_array_push (&plan->delta) = old[j++];
+    }
+    else {
+      ++i;
+      ++j;
+    }
+  }
+}
+
+/** Apply the delta received from the notify to the cached senders.
+ * A rank in the delta has either started or stopped sending, which is
+ * decided by whether it is contained in the cached senders.
+ * \param [in,out] plan     The sending ranks in plan->delta are merged
+ *                          into plan->senders.
+ */
+static void
+sc_notify_plan_update (sc_notify_plan_t * plan)
+{
+  int                 i, j, num_delta, num_old;
+  const int          *delta, *old;
+  sc_array_t          swap;
+
+  delta = (const int *) plan->delta.array;
+  num_delta = (int) plan->delta.elem_count;
+  old = (const int *) plan->senders.array;
+  num_old = (int) plan->senders.elem_count;
+
+  sc_array_truncate (&plan->scratch);
+  for (i = j = 0; i < num_delta || j < num_old;) {
+    if (i == num_delta || (j < num_old && old[j] < delta[i])) {
+      *(int *) sc_array_push (&plan->scratch) = old[j++];
+    }
+    else if (j == num_old || delta[i] < old[j]) {
+      /* a new sender has appeared */
+      *(int *) sc_array_push (&plan->scratch) = delta[i++];
+    }
+    else {
+      /* an existing sender has stopped sending */
+      ++i;
+      ++j;
+    }
+  }
+
+  swap = plan->senders;
+  plan->senders = plan->scratch;
+  plan->scratch = swap;
+}
+
+int
+sc_notify_plan_execute (sc_notify_plan_t * plan,
+                        int *receivers, int num_receivers,
+                        int *senders, int *num_senders)
+{
+  int                 mpiret;
+  int                 changed, gchanged;
+
+  SC_ASSERT (plan != NULL);
+  SC_ASSERT (receivers != NULL || num_receivers == 0);
+  SC_ASSERT (0 <= num_receivers && num_receivers <= plan->mpisize);
+  SC_ASSERT (senders != NULL && num_senders != NULL);
+
+  /* a change anywhere requires the delta exchange on all processes */
+  sc_notify_plan_diff (plan, receivers, num_receivers);
+  changed = (int) plan->delta.elem_count;
+  mpiret = sc_MPI_Allreduce (&changed, &gchanged, 1, sc_MPI_INT,
+                             sc_MPI_MAX, plan->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  ++plan->num_executed;
+  if (gchanged == 0) {
+    ++plan->num_unchanged;
+  }
+  else {
+    /* the receivers of a change know from their senders what it was */
+    sc_notify_ext (&plan->delta, NULL, NULL,
+                   sc_notify_nary_ntop, sc_notify_nary_nint,
+                   sc_notify_nary_nbot, plan->mpicomm);
+    sc_notify_plan_update (plan);
+
+    sc_array_resize (&plan->receivers, (size_t) num_receivers);
+    if (num_receivers > 0) {
+      memcpy (plan->receivers.array, receivers,
+              num_receivers * sizeof (int));
+    }
+  }
+
+  *num_senders = (int) plan->senders.elem_count;
+  if (*num_senders > 0) {
+    memcpy (senders, plan->senders.array, *num_senders * sizeof (int));
+  }
+
+  return sc_MPI_SUCCESS;
+}
+
+void
+sc_notify_keyvals_free (void)
+{
+#ifdef SC_ENABLE_MPI
+  int                 mpiret;
+
+#if MPI_VERSION >= 3
+  if (sc_notify_nbx_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_free_keyval (&sc_notify_nbx_keyval);
+    SC_CHECK_MPI (mpiret);
+    sc_notify_nbx_keyval = MPI_KEYVAL_INVALID;
+  }
+#endif
+  if (sc_notify_tune_keyval != MPI_KEYVAL_INVALID) {
+    mpiret = MPI_Comm_free_keyval (&sc_notify_tune_keyval);
+    SC_CHECK_MPI (mpiret);
+    sc_notify_tune_keyval = MPI_KEYVAL_INVALID;
+  }
+#else
+  sc_notify_tune_value = 0;
+#endif
 }
@@ -37,6 +37,21 @@ extern int          sc_notify_nary_nint;
 /** Number of children at deepest level of tree; initialized to 2 */
 extern int          sc_notify_nary_nbot;
 
+/** The algorithms available to \ref sc_notify. */
+typedef enum sc_notify_type
+{
+  SC_NOTIFY_BINARY,     /**< Binary tree as in \ref sc_notify. */
+  SC_NOTIFY_ALLGATHER,  /**< Use \ref sc_notify_allgather. */
+  SC_NOTIFY_NARY,       /**< Use \ref sc_notify_nary. */
+  SC_NOTIFY_NBX,        /**< Use \ref sc_notify_nbx. */
+  SC_NOTIFY_AUTO        /**< Choose by \ref sc_notify_tune once for each
+                             communicator and remember the choice. */
+}
+sc_notify_type_t;
+
+/** Algorithm used by \ref sc_notify; initialized to \ref SC_NOTIFY_BINARY */
+extern sc_notify_type_t sc_notify_type;
+
 /** Collective call to notify a set of receiver ranks of current rank.
  * This version uses one call to sc_MPI_Allgather and one to sc_MPI_Allgatherv.
  * We provide hand-coded alternatives \ref sc_notify and \ref sc_notify_nary.
@@ -77,6 +92,9 @@ int                 sc_notify_nary (int *receivers, int num_receivers,
  * We use a binary tree to construct the communication pattern.
  * This minimizes the number of messages at the cost of more messages
  * compared to a fatter tree such as configurable with \ref sc_notify_nary.
+ * Another algorithm is used if \ref sc_notify_type is changed.
+ * With \ref SC_NOTIFY_AUTO, the first call on a communicator executes
+ * \ref sc_notify_tune with its arguments and later calls reuse the result.
  * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
  * \param [in] num_receivers    Count of ranks contained in receivers.
  * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
@@ -90,6 +108,27 @@ int                 sc_notify (int *receivers, int num_receivers,
                                int *senders, int *num_senders,
                                sc_MPI_Comm mpicomm);
 
+/** Collective call to notify a set of receiver ranks of current rank.
+ * This implementation uses the nonblocking consensus algorithm by Hoefler,
+ * Siebert and Lumsdaine.  Every receiver is sent one synchronous message.
+ * When all of these are matched, a process enters a nonblocking barrier
+ * while it keeps receiving, and it returns once the barrier has completed.
+ * The number of messages is independent of the number of processes, which
+ * makes this variant attractive for sparse patterns on many processes.
+ * If MPI is disabled or older than version 3, we call \ref sc_notify_nary.
+ * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
+ * \param [in] num_receivers    Count of ranks contained in receivers.
+ * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
+ *                              On output it contains the notifying ranks,
+ *                              whose number is returned in \b num_senders.
+ * \param [out] num_senders     On output the number of notifying ranks.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_nbx (int *receivers, int num_receivers,
+                                   int *senders, int *num_senders,
+                                   sc_MPI_Comm mpicomm);
+
 /** Collective call to notify a set of receiver ranks of current rank.
  * This implementation uses a configurable n-ary tree for reduced latency.
  * This function allows to configure the mode of operation in detail.
@@ -108,7 +147,7 @@ int                 sc_notify (int *receivers, int num_receivers,
  *                              Thus, it must not be a view.
  * \param [in,out] payload      This array pointer may be NULL.
  *                              If not, it must not be a view and have
- *                              \b num_receivers entries of sizeof (int) on input.
+ *                              \b num_receivers entries of any size on input.
  *                              This data will be communicated to the receivers.
  *                              On output, the array is resized to \b
  *                              *num_senders and contains the result.
@@ -127,6 +166,113 @@ void                sc_notify_ext (sc_array_t * receivers,
                                    int ntop, int nint, int nbot,
                                    sc_MPI_Comm mpicomm);
 
+/** Collective call to notify a set of receiver ranks of current rank.
+ * Each receiver is sent a payload of variable length that travels through
+ * the same n-ary tree as \ref sc_notify_ext.  This way, small messages are
+ * delivered without an additional round of point-to-point communication.
+ * \param [in,out] receivers    See \ref sc_notify_ext.
+ * \param [in,out] senders      See \ref sc_notify_ext.
+ * \param [in,out] payload      Array of any element size that must not be a
+ *                              view.  On input, it holds the payload for
+ *                              all receivers one after another.
+ *                              On output, it is resized and holds the payload
+ *                              from all senders one after another.
+ * \param [in,out] offsets      Array of type size_t that must not be a view.
+ *                              On input, it has \b num_receivers + 1 entries.
+ *                              The payload for receiver i consists of the
+ *                              elements offsets[i] up to offsets[i + 1] - 1.
+ *                              On output, it is resized to the number of
+ *                              senders + 1 with the analogous meaning.
+ * \param [in] ntop             See \ref sc_notify_ext.
+ * \param [in] nint             See \ref sc_notify_ext.
+ * \param [in] nbot             See \ref sc_notify_ext.
+ * \param [in] mpicomm          MPI communicator to use.
+ *                              This function aborts on MPI error.
+ */
+void                sc_notify_extv (sc_array_t * receivers,
+                                    sc_array_t * senders, sc_array_t * payload,
+                                    sc_array_t * offsets,
+                                    int ntop, int nint, int nbot,
+                                    sc_MPI_Comm mpicomm);
+
+/** Collective call to choose the fastest algorithm for a given pattern.
+ * Each of the binary tree, \ref sc_notify_allgather, \ref sc_notify_ext with
+ * a fanout of 2, 4, 8 and 16, and \ref sc_notify_nbx is timed with the
+ * receivers passed in.  The winner is stored as an attribute of the
+ * communicator, where \ref sc_notify with \ref SC_NOTIFY_AUTO finds it.
+ * Without MPI, the choice is kept in a static variable instead.
+ * On a single process nothing is timed and the binary tree is chosen.
+ * Calling this function again replaces the stored choice.
+ * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
+ * \param [in] num_receivers    Count of ranks contained in receivers.
+ * \param [out] fanout          Number of children of the n-ary tree if
+ *                              \ref SC_NOTIFY_NARY is returned.
+ * \param [in] mpicomm          MPI communicator to use.
+ * \return                      The fastest algorithm.
+ */
+sc_notify_type_t    sc_notify_tune (int *receivers, int num_receivers,
+                                    int *fanout, sc_MPI_Comm mpicomm);
+
+/** Query the choice stored for a communicator by \ref sc_notify_tune.
+ * \param [in] mpicomm          MPI communicator to query.
+ * \param [out] type            If a choice is stored, set to its algorithm.
+ * \param [out] fanout          If a choice is stored, set to its fanout.
+ * \return                      True if a choice is stored, false otherwise.
+ */
+int                 sc_notify_tune_lookup (sc_MPI_Comm mpicomm,
+                                           sc_notify_type_t * type,
+                                           int *fanout);
+
+/** A persistent plan for repeated calls to notify with a slowly changing
+ * pattern.  It caches the receivers and senders of the previous execution.
+ * All members are considered read-only by the user.
+ */
+typedef struct sc_notify_plan
+{
+  sc_MPI_Comm         mpicomm;          /**< Communicator of the plan. */
+  int                 mpisize;          /**< Size of the communicator. */
+  int                 mpirank;          /**< Rank in the communicator. */
+  long                num_executed;     /**< Number of executions. */
+  long                num_unchanged;    /**< Executions without messages. */
+  sc_array_t          receivers;        /**< Receivers of last execution. */
+  sc_array_t          senders;          /**< Senders of last execution. */
+  sc_array_t          delta;            /**< Internal buffer of changes. */
+  sc_array_t          scratch;          /**< Internal buffer for merging. */
+}
+sc_notify_plan_t;
+
+/** Create a persistent notify plan with an empty communication pattern.
+ * \param [in] mpicomm          MPI communicator to use.  Must remain valid
+ *                              until the plan is destroyed.
+ * \return                      A plan to be passed to \ref
+ *                              sc_notify_plan_execute.
+ */
+sc_notify_plan_t   *sc_notify_plan_new (sc_MPI_Comm mpicomm);
+
+/** Destroy a persistent notify plan.
+ * \param [in] plan             This plan is freed.
+ */
+void                sc_notify_plan_destroy (sc_notify_plan_t * plan);
+
+/** Collective call to notify a set of receiver ranks of current rank.
+ * The result is the same as that of \ref sc_notify, but only the receivers
+ * added or removed since the previous execution are communicated through
+ * \ref sc_notify_ext.  If no receiver changed on any process, a single
+ * sc_MPI_Allreduce is the only communication and the cached senders are
+ * returned.
+ * \param [in,out] plan         Plan created by \ref sc_notify_plan_new.
+ * \param [in] receivers        Sorted and unique array of MPI ranks to inform.
+ * \param [in] num_receivers    Count of ranks contained in receivers.
+ * \param [in,out] senders      Array of at least size sc_MPI_Comm_size.
+ *                              On output it contains the notifying ranks,
+ *                              whose number is returned in \b num_senders.
+ * \param [out] num_senders     On output the number of notifying ranks.
+ * \return                      Aborts on MPI error or returns sc_MPI_SUCCESS.
+ */
+int                 sc_notify_plan_execute (sc_notify_plan_t * plan,
+                                            int *receivers, int num_receivers,
+                                            int *senders, int *num_senders);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_NOTIFY_H */
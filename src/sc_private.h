@@ -44,6 +44,16 @@ SC_EXTERN_C_BEGIN;
  */
 void                sc_package_rc_count_add (int package_id, int toadd);
 
+/** Free the communicator attribute keys of the notify tag and tuning.
+ * This function is called by \ref sc_finalize.
+ */
+void                sc_notify_keyvals_free (void);
+
+/** Free the communicator attribute key of the collective schedules.
+ * This function is called by \ref sc_finalize.
+ */
+void                sc_coll_keyval_free (void);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_PRIVATE_H */
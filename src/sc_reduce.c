@@ -220,6 +220,180 @@ sc_reduce_recursive (sc_MPI_Comm mpicomm,
   }
 }
 
+/** Fold the surplus over a power of two processes into their neighbors.
+ * The lowest 2 * rem processes pair up; the even one hands its data to the
+ * odd one and drops out until \ref sc_reduce_schedule_unfold.
+ * \return         The rank among the remaining pof2 processes or -1.
+ */
+static int
+sc_reduce_schedule_fold (sc_coll_t * coll, char *data, char *temp, int count,
+                         sc_MPI_Datatype datatype, int rem, int myrank,
+                         sc_reduce_t reduce_fn)
+{
+  const size_t        datasize = (size_t) count * sc_mpi_sizeof (datatype);
+
+  if (myrank < 2 * rem) {
+    if (myrank % 2 == 0) {
+      sc_coll_send (coll, data, datasize, myrank + 1);
+      sc_coll_fence (coll);
+      return -1;
+    }
+    sc_coll_recv (coll, temp, datasize, myrank - 1);
+    sc_coll_fence (coll);
+    sc_coll_reduce (coll, reduce_fn, temp, data, count, datatype);
+    return myrank / 2;
+  }
+  return myrank - rem;
+}
+
+/** Return the result to the processes dropped by the fold. */
+static void
+sc_reduce_schedule_unfold (sc_coll_t * coll, char *data, size_t datasize,
+                           int rem, int myrank)
+{
+  if (myrank < 2 * rem) {
+    if (myrank % 2 == 0) {
+      sc_coll_recv (coll, data, datasize, myrank + 1);
+    }
+    else {
+      sc_coll_send (coll, data, datasize, myrank - 1);
+    }
+    sc_coll_fence (coll);
+  }
+}
+
+/** Allreduce by recursive doubling for short vectors.
+ * In each round, a process exchanges its partial result with the peer
+ * whose rank differs in one bit and combines both.  The operation must be
+ * commutative for all processes to obtain the same result.
+ */
+static void
+sc_reduce_schedule_doubling (sc_coll_t * coll, void *data, int count,
+                             sc_MPI_Datatype datatype, int groupsize,
+                             int myrank, sc_reduce_t reduce_fn)
+{
+  int                 i, mask;
+  int                 pof2, rem, newrank, peer;
+  char               *cdata, *temp;
+  size_t              datasize;
+
+  SC_ASSERT (0 <= myrank && myrank < groupsize);
+
+  cdata = (char *) data;
+  datasize = (size_t) count * sc_mpi_sizeof (datatype);
+  pof2 = 1 << SC_LOG2_32 (groupsize);
+  rem = groupsize - pof2;
+  SC_ASSERT (pof2 <= groupsize && groupsize < 2 * pof2);
+
+  temp = (char *) sc_coll_alloc (coll, datasize);
+  newrank = sc_reduce_schedule_fold (coll, cdata, temp, count, datatype,
+                                     rem, myrank, reduce_fn);
+  if (newrank >= 0) {
+    for (mask = 1; mask < pof2; mask *= 2) {
+      i = newrank ^ mask;
+      peer = i < rem ? 2 * i + 1 : i + rem;
+      sc_coll_recv (coll, temp, datasize, peer);
+      sc_coll_send (coll, cdata, datasize, peer);
+      sc_coll_fence (coll);
+      sc_coll_reduce (coll, reduce_fn, temp, cdata, count, datatype);
+    }
+  }
+  sc_reduce_schedule_unfold (coll, cdata, datasize, rem, myrank);
+}
+
+/** Allreduce by Rabenseifner's algorithm for long vectors.
+ * A reduce-scatter by recursive halving leaves each process with the
+ * result for one block of the vector, which is then distributed by an
+ * allgather with recursive doubling.  Each process sends and receives
+ * about twice the vector length in total, independent of the number of
+ * processes.  If this number is not a power of two, the lowest surplus
+ * processes hand their data to a neighbor first and receive the result
+ * last.  The operation must act elementwise.
+ */
+static void
+sc_reduce_schedule_rabenseifner (sc_coll_t * coll, void *data, int count,
+                                 sc_MPI_Datatype datatype, int groupsize,
+                                 int myrank, sc_reduce_t reduce_fn)
+{
+  int                 i, mask;
+  int                 pof2, rem, newrank, peer;
+  int                 lo, hi, mid, plo, phi;
+  int                *displs;
+  char               *cdata, *temp;
+  size_t              typesize, datasize;
+
+  SC_ASSERT (groupsize > 1);
+  SC_ASSERT (0 <= myrank && myrank < groupsize);
+
+  cdata = (char *) data;
+  typesize = sc_mpi_sizeof (datatype);
+  datasize = (size_t) count * typesize;
+  pof2 = 1 << SC_LOG2_32 (groupsize);
+  rem = groupsize - pof2;
+  SC_ASSERT (pof2 <= groupsize && groupsize < 2 * pof2);
+
+  temp = (char *) sc_coll_alloc (coll, datasize);
+  newrank = sc_reduce_schedule_fold (coll, cdata, temp, count, datatype,
+                                     rem, myrank, reduce_fn);
+  if (newrank >= 0) {
+    /* split the vector into pof2 nearly equal blocks */
+    displs = SC_ALLOC (int, pof2 + 1);
+    for (i = 0; i <= pof2; ++i) {
+      displs[i] = (int) (((long long) count * i) / pof2);
+    }
+
+    /* reduce-scatter: keep the half of the blocks that contains our own */
+    lo = 0;
+    hi = pof2;
+    for (mask = pof2 / 2; mask > 0; mask /= 2) {
+      i = newrank ^ mask;
+      peer = i < rem ? 2 * i + 1 : i + rem;
+      mid = lo + mask;
+      if (newrank < i) {
+        plo = mid;
+        phi = hi;
+        hi = mid;
+      }
+      else {
+        plo = lo;
+        phi = mid;
+        lo = mid;
+      }
+      sc_coll_recv (coll, temp, (displs[hi] - displs[lo]) * typesize, peer);
+      sc_coll_send (coll, cdata + displs[plo] * typesize,
+                    (displs[phi] - displs[plo]) * typesize, peer);
+      sc_coll_fence (coll);
+      sc_coll_reduce (coll, reduce_fn, temp, cdata + displs[lo] * typesize,
+                      displs[hi] - displs[lo], datatype);
+    }
+    SC_ASSERT (lo == newrank && hi == newrank + 1);
+
+    /* allgather: the blocks owned by us and our peer are adjacent */
+    for (mask = 1; mask < pof2; mask *= 2) {
+      i = newrank ^ mask;
+      peer = i < rem ? 2 * i + 1 : i + rem;
+      if (newrank < i) {
+        plo = hi;
+        phi = hi + mask;
+      }
+      else {
+        plo = lo - mask;
+        phi = lo;
+      }
+      sc_coll_recv (coll, cdata + displs[plo] * typesize,
+                    (displs[phi] - displs[plo]) * typesize, peer);
+      sc_coll_send (coll, cdata + displs[lo] * typesize,
+                    (displs[hi] - displs[lo]) * typesize, peer);
+      sc_coll_fence (coll);
+      lo = SC_MIN (lo, plo);
+      hi = SC_MAX (hi, phi);
+    }
+    SC_ASSERT (lo == 0 && hi == pof2);
+    SC_FREE (displs);
+  }
+  sc_reduce_schedule_unfold (coll, cdata, datasize, rem, myrank);
+}
+
 static void
 sc_reduce_max (void *sendbuf, void *recvbuf,
                int sendcount, sc_MPI_Datatype sendtype)
@@ -228,80 +402,69 @@ sc_reduce_max (void *sendbuf, void *recvbuf,
 
   if (sendtype == sc_MPI_CHAR || sendtype == sc_MPI_BYTE) {
     const char         *s = (char *) sendbuf;
-    char               *r = (char *) recvbuf;
+    char               *_sc_restrict r = (char *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_SHORT) {
     const short        *s = (short *) sendbuf;
-    short              *r = (short *) recvbuf;
+    short              *_sc_restrict r = (short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_SHORT) {
     const unsigned short *s = (unsigned short *) sendbuf;
-    unsigned short     *r = (unsigned short *) recvbuf;
+    unsigned short     *_sc_restrict r = (unsigned short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_INT) {
     const int          *s = (int *) sendbuf;
-    int                *r = (int *) recvbuf;
+    int                *_sc_restrict r = (int *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED) {
     const unsigned     *s = (unsigned *) sendbuf;
-    unsigned           *r = (unsigned *) recvbuf;
+    unsigned           *_sc_restrict r = (unsigned *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG) {
     const long         *s = (long *) sendbuf;
-    long               *r = (long *) recvbuf;
+    long               *_sc_restrict r = (long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_LONG) {
     const unsigned long *s = (unsigned long *) sendbuf;
-    unsigned long      *r = (unsigned long *) recvbuf;
+    unsigned long      *_sc_restrict r = (unsigned long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG_LONG_INT) {
     const long long    *s = (long long *) sendbuf;
-    long long          *r = (long long *) recvbuf;
+    long long          *_sc_restrict r = (long long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_FLOAT) {
     const float        *s = (float *) sendbuf;
-    float              *r = (float *) recvbuf;
+    float              *_sc_restrict r = (float *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_DOUBLE) {
     const double       *s = (double *) sendbuf;
-    double             *r = (double *) recvbuf;
+    double             *_sc_restrict r = (double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG_DOUBLE) {
     const long double  *s = (long double *) sendbuf;
-    long double        *r = (long double *) recvbuf;
+    long double        *_sc_restrict r = (long double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] > r[i])
-        r[i] = s[i];
+      r[i] = s[i] > r[i] ? s[i] : r[i];
   }
   else {
     SC_ABORT ("Unsupported MPI datatype in sc_reduce_max");
@@ -316,80 +479,69 @@ sc_reduce_min (void *sendbuf, void *recvbuf,
 
   if (sendtype == sc_MPI_CHAR || sendtype == sc_MPI_BYTE) {
     const char         *s = (char *) sendbuf;
-    char               *r = (char *) recvbuf;
+    char               *_sc_restrict r = (char *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_SHORT) {
     const short        *s = (short *) sendbuf;
-    short              *r = (short *) recvbuf;
+    short              *_sc_restrict r = (short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_SHORT) {
     const unsigned short *s = (unsigned short *) sendbuf;
-    unsigned short     *r = (unsigned short *) recvbuf;
+    unsigned short     *_sc_restrict r = (unsigned short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_INT) {
     const int          *s = (int *) sendbuf;
-    int                *r = (int *) recvbuf;
+    int                *_sc_restrict r = (int *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED) {
     const unsigned     *s = (unsigned *) sendbuf;
-    unsigned           *r = (unsigned *) recvbuf;
+    unsigned           *_sc_restrict r = (unsigned *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG) {
     const long         *s = (long *) sendbuf;
-    long               *r = (long *) recvbuf;
+    long               *_sc_restrict r = (long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_LONG) {
     const unsigned long *s = (unsigned long *) sendbuf;
-    unsigned long      *r = (unsigned long *) recvbuf;
+    unsigned long      *_sc_restrict r = (unsigned long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG_LONG_INT) {
     const long long    *s = (long long *) sendbuf;
-    long long          *r = (long long *) recvbuf;
+    long long          *_sc_restrict r = (long long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_FLOAT) {
     const float        *s = (float *) sendbuf;
-    float              *r = (float *) recvbuf;
+    float              *_sc_restrict r = (float *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_DOUBLE) {
     const double       *s = (double *) sendbuf;
-    double             *r = (double *) recvbuf;
+    double             *_sc_restrict r = (double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else if (sendtype == sc_MPI_LONG_DOUBLE) {
     const long double  *s = (long double *) sendbuf;
-    long double        *r = (long double *) recvbuf;
+    long double        *_sc_restrict r = (long double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
-      if (s[i] < r[i])
-        r[i] = s[i];
+      r[i] = s[i] < r[i] ? s[i] : r[i];
   }
   else {
     SC_ABORT ("Unsupported MPI datatype in sc_reduce_min");
@@ -404,67 +556,67 @@ sc_reduce_sum (void *sendbuf, void *recvbuf,
 
   if (sendtype == sc_MPI_CHAR || sendtype == sc_MPI_BYTE) {
     const char         *s = (char *) sendbuf;
-    char               *r = (char *) recvbuf;
+    char               *_sc_restrict r = (char *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_SHORT) {
     const short        *s = (short *) sendbuf;
-    short              *r = (short *) recvbuf;
+    short              *_sc_restrict r = (short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_SHORT) {
     const unsigned short *s = (unsigned short *) sendbuf;
-    unsigned short     *r = (unsigned short *) recvbuf;
+    unsigned short     *_sc_restrict r = (unsigned short *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_INT) {
     const int          *s = (int *) sendbuf;
-    int                *r = (int *) recvbuf;
+    int                *_sc_restrict r = (int *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED) {
     const unsigned     *s = (unsigned *) sendbuf;
-    unsigned           *r = (unsigned *) recvbuf;
+    unsigned           *_sc_restrict r = (unsigned *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_LONG) {
     const long         *s = (long *) sendbuf;
-    long               *r = (long *) recvbuf;
+    long               *_sc_restrict r = (long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_UNSIGNED_LONG) {
     const unsigned long *s = (unsigned long *) sendbuf;
-    unsigned long      *r = (unsigned long *) recvbuf;
+    unsigned long      *_sc_restrict r = (unsigned long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_LONG_LONG_INT) {
     const long long    *s = (long long *) sendbuf;
-    long long          *r = (long long *) recvbuf;
+    long long          *_sc_restrict r = (long long *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_FLOAT) {
     const float        *s = (float *) sendbuf;
-    float              *r = (float *) recvbuf;
+    float              *_sc_restrict r = (float *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_DOUBLE) {
     const double       *s = (double *) sendbuf;
-    double             *r = (double *) recvbuf;
+    double             *_sc_restrict r = (double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
   else if (sendtype == sc_MPI_LONG_DOUBLE) {
     const long double  *s = (long double *) sendbuf;
-    long double        *r = (long double *) recvbuf;
+    long double        *_sc_restrict r = (long double *) recvbuf;
     for (i = 0; i < sendcount; ++i)
       r[i] += s[i];
   }
@@ -526,21 +678,50 @@ sc_reduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                                     sendtype, reduce_fn, target, mpicomm);
 }
 
+static              sc_reduce_t
+sc_reduce_operation (sc_MPI_Op operation)
+{
+  if (operation == sc_MPI_MAX)
+    return sc_reduce_max;
+  else if (operation == sc_MPI_MIN)
+    return sc_reduce_min;
+  else if (operation == sc_MPI_SUM)
+    return sc_reduce_sum;
+  else
+    SC_ABORT ("Unsupported operation in sc_allreduce or sc_reduce");
+
+  return NULL;
+}
+
 static int
 sc_reduce_dispatch (void *sendbuf, void *recvbuf, int sendcount,
                     sc_MPI_Datatype sendtype, sc_MPI_Op operation,
                     int target, sc_MPI_Comm mpicomm)
 {
+  int                 mpiret;
+  int                 mpisize, mpirank;
   sc_reduce_t         reduce_fn;
+  sc_coll_t          *coll;
 
-  if (operation == sc_MPI_MAX)
-    reduce_fn = sc_reduce_max;
-  else if (operation == sc_MPI_MIN)
-    reduce_fn = sc_reduce_min;
-  else if (operation == sc_MPI_SUM)
-    reduce_fn = sc_reduce_sum;
-  else
-    SC_ABORT ("Unsupported operation in sc_allreduce or sc_reduce");
+  reduce_fn = sc_reduce_operation (operation);
+
+  if (target == -1 && (size_t) sendcount * sc_mpi_sizeof (sendtype) >=
+      SC_REDUCE_RABENSEIFNER_BYTES) {
+    /* the built-in operations act elementwise on long vectors */
+    mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    if (mpisize > 1) {
+      mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+      SC_CHECK_MPI (mpiret);
+      memcpy (recvbuf, sendbuf,
+              (size_t) sendcount * sc_mpi_sizeof (sendtype));
+      coll = sc_coll_new (mpicomm);
+      sc_reduce_schedule_rabenseifner (coll, recvbuf, sendcount, sendtype,
+                                       mpisize, mpirank, reduce_fn);
+      sc_coll_start (coll);
+      return sc_coll_wait (&coll);
+    }
+  }
 
   return sc_reduce_custom_dispatch (sendbuf, recvbuf, sendcount,
                                     sendtype, reduce_fn, target, mpicomm);
@@ -565,3 +746,85 @@ sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
   return sc_reduce_dispatch (sendbuf, recvbuf, sendcount,
                              sendtype, operation, target, mpicomm);
 }
+
+int
+sc_allreduce_node (void *sendbuf, void *recvbuf, int sendcount,
+                   sc_MPI_Datatype sendtype, sc_MPI_Op operation,
+                   sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 intrarank;
+  char               *nodebuf;
+  sc_MPI_Comm         intranode, internode;
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    return sc_allreduce (sendbuf, recvbuf, sendcount, sendtype,
+                         operation, mpicomm);
+  }
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  if (intrarank == 0) {
+    /* only the node leaders communicate between nodes */
+    nodebuf = SC_ALLOC (char, sendcount * sc_mpi_sizeof (sendtype));
+    sc_reduce (sendbuf, nodebuf, sendcount, sendtype, operation,
+               0, intranode);
+    sc_allreduce (nodebuf, recvbuf, sendcount, sendtype,
+                  operation, internode);
+    SC_FREE (nodebuf);
+  }
+  else {
+    /* the receive buffer is scratch space on the other processes */
+    sc_reduce (sendbuf, recvbuf, sendcount, sendtype, operation,
+               0, intranode);
+  }
+
+  mpiret = sc_MPI_Bcast (recvbuf, sendcount, sendtype, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  return sc_MPI_SUCCESS;
+}
+
+int
+sc_iallreduce (void *sendbuf, void *recvbuf, int sendcount,
+               sc_MPI_Datatype sendtype, sc_MPI_Op operation,
+               sc_MPI_Comm mpicomm, sc_coll_t ** request)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  size_t              datasize;
+  sc_reduce_t         reduce_fn;
+
+  SC_ASSERT (sendcount >= 0);
+  SC_ASSERT (request != NULL);
+
+  reduce_fn = sc_reduce_operation (operation);
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+  /* *INDENT-ON* */
+  memcpy (recvbuf, sendbuf, datasize);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  *request = sc_coll_new (mpicomm);
+  if (mpisize > 1) {
+    if (datasize >= SC_REDUCE_RABENSEIFNER_BYTES) {
+      sc_reduce_schedule_rabenseifner (*request, recvbuf, sendcount,
+                                       sendtype, mpisize, mpirank,
+                                       reduce_fn);
+    }
+    else {
+      sc_reduce_schedule_doubling (*request, recvbuf, sendcount, sendtype,
+                                   mpisize, mpirank, reduce_fn);
+    }
+  }
+  sc_coll_start (*request);
+
+  return sc_MPI_SUCCESS;
+}
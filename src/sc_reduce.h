@@ -24,13 +24,18 @@
 #ifndef SC_REDUCE_H
 #define SC_REDUCE_H
 
-#include <sc.h>
+#include <sc_coll.h>
 
 /* highest level that uses all-to-all instead of recursion */
 #ifndef SC_REDUCE_ALLTOALL_LEVEL
 #define SC_REDUCE_ALLTOALL_LEVEL        3
 #endif
 
+/* smallest message in bytes for which sc_allreduce scatters the vector */
+#ifndef SC_REDUCE_RABENSEIFNER_BYTES
+#define SC_REDUCE_RABENSEIFNER_BYTES    65536
+#endif
+
 SC_EXTERN_C_BEGIN;
 
 typedef void        (*sc_reduce_t) (void *sendbuf, void *recvbuf,
@@ -53,6 +58,8 @@ int                 sc_reduce_custom (void *sendbuf, void *recvbuf,
                                       int target, sc_MPI_Comm mpicomm);
 
 /** Drop-in MPI_Allreduce replacement.
+ * Messages of at least \ref SC_REDUCE_RABENSEIFNER_BYTES are reduced
+ * blockwise by a reduce-scatter followed by an allgather.
  */
 int                 sc_allreduce (void *sendbuf, void *recvbuf, int sendcount,
                                   sc_MPI_Datatype sendtype,
@@ -65,6 +72,33 @@ int                 sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
                                sc_MPI_Datatype sendtype, sc_MPI_Op operation,
                                int target, sc_MPI_Comm mpicomm);
 
+/** Node-aware MPI_Allreduce replacement.
+ * If \ref sc_mpi_comm_attach_node_comms has been called on \b mpicomm,
+ * each node reduces to its first process, only these node leaders
+ * reduce between nodes by \ref sc_allreduce, and the result is broadcast
+ * within each node.  This divides the traffic between nodes by the
+ * processes per node.  Without node communicators we call \ref
+ * sc_allreduce.
+ */
+int                 sc_allreduce_node (void *sendbuf, void *recvbuf,
+                                       int sendcount,
+                                       sc_MPI_Datatype sendtype,
+                                       sc_MPI_Op operation,
+                                       sc_MPI_Comm mpicomm);
+
+/** Nonblocking MPI_Allreduce replacement.
+ * Short messages are reduced by recursive doubling and long ones as in
+ * \ref sc_allreduce.  The send buffer may be reused on return.  The receive
+ * buffer is valid once \b request has been completed by \ref sc_coll_test
+ * or \ref sc_coll_wait.  All processes must start their nonblocking
+ * collectives on a communicator in the same order.
+ * \param [out] request   Handle of the collective in progress.
+ */
+int                 sc_iallreduce (void *sendbuf, void *recvbuf,
+                                   int sendcount, sc_MPI_Datatype sendtype,
+                                   sc_MPI_Op operation, sc_MPI_Comm mpicomm,
+                                   sc_coll_t ** request);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_REDUCE_H */
@@ -141,3 +141,137 @@ sc_bsearch_range (const void *key, const void *base, size_t nmemb,
   SC_ASSERT (compar (ckey, cbase + (guess + 1) * size) < 0);
   return guess;
 }
+
+/* below this many elements the search counts with a vectorizable loop */
+#define SC_SEARCH_LINEAR 16
+
+/** Return the number of entries in a sorted array that are below target.
+ * The bisection has no branch on the data, so the comparison compiles to a
+ * conditional move.  The last few entries are counted in a loop that the
+ * compiler can vectorize, which amounts to a k-ary search step.
+ */
+static inline       size_t
+sc_search_count64 (int64_t target, const int64_t * array, size_t nmemb)
+{
+  const int64_t      *base = array;
+  size_t              half, count, zz;
+
+  while (nmemb > SC_SEARCH_LINEAR) {
+    half = nmemb / 2;
+    base = base[half] < target ? base + half : base;
+    nmemb -= half;
+  }
+  count = 0;
+  for (zz = 0; zz < nmemb; ++zz) {
+    count += base[zz] < target;
+  }
+  return (size_t) (base - array) + count;
+}
+
+ssize_t
+sc_search_lower_bound64_branchless (int64_t target, const int64_t * array,
+                                    size_t nmemb)
+{
+  const size_t        k = sc_search_count64 (target, array, nmemb);
+
+  SC_ASSERT (k <= nmemb);
+  SC_ASSERT (k == nmemb || array[k] >= target);
+  SC_ASSERT (k == 0 || array[k - 1] < target);
+  return k < nmemb ? (ssize_t) k : -1;
+}
+
+void
+sc_search_lower_bound64_many (const int64_t * targets, size_t ntargets,
+                              const int64_t * array, size_t nmemb,
+                              ssize_t * positions)
+{
+  size_t              zt;
+  size_t              lo, hi, step;
+
+  lo = 0;
+  for (zt = 0; zt < ntargets; ++zt) {
+    SC_ASSERT (zt == 0 || targets[zt - 1] <= targets[zt]);
+
+    /* all entries before lo are below the previous and thus this target;
+       gallop forward to bracket the lower bound in [lo, hi] */
+    hi = lo;
+    step = 1;
+    while (hi < nmemb && array[hi] < targets[zt]) {
+      lo = hi + 1;
+      hi += step;
+      step *= 2;
+    }
+    hi = SC_MIN (hi, nmemb);
+    lo += sc_search_count64 (targets[zt], array + lo, hi - lo);
+
+    SC_ASSERT (lo == nmemb || array[lo] >= targets[zt]);
+    SC_ASSERT (lo == 0 || array[lo - 1] < targets[zt]);
+    positions[zt] = lo < nmemb ? (ssize_t) lo : -1;
+  }
+}
+
+/** Store the sorted array into the Eytzinger order by an in-order walk.
+ * \return          The next position in the sorted array.
+ */
+static              size_t
+sc_search_eytzinger_fill (sc_search_eytzinger_t * eyt, const int64_t * array,
+                          size_t pos, size_t k)
+{
+  if (k <= eyt->nmemb) {
+    pos = sc_search_eytzinger_fill (eyt, array, pos, 2 * k);
+    eyt->keys[k] = array[pos];
+    eyt->positions[k] = pos++;
+    pos = sc_search_eytzinger_fill (eyt, array, pos, 2 * k + 1);
+  }
+  return pos;
+}
+
+sc_search_eytzinger_t *
+sc_search_eytzinger_new (const int64_t * array, size_t nmemb)
+{
+  sc_search_eytzinger_t *eyt;
+
+  eyt = SC_ALLOC (sc_search_eytzinger_t, 1);
+  eyt->nmemb = nmemb;
+  eyt->keys = SC_ALLOC (int64_t, nmemb + 1);
+  eyt->positions = SC_ALLOC (size_t, nmemb + 1);
+
+  SC_EXECUTE_ASSERT_TRUE (sc_search_eytzinger_fill (eyt, array, 0, 1)
+                          == nmemb);
+
+  return eyt;
+}
+
+void
+sc_search_eytzinger_destroy (sc_search_eytzinger_t * eyt)
+{
+  SC_FREE (eyt->keys);
+  SC_FREE (eyt->positions);
+  SC_FREE (eyt);
+}
+
+ssize_t
+sc_search_eytzinger_lower_bound (const sc_search_eytzinger_t * eyt,
+                                 int64_t target)
+{
+  const int64_t      *keys = eyt->keys;
+  size_t              k;
+
+  /* descend without branches on the data, fetching four levels ahead */
+  k = 1;
+  while (k <= eyt->nmemb) {
+    SC_PREFETCH (keys + 16 * k);
+    k = 2 * k + (keys[k] < target);
+  }
+
+  /* undo the right turns after the last left turn, which found the bound */
+#if (defined __GNUC__) || (defined __clang__)
+  k >>= __builtin_ctzll (~(unsigned long long) k) + 1;
+#else
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+#endif
+  return k == 0 ? -1 : (ssize_t) eyt->positions[k];
+}
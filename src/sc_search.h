@@ -50,6 +50,77 @@ ssize_t             sc_search_lower_bound64 (int64_t target,
                                              const int64_t * array,
                                              size_t nmemb, size_t guess);
 
+/** Find lowest position k in a sorted array such that array[k] >= target.
+ * This version bisects without branches on the array values, which avoids
+ * branch mispredictions, and counts the last few entries in a loop that the
+ * compiler can vectorize.
+ * \param [in]  target  The target lower bound to search for.
+ * \param [in]  array   The 64bit integer array to search in.
+ * \param [in]  nmemb   The number of int64_t's in the array.
+ * \return  Returns the matching position
+ *          or -1 if array[size-1] < target or if size == 0.
+ */
+ssize_t             sc_search_lower_bound64_branchless (int64_t target,
+                                                        const int64_t *
+                                                        array, size_t nmemb);
+
+/** Find the lower bounds of a batch of targets in one merged pass.
+ * For each targets[i], find the lowest position k in a sorted array such
+ * that array[k] >= targets[i].  The targets must be sorted ascending.
+ * Each search gallops forward from the previous result, so the cost is
+ * O(ntargets * log (nmemb / ntargets)) and the memory is read in order.
+ * \param [in]  targets     Sorted array of ntargets lower bounds.
+ * \param [in]  ntargets    Number of targets.
+ * \param [in]  array       The sorted 64bit integer array to search in.
+ * \param [in]  nmemb       The number of int64_t's in the array.
+ * \param [out] positions   Array of ntargets results, each either the
+ *                          matching position or -1 if no entry is >= the
+ *                          target.
+ */
+void                sc_search_lower_bound64_many (const int64_t * targets,
+                                                  size_t ntargets,
+                                                  const int64_t * array,
+                                                  size_t nmemb,
+                                                  ssize_t * positions);
+
+/** A copy of a sorted array in Eytzinger (breadth first tree) order.
+ * The first levels of the implicit tree share few cache lines, and the
+ * descent can prefetch the nodes several levels ahead.  This is useful to
+ * search the same array very often.
+ */
+typedef struct sc_search_eytzinger
+{
+  size_t              nmemb;            /**< Number of entries. */
+  int64_t            *keys;             /**< Entries 1..nmemb in tree order;
+                                             node k has children 2k, 2k+1. */
+  size_t             *positions;        /**< Sorted position of each key. */
+}
+sc_search_eytzinger_t;
+
+/** Create the Eytzinger layout of a sorted array.
+ * \param [in]  array   The sorted 64bit integer array.  It is copied.
+ * \param [in]  nmemb   The number of int64_t's in the array.
+ * \return              Free with \ref sc_search_eytzinger_destroy.
+ */
+sc_search_eytzinger_t *sc_search_eytzinger_new (const int64_t * array,
+                                                size_t nmemb);
+
+/** Free an Eytzinger layout.
+ * \param [in]  eyt     Created by \ref sc_search_eytzinger_new.
+ */
+void                sc_search_eytzinger_destroy (sc_search_eytzinger_t *
+                                                 eyt);
+
+/** Find lowest position k in the sorted array such that array[k] >= target.
+ * \param [in]  eyt     Created by \ref sc_search_eytzinger_new.
+ * \param [in]  target  The target lower bound to search for.
+ * \return  Returns the matching position in the original sorted array
+ *          or -1 if all entries are less than target or if nmemb == 0.
+ */
+ssize_t             sc_search_eytzinger_lower_bound (const
+                                                     sc_search_eytzinger_t *
+                                                     eyt, int64_t target);
+
 /** Search position k in sorted array with array[k] <= target < array[k + 1].
  * This function is modeled after the libc bsearch function.
  * \param [in]  key     The target to find in the array range.
@@ -300,6 +300,31 @@ sc_shmem_allgather_basic (void *sendbuf, int sendcount,
   SC_CHECK_MPI (mpiret);
 }
 
+static void
+sc_shmem_allgatherv_basic (void *sendbuf, int sendcount,
+                           sc_MPI_Datatype sendtype, void *recvbuf,
+                           int *recvcounts, int *displs,
+                           sc_MPI_Datatype recvtype, sc_MPI_Comm comm,
+                           sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret = sc_MPI_Allgatherv (sendbuf, sendcount,
+                                                  sendtype, recvbuf,
+                                                  recvcounts, displs,
+                                                  recvtype, comm);
+  SC_CHECK_MPI (mpiret);
+}
+
+static void
+sc_shmem_allreduce_basic (void *sendbuf, void *recvbuf, int count,
+                          sc_MPI_Datatype type, sc_MPI_Op op,
+                          sc_MPI_Comm comm,
+                          sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret = sc_MPI_Allreduce (sendbuf, recvbuf, count,
+                                                 type, op, comm);
+  SC_CHECK_MPI (mpiret);
+}
+
 static void
 sc_shmem_prefix_basic (void *sendbuf, void *recvbuf, int count,
                        sc_MPI_Datatype type, sc_MPI_Op op,
@@ -395,6 +420,115 @@ sc_shmem_allgather_common (void *sendbuf, int sendcount,
   sc_shmem_write_end (recvbuf, comm);
 }
 
+static void
+sc_shmem_allgatherv_common (void *sendbuf, int sendcount,
+                            sc_MPI_Datatype sendtype, void *recvbuf,
+                            int *recvcounts, int *displs,
+                            sc_MPI_Datatype recvtype, sc_MPI_Comm comm,
+                            sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  size_t              typesize;
+  int                 mpiret, intrarank, intrasize, noderank, numnodes;
+  int                 i, p, first, total;
+  int                *nodecounts = NULL, *nodedispls = NULL;
+  char               *noderecvchar = NULL, *recvchar;
+
+  typesize = sc_mpi_sizeof (recvtype);
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (internode, &noderank);
+  SC_CHECK_MPI (mpiret);
+
+  /* node root gathers from node */
+  if (!intrarank) {
+    first = noderank * intrasize;
+    nodecounts = SC_ALLOC (int, intrasize);
+    nodedispls = SC_ALLOC (int, intrasize);
+    for (total = i = 0; i < intrasize; ++i) {
+      nodecounts[i] = recvcounts[first + i];
+      nodedispls[i] = total;
+      total += nodecounts[i];
+    }
+    noderecvchar = SC_ALLOC (char, total * typesize);
+  }
+  mpiret =
+    sc_MPI_Gatherv (sendbuf, sendcount, sendtype, noderecvchar, nodecounts,
+                    nodedispls, recvtype, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  /* node root allgathers between nodes */
+  if (sc_shmem_write_start (recvbuf, comm)) {
+    SC_FREE (nodecounts);
+    SC_FREE (nodedispls);
+    mpiret = sc_MPI_Comm_size (internode, &numnodes);
+    SC_CHECK_MPI (mpiret);
+    nodecounts = SC_ALLOC (int, numnodes);
+    nodedispls = SC_ALLOC (int, numnodes + 1);
+    nodedispls[0] = 0;
+    for (p = 0; p < numnodes; ++p) {
+      nodecounts[p] = 0;
+      for (i = 0; i < intrasize; ++i) {
+        nodecounts[p] += recvcounts[p * intrasize + i];
+      }
+      nodedispls[p + 1] = nodedispls[p] + nodecounts[p];
+    }
+    recvchar = SC_ALLOC (char, nodedispls[numnodes] * typesize);
+    mpiret =
+      sc_MPI_Allgatherv (noderecvchar, nodecounts[noderank], recvtype,
+                         recvchar, nodecounts, nodedispls, recvtype,
+                         internode);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (noderecvchar);
+
+    /* move the gathered items to their displacements */
+    for (total = p = 0; p < numnodes * intrasize; ++p) {
+      memcpy ((char *) recvbuf + displs[p] * typesize,
+              recvchar + total * typesize, recvcounts[p] * typesize);
+      total += recvcounts[p];
+    }
+    SC_FREE (recvchar);
+    SC_FREE (nodecounts);
+    SC_FREE (nodedispls);
+  }
+  sc_shmem_write_end (recvbuf, comm);
+}
+
+static void
+sc_shmem_allreduce_common (void *sendbuf, void *recvbuf, int count,
+                           sc_MPI_Datatype type, sc_MPI_Op op,
+                           sc_MPI_Comm comm, sc_MPI_Comm intranode,
+                           sc_MPI_Comm internode)
+{
+  size_t              typesize;
+  int                 mpiret, intrarank;
+  char               *nodereducechar = NULL;
+
+  typesize = sc_mpi_sizeof (type);
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* node root reduces over node */
+  if (!intrarank) {
+    nodereducechar = SC_ALLOC (char, count * typesize);
+  }
+  mpiret =
+    sc_MPI_Reduce (sendbuf, nodereducechar, count, type, op, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  /* node root allreduces between nodes */
+  if (sc_shmem_write_start (recvbuf, comm)) {
+    mpiret =
+      sc_MPI_Allreduce (nodereducechar, recvbuf, count, type, op, internode);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (nodereducechar);
+  }
+  sc_shmem_write_end (recvbuf, comm);
+}
+
 static void
 sc_shmem_prefix_common (void *sendbuf, void *recvbuf, int count,
                         sc_MPI_Datatype type, sc_MPI_Op op,
@@ -878,6 +1012,84 @@ sc_shmem_allgather (void *sendbuf, int sendcount,
   }
 }
 
+void
+sc_shmem_allgatherv (void *sendbuf, int sendcount,
+                     sc_MPI_Datatype sendtype, void *recvbuf,
+                     int *recvcounts, int *displs,
+                     sc_MPI_Datatype recvtype, sc_MPI_Comm comm)
+{
+  sc_shmem_type_t     type;
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL, internode =
+    sc_MPI_COMM_NULL;
+
+  type = sc_shmem_get_type_default (comm);
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    type = SC_SHMEM_BASIC;
+  }
+  switch (type) {
+  case SC_SHMEM_BASIC:
+  case SC_SHMEM_PRESCAN:
+    sc_shmem_allgatherv_basic (sendbuf, sendcount, sendtype, recvbuf,
+                               recvcounts, displs, recvtype, comm,
+                               intranode, internode);
+    break;
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__)
+  case SC_SHMEM_BGQ:
+  case SC_SHMEM_BGQ_PRESCAN:
+#endif
+#if defined(SC_ENABLE_MPIWINSHARED)
+  case SC_SHMEM_WINDOW:
+  case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+    sc_shmem_allgatherv_common (sendbuf, sendcount, sendtype, recvbuf,
+                                recvcounts, displs, recvtype, comm,
+                                intranode, internode);
+    break;
+#endif
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+void
+sc_shmem_allreduce (void *sendbuf, void *recvbuf, int count,
+                    sc_MPI_Datatype dtype, sc_MPI_Op op, sc_MPI_Comm comm)
+{
+  sc_shmem_type_t     type;
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL, internode =
+    sc_MPI_COMM_NULL;
+
+  type = sc_shmem_get_type_default (comm);
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    type = SC_SHMEM_BASIC;
+  }
+  switch (type) {
+  case SC_SHMEM_BASIC:
+  case SC_SHMEM_PRESCAN:
+    sc_shmem_allreduce_basic (sendbuf, recvbuf, count, dtype, op, comm,
+                              intranode, internode);
+    break;
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__)
+  case SC_SHMEM_BGQ:
+  case SC_SHMEM_BGQ_PRESCAN:
+#endif
+#if defined(SC_ENABLE_MPIWINSHARED)
+  case SC_SHMEM_WINDOW:
+  case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+    sc_shmem_allreduce_common (sendbuf, recvbuf, count, dtype, op, comm,
+                               intranode, internode);
+    break;
+#endif
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
 void
 sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
                  sc_MPI_Datatype dtype, sc_MPI_Op op, sc_MPI_Comm comm)
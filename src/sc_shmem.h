@@ -145,6 +145,44 @@ void                sc_shmem_allgather (void *sendbuf, int sendcount,
                                         sc_MPI_Datatype recvtype,
                                         sc_MPI_Comm comm);
 
+/** Fill a shmem array with an allgatherv.
+ *
+ * The ranks on each node must be numbered consecutively, as for the
+ * shared memory types of \ref sc_shmem_allgather.
+ *
+ * \param[in] sendbuf         the source from this process
+ * \param[in] sendcount       the number of items to allgather
+ * \param[in] sendtype        the type of items to allgather
+ * \param[in,out] recvbuf     the destination shmem array
+ * \param[in] recvcounts      the number of items from each process
+ * \param[in] displs          the offset in items of each process's items
+ * \param[in] recvtype        the type of items to allgather
+ * \param[in] comm            the mpi communicator
+ */
+void                sc_shmem_allgatherv (void *sendbuf, int sendcount,
+                                         sc_MPI_Datatype sendtype,
+                                         void *recvbuf, int *recvcounts,
+                                         int *displs,
+                                         sc_MPI_Datatype recvtype,
+                                         sc_MPI_Comm comm);
+
+/** Fill a shmem array with an allreduce.
+ *
+ * With the shared memory types, each node reduces to its root process, only
+ * the roots reduce between nodes, and each root writes the result into the
+ * shared array once for its whole node.
+ *
+ * \param[in] sendbuf         the source from this process
+ * \param[in,out] recvbuf     the destination shmem array
+ * \param[in] count           the number of items to reduce
+ * \param[in] type            the type of items to reduce
+ * \param[in] op              the reduction operation (e.g., sc_MPI_SUM)
+ * \param[in] comm            the mpi communicator
+ */
+void                sc_shmem_allreduce (void *sendbuf, void *recvbuf,
+                                        int count, sc_MPI_Datatype type,
+                                        sc_MPI_Op op, sc_MPI_Comm comm);
+
 /** Fill a shmem array with an allgather of the prefix op over all processes.
  *
  * The return array will be
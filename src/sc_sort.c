@@ -23,6 +23,374 @@
 
 #include <sc_containers.h>
 #include <sc_sort.h>
+#ifdef SC_ENABLE_OPENMP
+#include <omp.h>
+#elif defined SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* below this many elements the local sort does not use threads */
+#define SC_SORT_LOCAL_THREADED_MIN 16384
+
+/* initial run length of the merge sort with a context comparator */
+#define SC_SORT_LOCAL_BLOCK 32
+
+typedef struct sc_sort_local
+{
+  char               *base, *temp;
+  char               *src, *dst;
+  size_t              nmemb, size;
+  size_t              step;
+  size_t             *runs;
+  int                 num_runs, num_tasks;
+  int                 (*compar) (const void *, const void *);
+  sc_sort_compare_ctx_t compar_ctx;     /* if not NULL, used with ctx */
+  void               *ctx;
+  char               *swap;     /* one element of scratch space per task */
+}
+sc_sort_local_t;
+
+typedef void        (*sc_sort_local_task_t) (sc_sort_local_t * sl, int t);
+
+#if !defined SC_ENABLE_OPENMP && defined SC_ENABLE_PTHREAD
+
+typedef struct sc_sort_local_thread
+{
+  sc_sort_local_t    *sl;
+  sc_sort_local_task_t task;
+  int                 t;
+}
+sc_sort_local_thread_t;
+
+static void        *
+sc_sort_local_start (void *v)
+{
+  sc_sort_local_thread_t *th = (sc_sort_local_thread_t *) v;
+
+  th->task (th->sl, th->t);
+  return NULL;
+}
+
+#endif
+
+/** Execute one task per thread and return after all tasks are done. */
+static void
+sc_sort_local_run (sc_sort_local_t * sl, sc_sort_local_task_t task)
+{
+  int                 t;
+#ifdef SC_ENABLE_OPENMP
+  const int           num_tasks = sl->num_tasks;
+
+#pragma omp parallel for num_threads(num_tasks) schedule(static, 1)
+  for (t = 0; t < num_tasks; ++t) {
+    task (sl, t);
+  }
+#elif defined SC_ENABLE_PTHREAD
+  int                 pth;
+  pthread_t          *threads;
+  sc_sort_local_thread_t *th;
+
+  threads = SC_ALLOC (pthread_t, sl->num_tasks);
+  th = SC_ALLOC (sc_sort_local_thread_t, sl->num_tasks);
+  for (t = 1; t < sl->num_tasks; ++t) {
+    th[t].sl = sl;
+    th[t].task = task;
+    th[t].t = t;
+    pth = pthread_create (&threads[t], NULL, sc_sort_local_start, &th[t]);
+    SC_CHECK_ABORT (pth == 0, "sc_sort thread create");
+  }
+  task (sl, 0);
+  for (t = 1; t < sl->num_tasks; ++t) {
+    pth = pthread_join (threads[t], NULL);
+    SC_CHECK_ABORT (pth == 0, "sc_sort thread join");
+  }
+  SC_FREE (threads);
+  SC_FREE (th);
+#else
+  for (t = 0; t < sl->num_tasks; ++t) {
+    task (sl, t);
+  }
+#endif
+}
+
+/** Compare two elements with the comparator of the sort. */
+static inline int
+sc_sort_local_compare (const sc_sort_local_t * sl, const void *a,
+                       const void *b)
+{
+  return sl->compar_ctx != NULL ?
+    sl->compar_ctx (a, b, sl->ctx) : sl->compar (a, b);
+}
+
+/** Boundary of the initial run of a task. */
+static inline       size_t
+sc_sort_local_bound (const sc_sort_local_t * sl, int t)
+{
+  return sl->nmemb * (size_t) t / (size_t) sl->num_tasks;
+}
+
+static void
+sc_sort_local_qsort (sc_sort_local_t * sl, int t)
+{
+  const size_t        lo = sc_sort_local_bound (sl, t);
+  const size_t        hi = sc_sort_local_bound (sl, t + 1);
+
+  qsort (sl->base + lo * sl->size, hi - lo, sl->size, sl->compar);
+}
+
+/** Sort the initial blocks of a task by insertion sort.
+ * This is the leaf of the merge sort used with a context comparator,
+ * since qsort does not pass a context portably.
+ */
+static void
+sc_sort_local_insertion (sc_sort_local_t * sl, int t)
+{
+  const size_t        size = sl->size;
+  const int           r0 = (int) ((size_t) sl->num_runs * t / sl->num_tasks);
+  const int           r1 =
+    (int) ((size_t) sl->num_runs * (t + 1) / sl->num_tasks);
+  int                 r;
+  char               *lo, *hi, *p, *q;
+  char               *swap = sl->swap + t * size;
+
+  for (r = r0; r < r1; ++r) {
+    lo = sl->base + sl->runs[r] * size;
+    hi = sl->base + sl->runs[r + 1] * size;
+    for (p = lo + size; p < hi; p += size) {
+      /* shift the larger elements up; equal ones stay in front */
+      for (q = p; q > lo && sc_sort_local_compare (sl, q - size, p) > 0;
+           q -= size);
+      if (q < p) {
+        memcpy (swap, p, size);
+        memmove (q + size, q, p - q);
+        memcpy (q, swap, size);
+      }
+    }
+  }
+}
+
+/** Find the merge path split of two sorted runs.
+ * \return          The number of elements taken from a among the first
+ *                  d elements of the merged output.
+ */
+static              size_t
+sc_sort_local_split (const sc_sort_local_t * sl, const char *a, size_t na,
+                     const char *b, size_t nb, size_t d)
+{
+  const size_t        size = sl->size;
+  size_t              lo, hi, mid;
+
+  lo = d > nb ? d - nb : 0;
+  hi = SC_MIN (d, na);
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    /* on ties we take from a first, so the merge is stable */
+    if (sc_sort_local_compare (sl, a + mid * size,
+                               b + (d - mid - 1) * size) <= 0) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/** Merge the output range of one task in the current round.
+ * Groups of step runs are merged pairwise from src into dst.
+ * Each task writes an equal share of dst, which may overlap several pairs.
+ */
+static void
+sc_sort_local_merge (sc_sort_local_t * sl, int t)
+{
+  const size_t        size = sl->size;
+  const size_t        o0 = sc_sort_local_bound (sl, t);
+  const size_t        o1 = sc_sort_local_bound (sl, t + 1);
+  int                 i;
+  size_t              p0, pm, p1;
+  size_t              s, e, sa, ea;
+  const char         *a, *b, *aend, *bend;
+  char               *out;
+
+  for (i = 0; i < sl->num_runs; i += 2 * (int) sl->step) {
+    p0 = sl->runs[i];
+    pm = sl->runs[SC_MIN (i + (int) sl->step, sl->num_runs)];
+    p1 = sl->runs[SC_MIN (i + 2 * (int) sl->step, sl->num_runs)];
+    if (p1 <= o0) {
+      continue;
+    }
+    if (p0 >= o1) {
+      break;
+    }
+
+    /* intersect the output range of this pair with that of the task */
+    s = SC_MAX (p0, o0) - p0;
+    e = SC_MIN (p1, o1) - p0;
+    a = sl->src + p0 * size;
+    b = sl->src + pm * size;
+    sa = sc_sort_local_split (sl, a, pm - p0, b, p1 - pm, s);
+    ea = sc_sort_local_split (sl, a, pm - p0, b, p1 - pm, e);
+    aend = a + ea * size;
+    bend = b + (e - ea) * size;
+    a += sa * size;
+    b += (s - sa) * size;
+    out = sl->dst + (p0 + s) * size;
+
+    while (a < aend && b < bend) {
+      if (sc_sort_local_compare (sl, a, b) <= 0) {
+        memcpy (out, a, size);
+        a += size;
+      }
+      else {
+        memcpy (out, b, size);
+        b += size;
+      }
+      out += size;
+    }
+    if (a < aend) {
+      memcpy (out, a, aend - a);
+      out += aend - a;
+    }
+    if (b < bend) {
+      memcpy (out, b, bend - b);
+      out += bend - b;
+    }
+    SC_ASSERT (out == sl->dst + (p0 + e) * size);
+  }
+}
+
+/** Merge the sorted runs of base in log rounds.
+ * On equal elements the merge prefers the lower run, so it is stable.
+ * The members base, temp, nmemb, size, runs, num_runs, num_tasks, compar,
+ * compar_ctx and ctx must be set.  The result is found in base on return.
+ */
+static void
+sc_sort_local_merge_runs (sc_sort_local_t * sl)
+{
+  char               *swap;
+
+  sl->src = sl->base;
+  sl->dst = sl->temp;
+  for (sl->step = 1; sl->step < (size_t) sl->num_runs; sl->step *= 2) {
+    sc_sort_local_run (sl, sc_sort_local_merge);
+    swap = sl->src;
+    sl->src = sl->dst;
+    sl->dst = swap;
+  }
+  if (sl->src != sl->base) {
+    memcpy (sl->base, sl->src, sl->nmemb * sl->size);
+  }
+}
+
+/** Return the number of threads to use by default.
+ * Only OpenMP provides a default; with pthreads, every MPI process would
+ * start one thread per processor of the node, so they are opt-in.
+ */
+static int
+sc_sort_local_threads (void)
+{
+#ifdef SC_ENABLE_OPENMP
+  return omp_get_max_threads ();
+#else
+  return 1;
+#endif
+}
+
+/** Sort with either comparator; exactly one of compar, compar_ctx is set. */
+static void
+sc_sort_local_ext (void *base, size_t nmemb, size_t size,
+                   int (*compar) (const void *, const void *),
+                   sc_sort_compare_ctx_t compar_ctx, void *ctx,
+                   int num_threads)
+{
+  int                 t;
+  sc_sort_local_t     sl;
+
+  SC_ASSERT ((compar == NULL) != (compar_ctx == NULL));
+
+  if (num_threads <= 0) {
+    num_threads = sc_sort_local_threads ();
+  }
+  if (nmemb < SC_SORT_LOCAL_THREADED_MIN) {
+    num_threads = 1;
+  }
+  if (num_threads <= 1 && compar != NULL) {
+    qsort (base, nmemb, size, compar);
+    return;
+  }
+  if (nmemb < 2) {
+    return;
+  }
+
+  sl.base = (char *) base;
+  sl.nmemb = nmemb;
+  sl.size = size;
+  sl.num_tasks = SC_MIN (num_threads, (int) (nmemb / 2));
+  sl.compar = compar;
+  sl.compar_ctx = compar_ctx;
+  sl.ctx = ctx;
+  if (compar != NULL) {
+    /* sort one run per task, then merge pairs of runs in log rounds */
+    sc_sort_local_run (&sl, sc_sort_local_qsort);
+    sl.num_runs = sl.num_tasks;
+    sl.runs = SC_ALLOC (size_t, sl.num_runs + 1);
+    for (t = 0; t <= sl.num_runs; ++t) {
+      sl.runs[t] = sc_sort_local_bound (&sl, t);
+    }
+  }
+  else {
+    /* sort short blocks by insertion, then merge them in log rounds */
+    sl.num_runs =
+      (int) ((nmemb + SC_SORT_LOCAL_BLOCK - 1) / SC_SORT_LOCAL_BLOCK);
+    sl.num_tasks = SC_MIN (sl.num_tasks, sl.num_runs);
+    sl.runs = SC_ALLOC (size_t, sl.num_runs + 1);
+    for (t = 0; t < sl.num_runs; ++t) {
+      sl.runs[t] = (size_t) t * SC_SORT_LOCAL_BLOCK;
+    }
+    sl.runs[sl.num_runs] = nmemb;
+    sl.swap = SC_ALLOC (char, sl.num_tasks * size);
+    sc_sort_local_run (&sl, sc_sort_local_insertion);
+    SC_FREE (sl.swap);
+  }
+  sl.temp = SC_ALLOC (char, nmemb * size);
+  sc_sort_local_merge_runs (&sl);
+  SC_FREE (sl.temp);
+  SC_FREE (sl.runs);
+}
+
+void
+sc_sort_local (void *base, size_t nmemb, size_t size,
+               int (*compar) (const void *, const void *), int num_threads)
+{
+  sc_sort_local_ext (base, nmemb, size, compar, NULL, NULL, num_threads);
+}
+
+void
+sc_sort_local_ctx (void *base, size_t nmemb, size_t size,
+                   sc_sort_compare_ctx_t compar, void *ctx, int num_threads)
+{
+  sc_sort_local_ext (base, nmemb, size, NULL, compar, ctx, num_threads);
+}
+
+/** Reverse the order of an array of elements in place. */
+static void
+sc_sort_reverse (char *base, size_t nmemb, size_t size)
+{
+  char               *lo, *hi, c;
+  size_t              z;
+
+  if (nmemb < 2) {
+    return;
+  }
+  for (lo = base, hi = base + (nmemb - 1) * size; lo < hi;
+       lo += size, hi -= size) {
+    for (z = 0; z < size; ++z) {
+      c = lo[z];
+      lo[z] = hi[z];
+      hi[z] = c;
+    }
+  }
+}
 
 typedef struct sc_psort_peer
 {
@@ -43,15 +411,18 @@ typedef struct sc_psort
   size_t              my_lo, my_hi, my_count;
   size_t             *gmemb;
   char               *my_base;
+  int                 (*compar) (const void *, const void *);
+  sc_sort_compare_ctx_t compar_ctx;     /* if not NULL, used with ctx */
+  void               *ctx;
 }
 sc_psort_t;
 
-/* qsort is not reentrant, so we do the inverse static */
-static int          (*sc_compare) (const void *, const void *);
-static int
-sc_icompare (const void *v1, const void *v2)
+/** Compare two elements with the comparator of the parallel sort. */
+static inline int
+sc_psort_compare (const sc_psort_t * pst, const void *a, const void *b)
 {
-  return sc_compare (v2, v1);
+  return pst->compar_ctx != NULL ?
+    pst->compar_ctx (a, b, pst->ctx) : pst->compar (a, b);
 }
 
 static              size_t
@@ -230,7 +601,7 @@ sc_merge_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
         lo_data = pst->my_base + (lo + offset - pst->my_lo) * size;
         hi_data = pst->my_base + (hi_beg + offset - pst->my_lo) * size;
         for (zz = 0; zz < max_length; ++zz) {
-          if (dir == (sc_compare (lo_data, hi_data) > 0)) {
+          if (dir == (sc_psort_compare (pst, lo_data, hi_data) > 0)) {
             memcpy (temp, lo_data, size);
             memcpy (lo_data, hi_data, size);
             memcpy (hi_data, temp, size);
@@ -285,7 +656,7 @@ sc_merge_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
               lo_data = peer->my_start;
               hi_data = peer->buffer;
               for (zz = 0; zz < peer->length; ++zz) {
-                if (dir == (sc_compare (lo_data, hi_data) > 0)) {
+                if (dir == (sc_psort_compare (pst, lo_data, hi_data) > 0)) {
                   memcpy (lo_data, hi_data, size);
                 }
                 lo_data += size;
@@ -296,7 +667,7 @@ sc_merge_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
               lo_data = peer->buffer;
               hi_data = peer->my_start;
               for (zz = 0; zz < peer->length; ++zz) {
-                if (dir == (sc_compare (lo_data, hi_data) > 0)) {
+                if (dir == (sc_psort_compare (pst, lo_data, hi_data) > 0)) {
                   memcpy (hi_data, lo_data, size);
                 }
                 lo_data += size;
@@ -334,7 +705,7 @@ sc_merge_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
               lo_data = peer->my_start;
               hi_data = peer->buffer;
               for (zz = 0; zz < peer->length; ++zz) {
-                if (dir == (sc_compare (lo_data, hi_data) > 0)) {
+                if (dir == (sc_psort_compare (pst, lo_data, hi_data) > 0)) {
                   memcpy (lo_data, hi_data, size);
                 }
                 lo_data += size;
@@ -345,7 +716,7 @@ sc_merge_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
               lo_data = peer->buffer;
               hi_data = peer->my_start;
               for (zz = 0; zz < peer->length; ++zz) {
-                if (dir == (sc_compare (lo_data, hi_data) > 0)) {
+                if (dir == (sc_psort_compare (pst, lo_data, hi_data) > 0)) {
                   memcpy (hi_data, lo_data, size);
                 }
                 lo_data += size;
@@ -390,8 +761,14 @@ sc_psort_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
 
   if (n > 1 && pst->my_hi > lo && pst->my_lo < hi) {
     if (lo >= pst->my_lo && hi <= pst->my_hi) {
-      qsort (pst->my_base + (lo - pst->my_lo) * pst->size,
-             n, pst->size, dir ? sc_compare : sc_icompare);
+      char               *base = pst->my_base + (lo - pst->my_lo) * pst->size;
+
+      /* sort ascending, which uses threads if possible, and flip if needed */
+      sc_sort_local_ext (base, n, pst->size, pst->compar,
+                         pst->compar_ctx, pst->ctx, 0);
+      if (!dir) {
+        sc_sort_reverse (base, n, pst->size);
+      }
     }
     else {
       const size_t        n2 = n / 2;
@@ -403,9 +780,11 @@ sc_psort_bitonic (sc_psort_t * pst, size_t lo, size_t hi, int dir)
   }
 }
 
-void
-sc_psort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
-          int (*compar) (const void *, const void *))
+/** Sort with either comparator; exactly one of compar, compar_ctx is set. */
+static void
+sc_psort_ext (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
+              int (*compar) (const void *, const void *),
+              sc_sort_compare_ctx_t compar_ctx, void *ctx)
 {
   int                 mpiret;
   int                 num_procs, rank;
@@ -414,8 +793,6 @@ sc_psort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
   size_t             *gmemb;
   sc_psort_t          pst;
 
-  SC_ASSERT (sc_compare == NULL);
-
   /* get basic MPI information */
   mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
   SC_CHECK_MPI (mpiret);
@@ -440,12 +817,428 @@ sc_psort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
   SC_ASSERT (pst.my_lo + pst.my_count == pst.my_hi);
   pst.gmemb = gmemb;
   pst.my_base = (char *) base;
-  sc_compare = compar;
+  pst.compar = compar;
+  pst.compar_ctx = compar_ctx;
+  pst.ctx = ctx;
   total = gmemb[num_procs];
   SC_GLOBAL_LDEBUGF ("Total values to sort %lld\n", (long long) total);
   sc_psort_bitonic (&pst, 0, total, 1);
 
   /* clean up and free memory */
-  sc_compare = NULL;
   SC_FREE (gmemb);
 }
+
+void
+sc_psort (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
+          int (*compar) (const void *, const void *))
+{
+  sc_psort_ext (mpicomm, base, nmemb, size, compar, NULL, NULL);
+}
+
+void
+sc_psort_ctx (sc_MPI_Comm mpicomm, void *base, size_t * nmemb, size_t size,
+              sc_sort_compare_ctx_t compar, void *ctx)
+{
+  sc_psort_ext (mpicomm, base, nmemb, size, NULL, compar, ctx);
+}
+
+/* samples drawn per process for the splitters of sc_psort_sample */
+#define SC_PSORT_OVERSAMPLE 32
+
+/** Count the sorted local elements below a sample.
+ * Elements are ordered by value and then by global index, which makes
+ * all elements distinct and balances the buckets for duplicate values.
+ */
+static              size_t
+sc_psort_sample_rank (const char *base, size_t count, size_t size,
+                      size_t my_lo, const char *sample, size_t gidx,
+                      int (*compar) (const void *, const void *))
+{
+  int                 c;
+  size_t              lo, hi, mid;
+
+  lo = 0;
+  hi = count;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    c = compar (base + mid * size, sample);
+    if (c < 0 || (c == 0 && my_lo + mid < gidx)) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void
+sc_psort_sample (sc_MPI_Comm mpicomm, void *base, size_t * nmemb,
+                 size_t size, int (*compar) (const void *, const void *))
+{
+  int                 mpiret;
+  int                 num_procs, rank;
+  int                 q, num_requests;
+  int                *scounts, *sdispls, *rcounts, *rdispls;
+  int                 isizet;
+  size_t              total, stride, rsize, msamp, idx, gidx;
+  size_t              my_lo, my_count, rcount;
+  size_t              zz, lo, hi;
+  size_t             *gmemb, *cmemb, *splits;
+  char               *my_base = (char *) base;
+  char               *samples, *lsamples, *sample, *recv;
+  sc_sort_local_t     sl;
+  sc_MPI_Request     *requests;
+
+  /* get basic MPI information */
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* alloc global offset array */
+  gmemb = SC_ALLOC (size_t, num_procs + 1);
+  gmemb[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    gmemb[q + 1] = gmemb[q] + nmemb[q];
+  }
+  total = gmemb[num_procs];
+  my_lo = gmemb[rank];
+  my_count = nmemb[rank];
+  SC_GLOBAL_LDEBUGF ("Total values to sample sort %lld\n", (long long) total);
+
+  /* sort locally, which is all there is to do on one process */
+  sc_sort_local (my_base, my_count, size, compar, 0);
+  if (num_procs == 1 || total == 0) {
+    SC_FREE (gmemb);
+    return;
+  }
+
+  /* draw samples at a fixed global stride so each represents equal counts;
+     a sample record holds the value followed by its global index */
+  stride = SC_MAX (1, total / ((size_t) num_procs * SC_PSORT_OVERSAMPLE));
+  rsize = (size + sizeof (size_t) + 15) & ~(size_t) 15;
+  msamp = (total + stride - 1) / stride;
+  samples = SC_ALLOC (char, msamp * rsize);
+  rcounts = SC_ALLOC (int, num_procs);
+  rdispls = SC_ALLOC (int, num_procs + 1);
+  sl.runs = SC_ALLOC (size_t, num_procs + 1);
+  for (q = 0; q <= num_procs; ++q) {
+    sl.runs[q] = (gmemb[q] + stride - 1) / stride;
+    rdispls[q] = (int) (sl.runs[q] * rsize);
+    if (q > 0) {
+      rcounts[q - 1] = rdispls[q] - rdispls[q - 1];
+    }
+  }
+  SC_ASSERT (sl.runs[num_procs] == msamp);
+  lsamples = SC_ALLOC (char, rcounts[rank]);
+  for (zz = sl.runs[rank]; zz < sl.runs[rank + 1]; ++zz) {
+    gidx = zz * stride;
+    SC_ASSERT (my_lo <= gidx && gidx < my_lo + my_count);
+    sample = lsamples + (zz - sl.runs[rank]) * rsize;
+    memcpy (sample, my_base + (gidx - my_lo) * size, size);
+    memcpy (sample + rsize - sizeof (size_t), &gidx, sizeof (size_t));
+  }
+  mpiret = sc_MPI_Allgatherv (lsamples, rcounts[rank], sc_MPI_BYTE,
+                              samples, rcounts, rdispls, sc_MPI_BYTE,
+                              mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (lsamples);
+
+  /* the samples of every process are sorted and ties are ordered by
+     process, so merging the runs sorts by value and global index */
+  sl.base = samples;
+  sl.temp = SC_ALLOC (char, msamp * rsize);
+  sl.nmemb = msamp;
+  sl.size = rsize;
+  sl.num_runs = num_procs;
+  sl.num_tasks = 1;
+  sl.compar = compar;
+  sl.compar_ctx = NULL;
+  sl.ctx = NULL;
+  sc_sort_local_merge_runs (&sl);
+  SC_FREE (sl.temp);
+
+  /* choose the splitters at the target partition boundaries */
+  splits = SC_ALLOC (size_t, num_procs + 1);
+  splits[0] = 0;
+  for (q = 1; q < num_procs; ++q) {
+    idx = (gmemb[q] + stride / 2) / stride;
+    if (idx >= msamp) {
+      splits[q] = my_count;
+    }
+    else {
+      memcpy (&gidx, samples + (idx + 1) * rsize - sizeof (size_t),
+              sizeof (size_t));
+      splits[q] = sc_psort_sample_rank (my_base, my_count, size, my_lo,
+                                        samples + idx * rsize, gidx,
+                                        compar);
+    }
+    SC_ASSERT (splits[q - 1] <= splits[q]);
+  }
+  splits[num_procs] = my_count;
+  SC_FREE (samples);
+
+  /* move every element to its bucket with a single all-to-all */
+  scounts = SC_ALLOC (int, num_procs);
+  sdispls = SC_ALLOC (int, num_procs);
+  for (q = 0; q < num_procs; ++q) {
+    scounts[q] = (int) ((splits[q + 1] - splits[q]) * size);
+    sdispls[q] = (int) (splits[q] * size);
+  }
+  mpiret = sc_MPI_Alltoall (scounts, 1, sc_MPI_INT,
+                            rcounts, 1, sc_MPI_INT, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  rdispls[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    rdispls[q + 1] = rdispls[q] + rcounts[q];
+  }
+  rcount = (size_t) rdispls[num_procs] / size;
+  recv = SC_ALLOC (char, rcount * size);
+  mpiret = sc_MPI_Alltoallv (my_base, scounts, sdispls, sc_MPI_BYTE,
+                             recv, rcounts, rdispls, sc_MPI_BYTE, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (scounts);
+  SC_FREE (sdispls);
+  SC_FREE (splits);
+
+  /* merge the sorted runs received from all processes */
+  sl.base = recv;
+  sl.temp = SC_ALLOC (char, rcount * size);
+  sl.nmemb = rcount;
+  sl.size = size;
+  for (q = 0; q <= num_procs; ++q) {
+    sl.runs[q] = (size_t) rdispls[q] / size;
+  }
+  sl.num_runs = num_procs;
+  sl.num_tasks = rcount < SC_SORT_LOCAL_THREADED_MIN ? 1 :
+    SC_MIN (sc_sort_local_threads (), (int) (rcount / 2));
+  sc_sort_local_merge_runs (&sl);
+  SC_FREE (sl.temp);
+  SC_FREE (sl.runs);
+  SC_FREE (rcounts);
+  SC_FREE (rdispls);
+
+  /* shift the sorted elements to the requested partition */
+  cmemb = SC_ALLOC (size_t, num_procs + 1);
+  isizet = (int) sizeof (size_t);
+  mpiret = sc_MPI_Allgather (&rcount, isizet, sc_MPI_BYTE,
+                             cmemb + 1, isizet, sc_MPI_BYTE, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  cmemb[0] = 0;
+  for (q = 0; q < num_procs; ++q) {
+    cmemb[q + 1] += cmemb[q];
+  }
+  SC_ASSERT (cmemb[num_procs] == total);
+  requests = SC_ALLOC (sc_MPI_Request, 2 * num_procs);
+  num_requests = 0;
+  for (q = 0; q < num_procs; ++q) {
+    /* receive what q has merged and this process owns */
+    lo = SC_MAX (gmemb[rank], cmemb[q]);
+    hi = SC_MIN (gmemb[rank + 1], cmemb[q + 1]);
+    if (q != rank && lo < hi) {
+      mpiret = sc_MPI_Irecv (my_base + (lo - my_lo) * size,
+                             (int) ((hi - lo) * size), sc_MPI_BYTE, q,
+                             SC_TAG_PSORT_SAMPLE, mpicomm,
+                             requests + num_requests++);
+      SC_CHECK_MPI (mpiret);
+    }
+
+    /* send what this process has merged and q owns */
+    lo = SC_MAX (cmemb[rank], gmemb[q]);
+    hi = SC_MIN (cmemb[rank + 1], gmemb[q + 1]);
+    if (lo < hi) {
+      if (q == rank) {
+        memcpy (my_base + (lo - my_lo) * size,
+                recv + (lo - cmemb[rank]) * size, (hi - lo) * size);
+      }
+      else {
+        mpiret = sc_MPI_Isend (recv + (lo - cmemb[rank]) * size,
+                               (int) ((hi - lo) * size), sc_MPI_BYTE, q,
+                               SC_TAG_PSORT_SAMPLE, mpicomm,
+                               requests + num_requests++);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+  }
+  mpiret = sc_MPI_Waitall (num_requests, requests, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* clean up and free memory */
+  SC_FREE (requests);
+  SC_FREE (recv);
+  SC_FREE (cmemb);
+  SC_FREE (gmemb);
+}
+
+sc_psort_perm_t    *
+sc_psort_perm_new (sc_MPI_Comm mpicomm, const void *base, size_t * nmemb,
+                   size_t size, size_t key_offset, size_t key_size,
+                   int (*compar) (const void *, const void *))
+{
+  int                 mpiret;
+  int                 q;
+  int                *ocounts, *odispls, *icounts, *idispls;
+  size_t              index_offset, tsize;
+  size_t              zz, my_lo, count, gidx, origin[2];
+  size_t             *gmemb, *pairs, *rpairs, *pos;
+  char               *tuples, *tuple;
+  sc_psort_perm_t    *perm;
+
+  SC_ASSERT (key_size > 0 && key_offset + key_size <= size);
+
+  perm = SC_ALLOC (sc_psort_perm_t, 1);
+  perm->mpicomm = mpicomm;
+  mpiret = sc_MPI_Comm_size (mpicomm, &perm->num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &perm->rank);
+  SC_CHECK_MPI (mpiret);
+  perm->count = count = nmemb[perm->rank];
+
+  gmemb = SC_ALLOC (size_t, perm->num_procs + 1);
+  gmemb[0] = 0;
+  for (q = 0; q < perm->num_procs; ++q) {
+    gmemb[q + 1] = gmemb[q] + nmemb[q];
+  }
+  my_lo = gmemb[perm->rank];
+
+  /* a tuple holds the key followed by the origin rank and index */
+  index_offset = (key_size + sizeof (size_t) - 1) & ~(sizeof (size_t) - 1);
+  tsize = index_offset + 2 * sizeof (size_t);
+  tuples = SC_ALLOC (char, count * tsize);
+  origin[0] = (size_t) perm->rank;
+  for (zz = 0; zz < count; ++zz) {
+    tuple = tuples + zz * tsize;
+    origin[1] = zz;
+    memcpy (tuple, (const char *) base + zz * size + key_offset, key_size);
+    memcpy (tuple + index_offset, origin, 2 * sizeof (size_t));
+  }
+  sc_psort_sample (mpicomm, tuples, nmemb, tsize, compar);
+
+  /* record the origin of every sorted slot */
+  perm->origin = SC_ALLOC (int, count);
+  perm->recv_counts = SC_ALLOC_ZERO (int, perm->num_procs);
+  for (zz = 0; zz < count; ++zz) {
+    memcpy (origin, tuples + zz * tsize + index_offset,
+            2 * sizeof (size_t));
+    perm->origin[zz] = (int) origin[0];
+    ++perm->recv_counts[origin[0]];
+  }
+
+  /* tell each origin the global position of its elements, in slot order */
+  pos = SC_ALLOC (size_t, perm->num_procs);
+  for (q = 0, zz = 0; q < perm->num_procs; ++q) {
+    pos[q] = zz;
+    zz += (size_t) perm->recv_counts[q];
+  }
+  pairs = SC_ALLOC (size_t, 2 * count);
+  for (zz = 0; zz < count; ++zz) {
+    memcpy (origin, tuples + zz * tsize + index_offset,
+            2 * sizeof (size_t));
+    gidx = my_lo + zz;
+    pairs[2 * pos[origin[0]]] = origin[1];
+    pairs[2 * pos[origin[0]]++ + 1] = gidx;
+  }
+  SC_FREE (pos);
+  SC_FREE (tuples);
+
+  perm->send_counts = SC_ALLOC (int, perm->num_procs);
+  mpiret = sc_MPI_Alltoall (perm->recv_counts, 1, sc_MPI_INT,
+                            perm->send_counts, 1, sc_MPI_INT, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  ocounts = SC_ALLOC (int, perm->num_procs);
+  odispls = SC_ALLOC (int, perm->num_procs);
+  icounts = SC_ALLOC (int, perm->num_procs);
+  idispls = SC_ALLOC (int, perm->num_procs);
+  for (q = 0; q < perm->num_procs; ++q) {
+    ocounts[q] = perm->recv_counts[q] * 2 * (int) sizeof (size_t);
+    odispls[q] = q == 0 ? 0 : odispls[q - 1] + ocounts[q - 1];
+    icounts[q] = perm->send_counts[q] * 2 * (int) sizeof (size_t);
+    idispls[q] = q == 0 ? 0 : idispls[q - 1] + icounts[q - 1];
+  }
+  rpairs = SC_ALLOC (size_t, 2 * count);
+  mpiret = sc_MPI_Alltoallv (pairs, ocounts, odispls, sc_MPI_BYTE,
+                             rpairs, icounts, idispls, sc_MPI_BYTE, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* the position of an element in the received pairs is its send position:
+     grouped by destination rank and ascending in the global order */
+  perm->newindices = SC_ALLOC (size_t, count);
+  for (zz = 0; zz < count; ++zz) {
+    SC_ASSERT (rpairs[2 * zz] < count);
+    perm->newindices[rpairs[2 * zz]] = zz;
+  }
+
+  SC_FREE (rpairs);
+  SC_FREE (pairs);
+  SC_FREE (ocounts);
+  SC_FREE (odispls);
+  SC_FREE (icounts);
+  SC_FREE (idispls);
+  SC_FREE (gmemb);
+
+  return perm;
+}
+
+void
+sc_psort_perm_apply (sc_psort_perm_t * perm, void *base, size_t size)
+{
+  int                 mpiret;
+  int                 q;
+  int                *scounts, *sdispls, *rcounts, *rdispls;
+  size_t              zz;
+  size_t             *pos;
+  char               *recv;
+  sc_array_t         *data, *newindices;
+
+  /* order the local elements by destination */
+  data = sc_array_new_data (base, size, perm->count);
+  newindices = sc_array_new_data (perm->newindices, sizeof (size_t),
+                                  perm->count);
+  sc_array_permute (data, newindices, 1);
+  sc_array_destroy (data);
+  sc_array_destroy (newindices);
+
+  /* move every element to its destination with a single all-to-all */
+  scounts = SC_ALLOC (int, perm->num_procs);
+  sdispls = SC_ALLOC (int, perm->num_procs);
+  rcounts = SC_ALLOC (int, perm->num_procs);
+  rdispls = SC_ALLOC (int, perm->num_procs);
+  pos = SC_ALLOC (size_t, perm->num_procs);
+  for (q = 0; q < perm->num_procs; ++q) {
+    scounts[q] = perm->send_counts[q] * (int) size;
+    sdispls[q] = q == 0 ? 0 : sdispls[q - 1] + scounts[q - 1];
+    rcounts[q] = perm->recv_counts[q] * (int) size;
+    rdispls[q] = q == 0 ? 0 : rdispls[q - 1] + rcounts[q - 1];
+    pos[q] = (size_t) rdispls[q];
+  }
+  recv = SC_ALLOC (char, perm->count * size);
+  mpiret = sc_MPI_Alltoallv (base, scounts, sdispls, sc_MPI_BYTE,
+                             recv, rcounts, rdispls, sc_MPI_BYTE,
+                             perm->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* every origin sends its elements in the order of the slots */
+  for (zz = 0; zz < perm->count; ++zz) {
+    q = perm->origin[zz];
+    memcpy ((char *) base + zz * size, recv + pos[q], size);
+    pos[q] += size;
+  }
+
+  SC_FREE (recv);
+  SC_FREE (pos);
+  SC_FREE (scounts);
+  SC_FREE (sdispls);
+  SC_FREE (rcounts);
+  SC_FREE (rdispls);
+}
+
+void
+sc_psort_perm_destroy (sc_psort_perm_t * perm)
+{
+  SC_FREE (perm->newindices);
+  SC_FREE (perm->send_counts);
+  SC_FREE (perm->recv_counts);
+  SC_FREE (perm->origin);
+  SC_FREE (perm);
+}
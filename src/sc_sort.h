@@ -28,19 +28,163 @@
 
 SC_EXTERN_C_BEGIN;
 
+/** A comparison function that receives a user context.
+ * \param [in] a, b             The elements to compare.
+ * \param [in] ctx              The context passed to the sort.
+ * \return                      Negative, zero or positive as with qsort.
+ */
+typedef int         (*sc_sort_compare_ctx_t) (const void *a, const void *b,
+                                              void *ctx);
+
+/** Sort a local array, using multiple threads if available.
+ * The array is split into one run per thread that is sorted by qsort.
+ * The runs are merged pairwise in parallel, where every thread works on
+ * an equal share of the output found by binary search (merge path).
+ * Threads are OpenMP if configured, otherwise pthreads if configured.
+ * Small arrays or one thread fall back to a plain call to qsort.
+ * \param [in,out] base         Pointer to the array to sort.
+ * \param [in] nmemb            Number of elements in the array.
+ * \param [in] size             Size in bytes of each element.
+ * \param [in] compar           Comparison function to use.
+ *                              Must be safe to call from several threads.
+ * \param [in] num_threads      Number of threads to use.  If <= 0, use
+ *                              omp_get_max_threads () with OpenMP and
+ *                              1 otherwise; pthreads are only started if
+ *                              their number is given explicitly.
+ */
+void                sc_sort_local (void *base, size_t nmemb, size_t size,
+                                   int (*compar) (const void *,
+                                                  const void *),
+                                   int num_threads);
+
+/** Sort a local array with a comparison function that takes a context.
+ * Since qsort does not pass a context portably, this is a merge sort over
+ * short runs sorted by insertion; it is stable.  Threads are used as in
+ * \ref sc_sort_local.
+ * \param [in,out] base         Pointer to the array to sort.
+ * \param [in] nmemb            Number of elements in the array.
+ * \param [in] size             Size in bytes of each element.
+ * \param [in] compar           Comparison function to use.
+ *                              Must be safe to call from several threads.
+ * \param [in] ctx              Passed through to every call of compar.
+ * \param [in] num_threads      Number of threads as in sc_sort_local.
+ */
+void                sc_sort_local_ctx (void *base, size_t nmemb,
+                                       size_t size,
+                                       sc_sort_compare_ctx_t compar,
+                                       void *ctx, int num_threads);
+
 /** Sort a distributed set of values in parallel.
- * This algorithm uses bitonic sort between processors and qsort locally.
+ * This algorithm uses bitonic sort between processors and sc_sort_local
+ * with the default number of threads within each processor.
  * The partition of the data can be arbitrary and is not changed.
+ * This function is reentrant: it keeps no static state.
  * \param [in] mpicomm          Communicator to use.
  * \param [in] base             Pointer to the local subset of data.
  * \param [in] nmemb            Array of mpisize counts of local data.
  * \param [in] size             Size in bytes of each data value.
  * \param [in] compar           Comparison function to use.
+ *                              Must be safe to call from several threads.
  */
 void                sc_psort (sc_MPI_Comm mpicomm, void *base,
                               size_t * nmemb, size_t size,
                               int (*compar) (const void *, const void *));
 
+/** Sort a distributed set of values in parallel with a context.
+ * This is \ref sc_psort with a comparison function that takes a context,
+ * using \ref sc_sort_local_ctx within each processor.
+ * \param [in] mpicomm          Communicator to use.
+ * \param [in] base             Pointer to the local subset of data.
+ * \param [in] nmemb            Array of mpisize counts of local data.
+ * \param [in] size             Size in bytes of each data value.
+ * \param [in] compar           Comparison function to use.
+ *                              Must be safe to call from several threads.
+ * \param [in] ctx              Passed through to every call of compar.
+ */
+void                sc_psort_ctx (sc_MPI_Comm mpicomm, void *base,
+                                  size_t * nmemb, size_t size,
+                                  sc_sort_compare_ctx_t compar, void *ctx);
+
+/** Sort a distributed set of values in parallel by sample sort.
+ * The values are sorted locally, and splitters are chosen from a regular
+ * sample at the boundaries of the requested partition.  Each value is moved
+ * to its destination by a single all-to-all exchange, and the sorted runs
+ * received are merged.  A final shift between neighboring processes
+ * restores the partition given by nmemb, which is not changed.
+ * Equal values are ordered by their position after the local sort, so
+ * many duplicates do not unbalance the exchange.
+ * Compared to sc_psort, each value is communicated about twice instead of
+ * O(log^2 P) times, which is faster for large process counts.
+ * \param [in] mpicomm          Communicator to use.
+ * \param [in] base             Pointer to the local subset of data.
+ * \param [in] nmemb            Array of mpisize counts of local data.
+ * \param [in] size             Size in bytes of each data value.
+ * \param [in] compar           Comparison function to use.
+ *                              Must be safe to call from several threads.
+ */
+void                sc_psort_sample (sc_MPI_Comm mpicomm, void *base,
+                                     size_t * nmemb, size_t size,
+                                     int (*compar) (const void *,
+                                                    const void *));
+
+/** A global sort order of distributed records, computed from their keys.
+ * Only the keys are sorted, so large records are moved just once.
+ */
+typedef struct sc_psort_perm
+{
+  sc_MPI_Comm         mpicomm;          /**< Communicator of the sort. */
+  int                 num_procs, rank;  /**< Size and rank of mpicomm. */
+  size_t              count;            /**< Number of local records. */
+  size_t             *newindices;       /**< Local send position of every
+                                             record (see sc_array_permute). */
+  int                *send_counts;      /**< Records sent to each rank. */
+  int                *recv_counts;      /**< Records received from each. */
+  int                *origin;           /**< Origin rank of every record in
+                                             the local part of the output. */
+}
+sc_psort_perm_t;
+
+/** Compute the sort order of distributed records from their keys only.
+ * The tuples (key, origin rank, origin index) are sorted by
+ * \ref sc_psort_sample, and every origin learns where its records go.
+ * The records themselves are not changed; use \ref sc_psort_perm_apply.
+ * Records with equal keys are not guaranteed to keep their order.
+ * \param [in] mpicomm          Communicator to use.
+ * \param [in] base             Pointer to the local records.
+ * \param [in] nmemb            Array of mpisize counts of local records.
+ *                              The partition is the same after the sort.
+ * \param [in] size             Size in bytes of each record.
+ * \param [in] key_offset       Byte offset of the key in a record.
+ * \param [in] key_size         Size in bytes of the key.
+ * \param [in] compar           Comparison function for two keys.  The keys
+ *                              are copied to storage aligned to size_t.
+ *                              Must be safe to call from several threads.
+ * \return                      The permutation; free with
+ *                              \ref sc_psort_perm_destroy.
+ */
+sc_psort_perm_t    *sc_psort_perm_new (sc_MPI_Comm mpicomm, const void *base,
+                                       size_t * nmemb, size_t size,
+                                       size_t key_offset, size_t key_size,
+                                       int (*compar) (const void *,
+                                                      const void *));
+
+/** Move distributed records into the order of a permutation.
+ * The records are grouped by destination locally with sc_array_permute
+ * and exchanged with a single all-to-all.
+ * The permutation may be applied to several arrays with the same partition,
+ * for example to records and to separately stored fields of them.
+ * \param [in] perm             Permutation from \ref sc_psort_perm_new.
+ * \param [in,out] base         The perm->count local records.
+ * \param [in] size             Size in bytes of each record.
+ */
+void                sc_psort_perm_apply (sc_psort_perm_t * perm,
+                                         void *base, size_t size);
+
+/** Free a permutation.
+ * \param [in] perm             Permutation from \ref sc_psort_perm_new.
+ */
+void                sc_psort_perm_destroy (sc_psort_perm_t * perm);
+
 SC_EXTERN_C_END;
 
 #endif /* SC_SORT_H */
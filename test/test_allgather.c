@@ -23,6 +23,112 @@
 
 #include <sc_allgather.h>
 
+/** Compare sc_allgatherv with MPI and report the timings.
+ * Process p contributes (p * mult) % 7 items, so some send nothing.
+ * With \b gap, the blocks are stored in reverse order with a gap of one.
+ */
+static void
+test_allgatherv (sc_MPI_Comm mpicomm, int mpisize, int mpirank,
+                 int mult, int gap)
+{
+  int                 mpiret;
+  int                 i, j, p, total;
+  int                *counts, *displs;
+  long               *lsend, *expect, *result;
+  double              elapsed_mpi, elapsed_sc;
+
+  counts = SC_ALLOC (int, mpisize);
+  displs = SC_ALLOC (int, mpisize);
+  for (total = p = 0; p < mpisize; ++p) {
+    counts[p] = (p * mult) % 7;
+    total += counts[p] + gap;
+  }
+  for (i = j = 0; j < mpisize; ++j) {
+    p = gap ? mpisize - 1 - j : j;
+    displs[p] = i;
+    i += counts[p] + gap;
+  }
+  lsend = SC_ALLOC (long, counts[mpirank] + 1);
+  for (i = 0; i < counts[mpirank]; ++i) {
+    lsend[i] = (long) mpirank * 1000 + i;
+  }
+  expect = SC_ALLOC (long, total + 1);
+  result = SC_ALLOC (long, total + 1);
+  memset (expect, 0, (total + 1) * sizeof (long));
+  memset (result, 0, (total + 1) * sizeof (long));
+
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_mpi = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Allgatherv (lsend, counts[mpirank], sc_MPI_LONG,
+                              expect, counts, displs, sc_MPI_LONG, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_mpi += sc_MPI_Wtime ();
+
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_sc = -sc_MPI_Wtime ();
+  mpiret = sc_allgatherv (lsend, counts[mpirank], sc_MPI_LONG,
+                          result, counts, displs, sc_MPI_LONG, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_sc += sc_MPI_Wtime ();
+
+  SC_CHECK_ABORT (!memcmp (result, expect, (total + 1) * sizeof (long)),
+                  "Allgatherv mismatch");
+  SC_GLOBAL_STATISTICSF ("   allgatherv %d items gap %d: MPI %g sc %g\n",
+                         total, gap, elapsed_mpi, elapsed_sc);
+
+  SC_FREE (counts);
+  SC_FREE (displs);
+  SC_FREE (lsend);
+  SC_FREE (expect);
+  SC_FREE (result);
+}
+
+/** Compare sc_allgather_node with every possible number of nodes. */
+static void
+test_allgather_node (sc_MPI_Comm mpicomm, int mpisize, int mpirank)
+{
+  int                 mpiret;
+  int                 i, ppn;
+  long               *expect, *result;
+  long                lsend[2];
+  sc_MPI_Comm         nodecomm;
+
+  lsend[0] = (long) mpirank;
+  lsend[1] = (long) (mpisize - mpirank) * 3;
+  expect = SC_ALLOC (long, 2 * mpisize);
+  result = SC_ALLOC (long, 2 * mpisize);
+  mpiret = sc_MPI_Allgather (lsend, 2, sc_MPI_LONG, expect, 2, sc_MPI_LONG,
+                             mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  for (ppn = 1; ppn <= mpisize; ++ppn) {
+    if (mpisize % ppn != 0) {
+      continue;
+    }
+    mpiret = sc_MPI_Comm_dup (mpicomm, &nodecomm);
+    SC_CHECK_MPI (mpiret);
+    sc_mpi_comm_attach_node_comms (nodecomm, ppn);
+
+    memset (result, 0, 2 * mpisize * sizeof (long));
+    mpiret = sc_allgather_node (lsend, 2, sc_MPI_LONG, result, 2,
+                                sc_MPI_LONG, nodecomm);
+    SC_CHECK_MPI (mpiret);
+    for (i = 0; i < 2 * mpisize; ++i) {
+      SC_CHECK_ABORTF (result[i] == expect[i],
+                       "Allgather node mismatch with %d per node", ppn);
+    }
+
+    sc_mpi_comm_detach_node_comms (nodecomm);
+    mpiret = sc_MPI_Comm_free (&nodecomm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  SC_FREE (expect);
+  SC_FREE (result);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -39,6 +145,8 @@ main (int argc, char **argv)
   double             *ddata2;
   double              elapsed_allgather;
   double              elapsed_replacement;
+  double              elapsed_nonblocking;
+  sc_coll_t          *request;
 
   mpiret = sc_MPI_Init (&argc, &argv);
   SC_CHECK_MPI (mpiret);
@@ -114,15 +222,43 @@ main (int argc, char **argv)
   }
   SC_ASSERT (ddata1[mpirank] == dsend); /* exact match wanted */
 
+  SC_GLOBAL_INFO ("Testing nonblocking replacement\n");
+
+  memset (ddata2, 0, mpisize * sizeof (double));
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_nonblocking = -sc_MPI_Wtime ();
+  mpiret = sc_iallgather (&dsend, 1, sc_MPI_DOUBLE, ddata2, 1,
+                          sc_MPI_DOUBLE, mpicomm, &request);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_coll_wait (&request);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_nonblocking += sc_MPI_Wtime ();
+
+  SC_ASSERT (request == NULL);
+  for (i = 0; i < mpisize; ++i) {
+    SC_ASSERT (ddata1[i] == ddata2[i]); /* exact match wanted */
+  }
+
   SC_FREE (ddata1);
   SC_FREE (ddata2);
 
+  SC_GLOBAL_INFO ("Testing allgatherv replacement\n");
+  test_allgatherv (mpicomm, mpisize, mpirank, 3, 0);
+  test_allgatherv (mpicomm, mpisize, mpirank, 5, 1);
+
+  SC_GLOBAL_INFO ("Testing node-aware replacement\n");
+  test_allgather_node (mpicomm, mpisize, mpirank);
+
   SC_GLOBAL_STATISTICSF ("Timings with threshold %d on %d cores\n",
                          SC_AG_ALLTOALL_MAX, mpisize);
   SC_GLOBAL_STATISTICSF ("   alltoall %g\n", elapsed_alltoall);
   SC_GLOBAL_STATISTICSF ("   recursive %g\n", elapsed_recursive);
   SC_GLOBAL_STATISTICSF ("   allgather %g\n", elapsed_allgather);
   SC_GLOBAL_STATISTICSF ("   replacement %g\n", elapsed_replacement);
+  SC_GLOBAL_STATISTICSF ("   nonblocking %g\n", elapsed_nonblocking);
 
   sc_finalize ();
 
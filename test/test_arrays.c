@@ -103,6 +103,158 @@ test_new_data (sc_array_t * a)
   sc_array_destroy (v);
 }
 
+typedef struct test_key_elem
+{
+  int                 index;
+  uint32_t            key32;
+  uint64_t            key64;
+}
+test_key_elem_t;
+
+static int
+test_key64_compare (const void *v1, const void *v2)
+{
+  const test_key_elem_t *e1 = (const test_key_elem_t *) v1;
+  const test_key_elem_t *e2 = (const test_key_elem_t *) v2;
+
+  if (e1->key64 != e2->key64) {
+    return e1->key64 < e2->key64 ? -1 : 1;
+  }
+  return e1->index - e2->index;
+}
+
+static int
+test_key32_compare (const void *v1, const void *v2)
+{
+  const test_key_elem_t *e1 = (const test_key_elem_t *) v1;
+  const test_key_elem_t *e2 = (const test_key_elem_t *) v2;
+
+  if (e1->key32 != e2->key32) {
+    return e1->key32 < e2->key32 ? -1 : 1;
+  }
+  return e1->index - e2->index;
+}
+
+/** Compare the stable radix sorts with qsort that breaks ties by index. */
+static void
+test_sort_key (int N)
+{
+  int                 i;
+  uint64_t            x;
+  double              tqsort, tradix;
+  test_key_elem_t    *e;
+  sc_array_t         *a, *b, *c;
+
+  a = sc_array_new (sizeof (test_key_elem_t));
+  b = sc_array_new (sizeof (test_key_elem_t));
+  c = sc_array_new_count (sizeof (test_key_elem_t), (size_t) N);
+  x = 1;
+  for (i = 0; i < N; ++i) {
+    e = (test_key_elem_t *) sc_array_index_int (c, i);
+    e->index = i;
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    /* many duplicates in the 64-bit key and a constant middle digit */
+    e->key64 = (x >> 52) | ((x >> 20) << 48);
+    e->key32 = (uint32_t) (x >> 32);
+  }
+
+  sc_array_copy (a, c);
+  sc_array_copy (b, c);
+  tqsort = -sc_MPI_Wtime ();
+  sc_array_sort (b, test_key64_compare);
+  tqsort += sc_MPI_Wtime ();
+  tradix = -sc_MPI_Wtime ();
+  sc_array_sort_key64 (a, offsetof (test_key_elem_t, key64));
+  tradix += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Sort key64 failed");
+  SC_GLOBAL_INFOF ("Sort key64 %d qsort %g s radix %g s\n",
+                   N, tqsort, tradix);
+
+  sc_array_copy (a, c);
+  sc_array_copy (b, c);
+  tqsort = -sc_MPI_Wtime ();
+  sc_array_sort (b, test_key32_compare);
+  tqsort += sc_MPI_Wtime ();
+  tradix = -sc_MPI_Wtime ();
+  sc_array_sort_key32 (a, offsetof (test_key_elem_t, key32));
+  tradix += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sc_array_is_equal (a, b), "Sort key32 failed");
+  SC_GLOBAL_INFOF ("Sort key32 %d qsort %g s radix %g s\n",
+                   N, tqsort, tradix);
+
+  sc_array_destroy (a);
+  sc_array_destroy (b);
+  sc_array_destroy (c);
+}
+
+static int
+test_key32_only_compare (const void *v1, const void *v2)
+{
+  const test_key_elem_t *e1 = (const test_key_elem_t *) v1;
+  const test_key_elem_t *e2 = (const test_key_elem_t *) v2;
+
+  return e1->key32 < e2->key32 ? -1 : e1->key32 > e2->key32 ? 1 : 0;
+}
+
+/** Merge sorted runs with duplicate keys, some of them empty. */
+static void
+test_merge_k (int num_runs, int max_count)
+{
+  int                 i, j, count, index;
+  uint64_t            x;
+  double              tsort, tmerge, tthreads;
+  test_key_elem_t    *e;
+  sc_array_t        **runs, *expect, *merged;
+
+  runs = SC_ALLOC (sc_array_t *, num_runs);
+  expect = sc_array_new (sizeof (test_key_elem_t));
+  merged = sc_array_new (sizeof (test_key_elem_t));
+  x = (uint64_t) num_runs;
+  index = 0;
+  for (i = 0; i < num_runs; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    count = i % 5 == 3 ? 0 : (int) ((x >> 33) % (uint64_t) max_count);
+    runs[i] = sc_array_new_count (sizeof (test_key_elem_t), (size_t) count);
+    for (j = 0; j < count; ++j) {
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+      e = (test_key_elem_t *) sc_array_index_int (runs[i], j);
+      e->key32 = (uint32_t) ((x >> 33) % (uint64_t) (max_count + 1));
+      e->key64 = 0;
+    }
+    sc_array_sort (runs[i], test_key32_only_compare);
+    for (j = 0; j < count; ++j) {
+      e = (test_key_elem_t *) sc_array_index_int (runs[i], j);
+      e->index = index++;
+      *(test_key_elem_t *) sc_array_push (expect) = *e;
+    }
+  }
+
+  /* a stable merge orders equal keys by run and then by position */
+  tsort = -sc_MPI_Wtime ();
+  sc_array_sort (expect, test_key32_compare);
+  tsort += sc_MPI_Wtime ();
+  tmerge = -sc_MPI_Wtime ();
+  sc_array_merge_k (merged, runs, (size_t) num_runs,
+                    test_key32_only_compare, 1);
+  tmerge += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sc_array_is_equal (merged, expect), "Merge k failed");
+  tthreads = -sc_MPI_Wtime ();
+  sc_array_merge_k (merged, runs, (size_t) num_runs,
+                    test_key32_only_compare, 0);
+  tthreads += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sc_array_is_equal (merged, expect), "Merge k threads");
+  SC_GLOBAL_INFOF ("Merge %d runs of %lld elements sort %g s merge %g s"
+                   " threaded %g s\n", num_runs, (long long)
+                   expect->elem_count, tsort, tmerge, tthreads);
+
+  for (i = 0; i < num_runs; ++i) {
+    sc_array_destroy (runs[i]);
+  }
+  SC_FREE (runs);
+  sc_array_destroy (expect);
+  sc_array_destroy (merged);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -145,6 +297,12 @@ main (int argc, char **argv)
   test_new_count (a);
   test_new_view (a);
   test_new_data (a);
+  test_sort_key (N);
+  test_sort_key (100000);
+  test_merge_k (0, 1);
+  test_merge_k (1, 10);
+  test_merge_k (7, 10);
+  test_merge_k (16, 20000);
 
   for (i = 0; i < N; ++i) {
     pe = (int *) sc_array_index_int (a, i);
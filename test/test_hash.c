@@ -0,0 +1,602 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_containers.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static unsigned
+test_hash_int (const void *v, const void *u)
+{
+  return (unsigned) *(const int *) v;
+}
+
+static unsigned
+test_hash_constant (const void *v, const void *u)
+{
+  return 17U;
+}
+
+static int
+test_equal_int (const void *v1, const void *v2, const void *u)
+{
+  return *(const int *) v1 == *(const int *) v2;
+}
+
+/** The previous byte-at-a-time string hash, kept for comparison. */
+static unsigned
+test_hash_string_bytewise (const void *s, const void *u)
+{
+  int                 j;
+  unsigned            h;
+  unsigned            a, b, c;
+  const char         *sp = (const char *) s;
+
+  j = 0;
+  h = 0;
+  a = b = c = 0;
+  for (;;) {
+    if (*sp) {
+      h += *sp++;
+    }
+
+    if (++j == 4) {
+      a += h;
+      h = 0;
+    }
+    else if (j == 8) {
+      b += h;
+      h = 0;
+    }
+    else if (j == 12) {
+      c += h;
+      sc_hash_mix (a, b, c);
+      if (!*sp) {
+        sc_hash_final (a, b, c);
+        return c;
+      }
+      j = 0;
+      h = 0;
+    }
+    else {
+      h <<= 8;
+    }
+  }
+}
+
+static int
+test_equal_string (const void *v1, const void *v2, const void *u)
+{
+  return !strcmp ((const char *) v1, (const char *) v2);
+}
+
+static int
+test_hash_count (void **v, const void *u)
+{
+  ++*(size_t *) u;
+  return 1;
+}
+
+static void
+test_hash_pow2 (sc_hash_function_t hash_fn, int N)
+{
+  int                 i, added;
+  int                *data, *other;
+  void              **found;
+  void               *removed;
+  size_t              count;
+  sc_hash_t          *hash;
+
+  data = SC_ALLOC (int, N);
+  other = SC_ALLOC (int, N);
+  for (i = 0; i < N; ++i) {
+    data[i] = other[i] = 5 * i;
+  }
+
+  hash = sc_hash_new_pow2 (hash_fn, test_equal_int, &count, NULL);
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_insert_unique (hash, data + i, &found);
+    SC_CHECK_ABORT (added && *found == data + i, "Pow2 insert");
+  }
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_insert_unique (hash, other + i, &found);
+    SC_CHECK_ABORT (!added && *found == data + i, "Pow2 duplicate");
+  }
+  SC_CHECK_ABORT ((hash->slots->elem_count &
+                   (hash->slots->elem_count - 1)) == 0, "Pow2 slots");
+  count = 0;
+  sc_hash_foreach (hash, test_hash_count);
+  SC_CHECK_ABORT (count == (size_t) N, "Pow2 foreach");
+  sc_hash_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+
+  /* remove most elements to trigger shrinking */
+  for (i = 0; i < N; ++i) {
+    if (i % 16) {
+      SC_CHECK_ABORT (sc_hash_remove (hash, other + i, &removed) &&
+                      removed == data + i, "Pow2 remove");
+    }
+  }
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (sc_hash_lookup (hash, other + i, &found) == !(i % 16),
+                    "Pow2 lookup after remove");
+  }
+  sc_hash_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+
+  sc_hash_destroy (hash);
+  SC_FREE (other);
+  SC_FREE (data);
+}
+
+static void
+test_hash_open (sc_hash_function_t hash_fn, int N)
+{
+  int                 i, added;
+  int                *data, *other;
+  void              **found;
+  void               *removed;
+  size_t              count;
+  sc_hash_t          *chain;
+  sc_hash_open_t     *open;
+
+  data = SC_ALLOC (int, N);
+  other = SC_ALLOC (int, N);
+  for (i = 0; i < N; ++i) {
+    data[i] = other[i] = 3 * i;
+  }
+
+  chain = sc_hash_new (hash_fn, test_equal_int, NULL, NULL);
+  open = sc_hash_open_new (hash_fn, test_equal_int, &count);
+
+  /* insert every element and compare with the chained hash table */
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_open_insert_unique (open, data + i, &found);
+    SC_CHECK_ABORT (added && *found == data + i, "Open insert");
+    added = sc_hash_insert_unique (chain, data + i, NULL);
+    SC_CHECK_ABORT (added, "Chain insert");
+  }
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_open_insert_unique (open, other + i, &found);
+    SC_CHECK_ABORT (!added && *found == data + i, "Open duplicate");
+    SC_CHECK_ABORT (sc_hash_open_lookup (open, other + i, &found) &&
+                    *found == data + i, "Open lookup");
+  }
+  SC_CHECK_ABORT (open->elem_count == chain->elem_count, "Open count");
+  count = 0;
+  sc_hash_open_foreach (open, test_hash_count);
+  SC_CHECK_ABORT (count == (size_t) N, "Open foreach");
+  sc_hash_open_print_statistics (sc_package_id, SC_LP_STATISTICS, open);
+  sc_hash_print_statistics (sc_package_id, SC_LP_STATISTICS, chain);
+  SC_GLOBAL_INFOF ("Hash memory open %llu chained %llu\n",
+                   (unsigned long long) sc_hash_open_memory_used (open),
+                   (unsigned long long) sc_hash_memory_used (chain));
+
+  /* remove every other element and verify the remaining ones */
+  for (i = 0; i < N; i += 2) {
+    SC_CHECK_ABORT (sc_hash_open_remove (open, other + i, &removed) &&
+                    removed == data + i, "Open remove");
+    SC_CHECK_ABORT (!sc_hash_open_remove (open, other + i, NULL),
+                    "Open remove twice");
+  }
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (sc_hash_open_lookup (open, other + i, NULL) == (i % 2),
+                    "Open lookup after remove");
+  }
+  SC_CHECK_ABORT (open->elem_count == (size_t) (N / 2), "Open remove count");
+
+  sc_hash_open_truncate (open);
+  SC_CHECK_ABORT (open->elem_count == 0 &&
+                  !sc_hash_open_lookup (open, other + 1, NULL),
+                  "Open truncate");
+
+  sc_hash_open_destroy (open);
+  sc_hash_destroy (chain);
+  SC_FREE (other);
+  SC_FREE (data);
+}
+
+static void
+test_hash_mt (sc_hash_function_t hash_fn, int N, int num_stripes)
+{
+  int                 i, added;
+  int                *data, *other;
+  void              **found;
+  void               *removed;
+  size_t              count;
+  sc_hash_mt_t       *hash;
+
+  data = SC_ALLOC (int, N);
+  other = SC_ALLOC (int, N);
+  for (i = 0; i < N; ++i) {
+    data[i] = other[i] = 7 * i;
+  }
+
+  hash = sc_hash_mt_new (hash_fn, test_equal_int, &count, num_stripes);
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_mt_insert_unique (hash, data + i, &found);
+    SC_CHECK_ABORT (added && *found == data + i, "Mt insert");
+  }
+  for (i = 0; i < N; ++i) {
+    added = sc_hash_mt_insert_unique (hash, other + i, &found);
+    SC_CHECK_ABORT (!added && *found == data + i, "Mt duplicate");
+  }
+  SC_CHECK_ABORT (sc_hash_mt_count (hash) == (size_t) N, "Mt count");
+  count = 0;
+  sc_hash_mt_foreach (hash, test_hash_count);
+  SC_CHECK_ABORT (count == (size_t) N, "Mt foreach");
+  sc_hash_mt_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+
+  for (i = 0; i < N; i += 3) {
+    SC_CHECK_ABORT (sc_hash_mt_remove (hash, other + i, &removed) &&
+                    removed == data + i, "Mt remove");
+  }
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (sc_hash_mt_lookup (hash, other + i, &found) ==
+                    (i % 3 != 0), "Mt lookup after remove");
+  }
+
+  sc_hash_mt_truncate (hash);
+  SC_CHECK_ABORT (sc_hash_mt_count (hash) == 0 &&
+                  !sc_hash_mt_lookup (hash, other + 1, NULL), "Mt truncate");
+
+  sc_hash_mt_destroy (hash);
+  SC_FREE (other);
+  SC_FREE (data);
+}
+
+static unsigned
+test_hash_coords (const void *v, const void *u)
+{
+  const int          *c = (const int *) v;
+  uint32_t            a, b, d;
+
+  a = (uint32_t) c[0];
+  b = (uint32_t) c[1];
+  d = (uint32_t) c[2];
+  sc_hash_final (a, b, d);
+
+  return (unsigned) d;
+}
+
+static int
+test_equal_coords (const void *v1, const void *v2, const void *u)
+{
+  return !memcmp (v1, v2, 3 * sizeof (int));
+}
+
+/** Report the throughput of the string hash functions and the resulting
+ * chain lengths for N short strings.
+ */
+static void
+test_hash_strings (int N)
+{
+  const int           width = 32;
+  const size_t        blen = 1 << 20;
+  int                 i, k, which, rounds;
+  unsigned            sum;
+  char               *strings, *buffer;
+  size_t              zz, total;
+  double              elapsed;
+  sc_hash_function_t  fn;
+  sc_hash_t          *hash;
+
+  /* the bytes hash must not depend on alignment */
+  buffer = SC_ALLOC (char, blen + 8);
+  for (zz = 0; zz < blen + 8; ++zz) {
+    buffer[zz] = (char) (zz * 131 + 7);
+  }
+  memcpy (buffer + 101, buffer, 100);
+  SC_CHECK_ABORT (sc_hash_function_bytes (buffer, 100) ==
+                  sc_hash_function_bytes (buffer + 101, 100), "Bytes align");
+
+  rounds = 64;
+  sum = 0;
+  elapsed = -sc_MPI_Wtime ();
+  for (k = 0; k < rounds; ++k) {
+    sum += sc_hash_function_bytes (buffer + (k & 7), blen);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_GLOBAL_STATISTICSF ("Hash bytes %g GB/s (%x)\n",
+                         1e-9 * rounds * blen / SC_MAX (elapsed, 1e-9), sum);
+  SC_FREE (buffer);
+
+  /* strings of varying length like identifiers in options and statistics */
+  strings = SC_ALLOC (char, (size_t) N * width);
+  total = 0;
+  for (i = 0; i < N; ++i) {
+    total += (size_t) snprintf (strings + (size_t) i * width, width,
+                                "%.*s_%d", 1 + i % 17,
+                                "node_coordinate_face_id", i);
+  }
+
+  for (which = 0; which < 2; ++which) {
+    fn = which ? sc_hash_function_string : test_hash_string_bytewise;
+
+    sum = 0;
+    elapsed = -sc_MPI_Wtime ();
+    for (i = 0; i < N; ++i) {
+      sum += fn (strings + (size_t) i * width, NULL);
+    }
+    elapsed += sc_MPI_Wtime ();
+    SC_GLOBAL_STATISTICSF ("Hash strings %s %g GB/s (%x)\n",
+                           which ? "wordwise" : "bytewise",
+                           1e-9 * total / SC_MAX (elapsed, 1e-9), sum);
+
+    hash = sc_hash_new (fn, test_equal_string, NULL, NULL);
+    for (i = 0; i < N; ++i) {
+      SC_CHECK_ABORT (sc_hash_insert_unique
+                      (hash, strings + (size_t) i * width, NULL),
+                      "String insert");
+    }
+    sc_hash_print_statistics (sc_package_id, SC_LP_STATISTICS, hash);
+    sc_hash_destroy (hash);
+  }
+
+  SC_FREE (strings);
+}
+
+/** Deduplicate a batch of coordinates with many repetitions, both one at
+ * a time and in bulk, and compare the resulting positions and timings.
+ */
+static void
+test_hash_array_batch (int N)
+{
+  int                 i;
+  int                *c;
+  size_t              zz, position, added;
+  double              elapsed_single, elapsed_batch, elapsed_lookup;
+  sc_array_t         *batch, *positions, *lpositions;
+  sc_hash_array_t    *single, *bulk;
+  void               *v;
+
+  batch = sc_array_new_count (3 * sizeof (int), (size_t) N);
+  for (i = 0; i < N; ++i) {
+    c = (int *) sc_array_index_int (batch, i);
+    c[0] = i % 97;
+    c[1] = (i / 97) % 89;
+    c[2] = (i / (97 * 89)) % 2;
+  }
+  positions = sc_array_new (sizeof (size_t));
+  lpositions = sc_array_new (sizeof (size_t));
+
+  single = sc_hash_array_new (3 * sizeof (int), NULL, NULL, NULL);
+  elapsed_single = -sc_MPI_Wtime ();
+  for (zz = 0; zz < batch->elem_count; ++zz) {
+    v = sc_hash_array_insert_unique (single, sc_array_index (batch, zz),
+                                     &position);
+    if (v != NULL) {
+      memcpy (v, sc_array_index (batch, zz), batch->elem_size);
+    }
+  }
+  elapsed_single += sc_MPI_Wtime ();
+
+  bulk = sc_hash_array_new (3 * sizeof (int), test_hash_coords,
+                            test_equal_coords, NULL);
+  elapsed_batch = -sc_MPI_Wtime ();
+  added = sc_hash_array_insert_batch (bulk, batch, positions);
+  elapsed_batch += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (added == bulk->a.elem_count, "Batch added");
+  SC_CHECK_ABORT (sc_array_is_equal (&single->a, &bulk->a), "Batch array");
+  SC_CHECK_ABORT (sc_hash_array_is_valid (bulk), "Batch valid");
+  SC_CHECK_ABORT (sc_hash_array_insert_batch (bulk, batch, NULL) == 0,
+                  "Batch insert twice");
+
+  elapsed_lookup = -sc_MPI_Wtime ();
+  added = sc_hash_array_lookup_batch (single, batch, lpositions);
+  elapsed_lookup += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (added == batch->elem_count, "Batch lookup");
+  SC_CHECK_ABORT (sc_array_is_equal (positions, lpositions),
+                  "Batch positions");
+
+  c = (int *) sc_array_index (batch, 0);
+  c[0] = -1;
+  (void) sc_hash_array_lookup_batch (bulk, batch, lpositions);
+  SC_CHECK_ABORT (*(size_t *) sc_array_index (lpositions, 0) == (size_t) -1,
+                  "Batch lookup missing");
+
+  SC_GLOBAL_STATISTICSF ("Hash array %llu of %d unique single %g batch %g"
+                         " lookup %g\n",
+                         (unsigned long long) bulk->a.elem_count, N,
+                         elapsed_single, elapsed_batch, elapsed_lookup);
+
+  sc_hash_array_destroy (single);
+  sc_hash_array_destroy (bulk);
+  sc_array_destroy (lpositions);
+  sc_array_destroy (positions);
+  sc_array_destroy (batch);
+}
+
+/** Insert N distinct keys, then look up every key and as many missing ones.
+ * \param [in] which   0 for sc_hash_new, 1 for sc_hash_new_pow2,
+ *                     2 for sc_hash_open_new.
+ */
+static void
+test_hash_timing (int which, int N)
+{
+  int                 i, hits;
+  int                *data;
+  uint32_t            key;
+  double              elapsed_insert, elapsed_lookup;
+  sc_hash_t          *hash = NULL;
+  sc_hash_open_t     *open = NULL;
+  const char         *names[3] = { "modulo", "pow2", "open" };
+
+  /* distinct pseudo-random keys: each step is a bijection of 32 bits */
+  data = SC_ALLOC (int, 2 * N);
+  for (i = 0; i < 2 * N; ++i) {
+    key = (uint32_t) i * 0x9e3779b1U;
+    key ^= key >> 15;
+    key *= 0x2c1b3c6dU;
+    key ^= key >> 12;
+    data[i] = (int) key;
+  }
+
+  if (which == 2) {
+    open = sc_hash_open_new (test_hash_int, test_equal_int, NULL);
+  }
+  else if (which == 1) {
+    hash = sc_hash_new_pow2 (test_hash_int, test_equal_int, NULL, NULL);
+  }
+  else {
+    hash = sc_hash_new (test_hash_int, test_equal_int, NULL, NULL);
+  }
+
+  elapsed_insert = -sc_MPI_Wtime ();
+  for (i = 0; i < N; ++i) {
+    if (open != NULL) {
+      (void) sc_hash_open_insert_unique (open, data + i, NULL);
+    }
+    else {
+      (void) sc_hash_insert_unique (hash, data + i, NULL);
+    }
+  }
+  elapsed_insert += sc_MPI_Wtime ();
+
+  hits = 0;
+  elapsed_lookup = -sc_MPI_Wtime ();
+  for (i = 0; i < 2 * N; ++i) {
+    if (open != NULL) {
+      hits += sc_hash_open_lookup (open, data + i, NULL);
+    }
+    else {
+      hits += sc_hash_lookup (hash, data + i, NULL);
+    }
+  }
+  elapsed_lookup += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (hits == N, "Timing lookup");
+
+  SC_GLOBAL_STATISTICSF ("Hash %s insert %g Mops/s lookup %g Mops/s"
+                         " memory %llu\n", names[which],
+                         1e-6 * N / SC_MAX (elapsed_insert, 1e-9),
+                         2e-6 * N / SC_MAX (elapsed_lookup, 1e-9),
+                         (unsigned long long) (open != NULL ?
+                                               sc_hash_open_memory_used (open)
+                                               : sc_hash_memory_used (hash)));
+
+  if (open != NULL) {
+    sc_hash_open_destroy (open);
+  }
+  else {
+    sc_hash_destroy (hash);
+  }
+  SC_FREE (data);
+}
+
+#ifdef _OPENMP
+
+/** Insert, look up and remove every key from two threads at a time. */
+static void
+test_hash_mt_threads (int N)
+{
+  int                 i;
+  int                *data;
+  long                num_added, num_found, num_removed;
+  double              elapsed;
+  sc_hash_mt_t       *hash;
+
+  data = SC_ALLOC (int, N);
+  for (i = 0; i < N; ++i) {
+    data[i] = i;
+  }
+  hash = sc_hash_mt_new (test_hash_int, test_equal_int, NULL, 0);
+
+  /* each key is inserted twice, usually by different threads */
+  num_added = 0;
+  elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:num_added)
+  for (i = 0; i < 2 * N; ++i) {
+    num_added += sc_hash_mt_insert_unique (hash, data + i % N, NULL);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (num_added == N, "Mt threads insert");
+  SC_CHECK_ABORT (sc_hash_mt_count (hash) == (size_t) N, "Mt threads count");
+
+  num_found = 0;
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:num_found)
+  for (i = 0; i < N; ++i) {
+    num_found += sc_hash_mt_lookup (hash, data + i, NULL);
+  }
+  SC_CHECK_ABORT (num_found == N, "Mt threads lookup");
+
+  /* each even key is removed twice, while odd keys are looked up */
+  num_removed = num_found = 0;
+#pragma omp parallel for schedule(dynamic, 64) \
+  reduction(+:num_removed,num_found)
+  for (i = 0; i < 2 * N; ++i) {
+    if (i % N % 2 == 0) {
+      num_removed += sc_hash_mt_remove (hash, data + i % N, NULL);
+    }
+    else {
+      num_found += sc_hash_mt_lookup (hash, data + i % N, NULL);
+    }
+  }
+  SC_CHECK_ABORT (num_removed == (N + 1) / 2, "Mt threads remove");
+  SC_CHECK_ABORT (num_found == 2 * (N / 2), "Mt threads lookup odd");
+  SC_CHECK_ABORT (sc_hash_mt_count (hash) == (size_t) (N / 2),
+                  "Mt threads final count");
+  SC_GLOBAL_INFOF ("Hash mt threads %d %g Mops/s insert\n",
+                   omp_get_max_threads (), 2e-6 * N / elapsed);
+
+  sc_hash_mt_destroy (hash);
+  SC_FREE (data);
+}
+
+#endif
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 which, N;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_hash_pow2 (test_hash_int, 100000);
+  test_hash_pow2 (test_hash_constant, 1000);
+  test_hash_open (test_hash_int, 100000);
+  test_hash_open (test_hash_constant, 1000);
+  test_hash_mt (test_hash_int, 100000, 0);
+  test_hash_mt (test_hash_int, 10000, 3);
+  test_hash_mt (test_hash_constant, 1000, 1);
+#ifdef _OPENMP
+  test_hash_mt_threads (100000);
+#endif
+
+  /* compare throughput, optionally with a given number of keys */
+  N = argc >= 2 ? (int) strtol (argv[1], NULL, 0) : 100000;
+  for (which = 0; which < 3; ++which) {
+    test_hash_timing (which, N);
+  }
+  test_hash_array_batch (N);
+  test_hash_strings (N);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_containers.h>
+#include <sc_dmatrix.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void
+test_malloc_check_align (void *ptr)
+{
+#ifdef SC_ENABLE_MEMALIGN
+  SC_CHECK_ABORT ((size_t) ptr % SC_MEMALIGN_BYTES == 0, "Alignment");
+#endif
+}
+
+/** Check contents and alignment for a range of sizes and reallocations. */
+static void
+test_malloc_sizes (void)
+{
+  int                 status;
+  size_t              size, newsize, i;
+  char               *p, *z;
+
+  status = sc_memory_status (sc_package_id);
+  for (size = 0; size <= 5000; size += 1 + size / 8) {
+    p = SC_ALLOC (char, size);
+    test_malloc_check_align (p);
+    for (i = 0; i < size; ++i) {
+      p[i] = (char) (i * 7 + size);
+    }
+
+    z = SC_ALLOC_ZERO (char, size);
+    test_malloc_check_align (z);
+    for (i = 0; i < size; ++i) {
+      SC_CHECK_ABORT (z[i] == 0, "Calloc");
+    }
+    SC_FREE (z);
+
+    /* grow and shrink across size classes and keep the common prefix */
+    newsize = 3 * size / 2 + 1;
+    p = SC_REALLOC (p, char, newsize);
+    test_malloc_check_align (p);
+    for (i = 0; i < size; ++i) {
+      SC_CHECK_ABORT (p[i] == (char) (i * 7 + size), "Realloc grow");
+    }
+    newsize = size / 3 + 1;
+    p = SC_REALLOC (p, char, newsize);
+    for (i = 0; i < SC_MIN (size, newsize); ++i) {
+      SC_CHECK_ABORT (p[i] == (char) (i * 7 + size), "Realloc shrink");
+    }
+    SC_FREE (p);
+  }
+  SC_CHECK_ABORT (sc_memory_status (sc_package_id) == status, "Status");
+}
+
+#ifdef _OPENMP
+
+/** Free memory in different threads than it was allocated in. */
+static void
+test_malloc_threads (int N)
+{
+  int                 i, status;
+  char              **ptrs;
+  double              elapsed;
+
+  status = sc_memory_status (sc_package_id);
+  ptrs = SC_ALLOC (char *, N);
+  elapsed = -sc_MPI_Wtime ();
+#pragma omp parallel for schedule(static)
+  for (i = 0; i < N; ++i) {
+    ptrs[i] = SC_ALLOC (char, 1 + i % 300);
+    ptrs[i][0] = (char) i;
+  }
+#pragma omp parallel for schedule(static, 7)
+  for (i = N - 1; i >= 0; --i) {
+    SC_CHECK_ABORT (ptrs[i][0] == (char) i, "Thread contents");
+    SC_FREE (ptrs[i]);
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_FREE (ptrs);
+  SC_CHECK_ABORT (sc_memory_status (sc_package_id) == status,
+                  "Thread status");
+  SC_GLOBAL_INFOF ("Malloc threads %d %g Mops/s\n", omp_get_max_threads (),
+                   2e-6 * N / elapsed);
+}
+
+#endif
+
+/** Allocate and free many small blocks in a pattern of changing sizes. */
+static void
+test_malloc_timing (int N)
+{
+  int                 i, j;
+  const int           live = 256;
+  size_t              size;
+  void              **ptrs;
+  double              elapsed_sc, elapsed_libc;
+
+  ptrs = SC_ALLOC_ZERO (void *, live);
+  elapsed_sc = -sc_MPI_Wtime ();
+  for (i = 0; i < N; ++i) {
+    j = (i * 37) % live;
+    size = 8 + (size_t) ((i * 13) % 400);
+    SC_FREE (ptrs[j]);
+    ptrs[j] = SC_ALLOC (char, size);
+  }
+  for (j = 0; j < live; ++j) {
+    SC_FREE (ptrs[j]);
+    ptrs[j] = NULL;
+  }
+  elapsed_sc += sc_MPI_Wtime ();
+
+  elapsed_libc = -sc_MPI_Wtime ();
+  for (i = 0; i < N; ++i) {
+    j = (i * 37) % live;
+    size = 8 + (size_t) ((i * 13) % 400);
+    free (ptrs[j]);
+    ptrs[j] = malloc (size);
+  }
+  for (j = 0; j < live; ++j) {
+    free (ptrs[j]);
+  }
+  elapsed_libc += sc_MPI_Wtime ();
+  SC_FREE (ptrs);
+
+  SC_GLOBAL_INFOF ("Malloc sc %g Mops/s libc %g Mops/s\n",
+                   1e-6 * N / elapsed_sc, 1e-6 * N / elapsed_libc);
+}
+
+/** Time container workloads that allocate many small headers. */
+static void
+test_malloc_containers (int N)
+{
+  int                 i, j;
+  double              elapsed_array, elapsed_dmatrix;
+  sc_array_t         *a;
+  sc_dmatrix_t       *m;
+
+  elapsed_array = -sc_MPI_Wtime ();
+  for (i = 0; i < N; ++i) {
+    a = sc_array_new (sizeof (int));
+    for (j = 0; j < 1 + i % 8; ++j) {
+      *(int *) sc_array_push (a) = j;
+    }
+    sc_array_destroy (a);
+  }
+  elapsed_array += sc_MPI_Wtime ();
+
+  elapsed_dmatrix = -sc_MPI_Wtime ();
+  for (i = 0; i < N; ++i) {
+    m = sc_dmatrix_new (1 + i % 3, 3);
+    sc_dmatrix_set_value (m, (double) i);
+    sc_dmatrix_destroy (m);
+  }
+  elapsed_dmatrix += sc_MPI_Wtime ();
+
+  SC_GLOBAL_INFOF ("Malloc containers array %g Mops/s dmatrix %g Mops/s\n",
+                   1e-6 * N / elapsed_array, 1e-6 * N / elapsed_dmatrix);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 N;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_malloc_sizes ();
+
+  /* compare throughput, optionally with a given number of operations */
+  N = argc >= 2 ? (int) strtol (argv[1], NULL, 0) : 1000000;
+#ifdef _OPENMP
+  test_malloc_threads (N / 10);
+#endif
+  test_malloc_timing (N);
+  test_malloc_containers (N);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -0,0 +1,351 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_containers.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct test_mempool_octant
+{
+  int32_t             x, y, z;
+  int8_t              level;
+}
+test_mempool_octant_t;
+
+/** Check bulk allocation against single allocations and recycling. */
+static void
+test_mempool_alloc_many (sc_mempool_t * mp, int N)
+{
+  int                 i;
+  size_t              align;
+  void              **ptrs;
+  test_mempool_octant_t *o;
+
+  ptrs = SC_ALLOC (void *, N);
+  align = SC_MIN (sizeof (void *), sizeof (test_mempool_octant_t));
+
+  /* mix single and bulk allocations */
+  for (i = 0; i < N / 4; ++i) {
+    ptrs[i] = sc_mempool_alloc (mp);
+  }
+  sc_mempool_alloc_many (mp, (size_t) (N - N / 4), ptrs + N / 4);
+  SC_CHECK_ABORT (mp->elem_count == (size_t) N, "Many count");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT ((size_t) ptrs[i] % align == 0, "Many alignment");
+    o = (test_mempool_octant_t *) ptrs[i];
+    o->x = o->y = o->z = i;
+    o->level = (int8_t) (i % 20);
+  }
+  for (i = 0; i < N; ++i) {
+    o = (test_mempool_octant_t *) ptrs[i];
+    SC_CHECK_ABORT (o->x == i && o->y == i && o->z == i &&
+                    o->level == (int8_t) (i % 20), "Many overlap");
+  }
+
+  /* return every other element and get them back in bulk */
+  for (i = 0; i < N; i += 2) {
+    sc_mempool_free (mp, ptrs[i]);
+  }
+  sc_mempool_alloc_many (mp, (size_t) (N / 2), ptrs);
+  SC_CHECK_ABORT (mp->freed.elem_count == 0 && mp->elem_count == (size_t) N,
+                  "Many recycle");
+
+  sc_mempool_truncate (mp);
+  sc_mempool_alloc_many (mp, (size_t) N, ptrs);
+  SC_CHECK_ABORT (mp->elem_count == (size_t) N, "Many truncate");
+
+  SC_FREE (ptrs);
+}
+
+/** Compare single, bulk and chunked allocation of octant-sized elements. */
+static void
+test_mempool_timing (int N)
+{
+  int                 i, which;
+  double              elapsed[3];
+  void              **ptrs;
+  sc_mempool_t       *mp;
+  const char         *names[3] = { "single", "many", "chunked" };
+
+  ptrs = SC_ALLOC (void *, N);
+  for (which = 0; which < 3; ++which) {
+    mp = which < 2 ? sc_mempool_new (sizeof (test_mempool_octant_t)) :
+      sc_mempool_new_chunked (sizeof (test_mempool_octant_t), 1 << 21);
+    elapsed[which] = -sc_MPI_Wtime ();
+    if (which == 0) {
+      for (i = 0; i < N; ++i) {
+        ptrs[i] = sc_mempool_alloc (mp);
+      }
+    }
+    else {
+      sc_mempool_alloc_many (mp, (size_t) N, ptrs);
+    }
+    for (i = 0; i < N; ++i) {
+      ((test_mempool_octant_t *) ptrs[i])->level = 1;
+    }
+    elapsed[which] += sc_MPI_Wtime ();
+    sc_mempool_destroy (mp);
+  }
+  SC_FREE (ptrs);
+
+  for (which = 0; which < 3; ++which) {
+    SC_GLOBAL_INFOF ("Mempool %s %g Mops/s\n", names[which],
+                     1e-6 * N / elapsed[which]);
+  }
+}
+
+/** Free elements in a different thread index than they were allocated.
+ * This runs serially by passing the thread indices explicitly.
+ */
+static void
+test_mempool_mt_serial (int N)
+{
+  int                 i;
+  const int           num_threads = 3;
+  size_t              used;
+  int               **elems;
+  sc_mempool_mt_t    *mp;
+
+  mp = sc_mempool_mt_new (sizeof (int), num_threads);
+  elems = SC_ALLOC (int *, N);
+  for (i = 0; i < N; ++i) {
+    elems[i] = (int *) sc_mempool_mt_alloc (mp, i % num_threads);
+    *elems[i] = i;
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == (size_t) N, "Serial count");
+  used = sc_mempool_mt_memory_used (mp);
+
+  /* every element is freed by the next thread index */
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (*elems[i] == i, "Serial contents");
+    sc_mempool_mt_free (mp, (i + 1) % num_threads, elems[i]);
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == 0, "Serial free count");
+
+  /* the returned elements are recycled by their owners */
+  for (i = 0; i < N; ++i) {
+    elems[i] = (int *) sc_mempool_mt_alloc (mp, i % num_threads);
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_memory_used (mp) == used, "Serial recycle");
+  for (i = 0; i < N; ++i) {
+    sc_mempool_mt_free (mp, i % num_threads, elems[i]);
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == 0, "Serial count again");
+
+  SC_FREE (elems);
+  sc_mempool_mt_destroy (mp);
+}
+
+static unsigned
+test_mempool_hash_int (const void *v, const void *u)
+{
+  return (unsigned) *(const int *) v;
+}
+
+static int
+test_mempool_equal_int (const void *v1, const void *v2, const void *u)
+{
+  return *(const int *) v1 == *(const int *) v2;
+}
+
+/** Hand lists and hash tables over to another thread index.
+ * Their links are then freed by a different index than allocated them.
+ */
+static void
+test_mempool_mt_containers (int N)
+{
+  int                 i, t;
+  const int           num_threads = 3;
+  int                *data;
+  sc_list_t          *lists[3];
+  sc_hash_t          *hashes[3];
+  sc_mempool_mt_t    *lp, *hp;
+
+  lp = sc_mempool_mt_new (sizeof (sc_link_t), num_threads);
+  hp = sc_mempool_mt_new (sizeof (sc_hash_link_t), num_threads);
+  data = SC_ALLOC (int, N);
+  for (t = 0; t < num_threads; ++t) {
+    lists[t] = sc_list_new_mt (lp, t);
+    hashes[t] = sc_hash_new_mt (test_mempool_hash_int,
+                                test_mempool_equal_int, NULL, hp, t);
+  }
+  for (i = 0; i < N; ++i) {
+    data[i] = i;
+    t = i % num_threads;
+    (void) sc_list_append (lists[t], data + i);
+    SC_CHECK_ABORT (sc_hash_insert_unique (hashes[t], data + i, NULL),
+                    "Container insert");
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (lp) == (size_t) N, "List links");
+  SC_CHECK_ABORT (sc_mempool_mt_count (hp) == (size_t) N, "Hash links");
+
+  /* every container is emptied by the next thread index */
+  for (t = 0; t < num_threads; ++t) {
+    sc_list_set_thread (lists[t], (t + 1) % num_threads);
+    sc_hash_set_thread (hashes[t], (t + 1) % num_threads);
+  }
+  for (i = 0; i < N; ++i) {
+    t = i % num_threads;
+    SC_CHECK_ABORT (*(int *) sc_list_pop (lists[t]) == i, "List order");
+    SC_CHECK_ABORT (sc_hash_remove (hashes[t], data + i, NULL),
+                    "Container remove");
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (lp) == 0, "List links freed");
+  SC_CHECK_ABORT (sc_mempool_mt_count (hp) == 0, "Hash links freed");
+
+  for (t = 0; t < num_threads; ++t) {
+    sc_list_destroy (lists[t]);
+    sc_hash_destroy (hashes[t]);
+  }
+  SC_FREE (data);
+  sc_mempool_mt_destroy (hp);
+  sc_mempool_mt_destroy (lp);
+}
+
+#ifdef _OPENMP
+
+/** Allocate in all threads and free each element in another thread. */
+static void
+test_mempool_mt_threads (int N)
+{
+  int                 i, round;
+  int                 num_threads;
+  int               **elems;
+  double              elapsed;
+  sc_mempool_mt_t    *mp;
+
+  num_threads = omp_get_max_threads ();
+  mp = sc_mempool_mt_new (sizeof (int), num_threads);
+  elems = SC_ALLOC (int *, N);
+
+  elapsed = -sc_MPI_Wtime ();
+  for (round = 0; round < 4; ++round) {
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < N; ++i) {
+      elems[i] = (int *) sc_mempool_mt_alloc (mp, omp_get_thread_num ());
+      *elems[i] = i;
+    }
+#pragma omp parallel for schedule(dynamic, 64)
+    for (i = N - 1; i >= 0; --i) {
+      SC_CHECK_ABORT (*elems[i] == i, "Thread contents");
+      sc_mempool_mt_free (mp, omp_get_thread_num (), elems[i]);
+    }
+  }
+  elapsed += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == 0, "Thread count");
+  SC_GLOBAL_INFOF ("Mempool threads %d %g Mops/s\n", num_threads,
+                   8e-6 * N / elapsed);
+
+  SC_FREE (elems);
+  sc_mempool_mt_destroy (mp);
+}
+
+/** Fill one hash table per thread and let the next thread empty it. */
+static void
+test_mempool_mt_hash_threads (int N)
+{
+  int                 i, t;
+  int                 num_threads;
+  int                *data;
+  sc_hash_t         **hashes;
+  sc_mempool_mt_t    *mp;
+
+  num_threads = omp_get_max_threads ();
+  mp = sc_mempool_mt_new (sizeof (sc_hash_link_t), num_threads);
+  hashes = SC_ALLOC (sc_hash_t *, num_threads);
+  data = SC_ALLOC (int, N);
+
+#pragma omp parallel private(i, t)
+  {
+    t = omp_get_thread_num ();
+    hashes[t] = sc_hash_new_mt (test_mempool_hash_int,
+                                test_mempool_equal_int, NULL, mp, t);
+    for (i = t; i < N; i += num_threads) {
+      data[i] = i;
+      SC_CHECK_ABORT (sc_hash_insert_unique (hashes[t], data + i, NULL),
+                      "Thread hash insert");
+    }
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == (size_t) N, "Thread links");
+
+#pragma omp parallel private(i, t)
+  {
+    t = (omp_get_thread_num () + 1) % num_threads;
+    sc_hash_set_thread (hashes[t], omp_get_thread_num ());
+    for (i = t; i < N; i += num_threads) {
+      SC_CHECK_ABORT (sc_hash_remove (hashes[t], data + i, NULL),
+                      "Thread hash remove");
+    }
+  }
+  SC_CHECK_ABORT (sc_mempool_mt_count (mp) == 0, "Thread links freed");
+
+  for (t = 0; t < num_threads; ++t) {
+    sc_hash_destroy (hashes[t]);
+  }
+  SC_FREE (data);
+  SC_FREE (hashes);
+  sc_mempool_mt_destroy (mp);
+}
+
+#endif
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  int                 N;
+  sc_mempool_t       *mp;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  N = argc >= 2 ? (int) strtol (argv[1], NULL, 0) : 100000;
+
+  mp = sc_mempool_new (sizeof (test_mempool_octant_t));
+  test_mempool_alloc_many (mp, N);
+  sc_mempool_destroy (mp);
+  mp = sc_mempool_new_zero_and_persist (sizeof (test_mempool_octant_t));
+  test_mempool_alloc_many (mp, N);
+  sc_mempool_destroy (mp);
+  mp = sc_mempool_new_chunked (sizeof (test_mempool_octant_t), 1 << 16);
+  test_mempool_alloc_many (mp, N);
+  sc_mempool_destroy (mp);
+  test_mempool_timing (10 * N);
+
+  test_mempool_mt_serial (N);
+  test_mempool_mt_containers (N);
+#ifdef _OPENMP
+  test_mempool_mt_threads (N);
+  test_mempool_mt_hash_threads (N);
+#endif
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
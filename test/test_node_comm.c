@@ -36,7 +36,8 @@
 int
 test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
 {
-  int                 i, p, size, mpiret, check;
+  int                 i, p, size, rank, mpiret, check;
+  int                 total, *counts, *displs;
   long int           *myval, *recv_self, *recv_shmem, *scan_self, *scan_shmem,
                      *copy_shmem;
 
@@ -44,6 +45,8 @@ test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
 
   mpiret = sc_MPI_Comm_size (comm, &size);
   SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
 
   myval = SC_ALLOC (long int, count);
   for (i = 0; i < count; i++) {
@@ -84,6 +87,38 @@ test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
     return 1;
   }
   SC_SHMEM_FREE (copy_shmem, comm);
+
+  /* gather p % (count + 1) items from process p */
+  counts = SC_ALLOC (int, size);
+  displs = SC_ALLOC (int, size);
+  for (total = p = 0; p < size; p++) {
+    counts[p] = p % (count + 1);
+    displs[p] = total;
+    total += counts[p];
+  }
+  mpiret = sc_MPI_Allgatherv (myval, counts[rank], sc_MPI_LONG, recv_self,
+                              counts, displs, sc_MPI_LONG, comm);
+  SC_CHECK_MPI (mpiret);
+  sc_shmem_allgatherv (myval, counts[rank], sc_MPI_LONG, recv_shmem,
+                       counts, displs, sc_MPI_LONG, comm);
+  check = memcmp (recv_self, recv_shmem, total * sizeof (long int));
+  if (check) {
+    SC_GLOBAL_LERROR ("sc_shmem_allgatherv mismatch\n");
+    return 1;
+  }
+  SC_FREE (counts);
+  SC_FREE (displs);
+
+  mpiret = sc_MPI_Allreduce (myval, recv_self, count, sc_MPI_LONG,
+                             sc_MPI_SUM, comm);
+  SC_CHECK_MPI (mpiret);
+  sc_shmem_allreduce (myval, recv_shmem, count, sc_MPI_LONG, sc_MPI_SUM,
+                      comm);
+  check = memcmp (recv_self, recv_shmem, count * sizeof (long int));
+  if (check) {
+    SC_GLOBAL_LERROR ("sc_shmem_allreduce mismatch\n");
+    return 1;
+  }
   SC_SHMEM_FREE (recv_shmem, comm);
 
   scan_shmem = SC_SHMEM_ALLOC (long int, (size_t) count * (size + 1), comm);
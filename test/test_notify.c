@@ -62,12 +62,151 @@ sc_uniq (int *list, int *count)
   *count = incount - skip;
 }
 
+/** Run a persistent plan over a sequence of slowly changing patterns. */
+static void
+test_notify_plan (sc_MPI_Comm mpicomm, int mpisize, int mpirank)
+{
+  int                 i, step;
+  int                 mpiret;
+  int                *receivers, num_receivers;
+  int                *senders1, num_senders1;
+  int                *senders2, num_senders2;
+  sc_notify_plan_t   *plan;
+
+  receivers = SC_ALLOC (int, mpisize);
+  senders1 = SC_ALLOC (int, mpisize);
+  senders2 = SC_ALLOC (int, mpisize);
+  plan = sc_notify_plan_new (mpicomm);
+
+  for (step = 0; step < 6; ++step) {
+    /* the pattern changes on one process only and not in every step */
+    num_receivers = 0;
+    for (i = 0; i < mpisize; ++i) {
+      if ((i + mpirank) % 3 == 0 ||
+          (step / 2 % 2 == 1 && mpirank == step % mpisize &&
+           (i + mpirank) % 3 == 1)) {
+        receivers[num_receivers++] = i;
+      }
+    }
+
+    mpiret = sc_notify_allgather (receivers, num_receivers,
+                                  senders1, &num_senders1, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_notify_plan_execute (plan, receivers, num_receivers,
+                                     senders2, &num_senders2);
+    SC_CHECK_MPI (mpiret);
+
+    SC_CHECK_ABORTF (num_senders1 == num_senders2,
+                     "Mismatch plan sender count in step %d", step);
+    for (i = 0; i < num_senders1; ++i) {
+      SC_CHECK_ABORTF (senders1[i] == senders2[i],
+                       "Mismatch plan sender %d in step %d", i, step);
+    }
+  }
+  SC_CHECK_ABORT (plan->num_executed == 6, "Plan executions");
+  SC_CHECK_ABORT (plan->num_unchanged == (mpisize > 1 ? 2 : 5),
+                  "Plan reuse");
+  SC_GLOBAL_INFOF ("Notify plan executed %ld times and reused %ld times\n",
+                   plan->num_executed, plan->num_unchanged);
+
+  sc_notify_plan_destroy (plan);
+  SC_FREE (receivers);
+  SC_FREE (senders1);
+  SC_FREE (senders2);
+}
+
+typedef struct test_notify_item
+{
+  long                bytes;
+  int                 tag;
+  char                flag;
+}
+test_notify_item_t;
+
+/** Send payloads of fixed and of variable size through the n-ary tree. */
+static void
+test_notify_payload (sc_MPI_Comm mpicomm, int mpirank,
+                     int *receivers, int num_receivers,
+                     int *senders, int num_senders, int ntop, int nint,
+                     int nbot)
+{
+  int                 i, k, count;
+  int                 mpiret;
+  int                 sender;
+  size_t             *poffs;
+  sc_array_t         *rec, *pay, *offs;
+  test_notify_item_t *item;
+
+  /* fixed-size payload larger than one integer */
+  rec = sc_array_new_count (sizeof (int), num_receivers);
+  pay = sc_array_new_count (sizeof (test_notify_item_t), num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    *(int *) sc_array_index_int (rec, i) = receivers[i];
+    item = (test_notify_item_t *) sc_array_index_int (pay, i);
+    item->bytes = 1000L * mpirank + receivers[i];
+    item->tag = -mpirank;
+    item->flag = (char) (mpirank % 2);
+  }
+  sc_notify_ext (rec, NULL, pay, ntop, nint, nbot, mpicomm);
+  SC_CHECK_ABORT ((int) rec->elem_count == num_senders, "Item count");
+  SC_CHECK_ABORT ((int) pay->elem_count == num_senders, "Item payload");
+  for (i = 0; i < num_senders; ++i) {
+    sender = *(int *) sc_array_index_int (rec, i);
+    SC_CHECK_ABORTF (sender == senders[i], "Item sender %d", i);
+    item = (test_notify_item_t *) sc_array_index_int (pay, i);
+    SC_CHECK_ABORTF (item->bytes == 1000L * sender + mpirank &&
+                     item->tag == -sender &&
+                     item->flag == (char) (sender % 2), "Item %d", i);
+  }
+  sc_array_destroy (rec);
+  sc_array_destroy (pay);
+
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* variable-size payload of zero or more integers per receiver */
+  rec = sc_array_new_count (sizeof (int), num_receivers);
+  pay = sc_array_new (sizeof (int));
+  offs = sc_array_new_count (sizeof (size_t), num_receivers + 1);
+  poffs = (size_t *) offs->array;
+  poffs[0] = 0;
+  for (i = 0; i < num_receivers; ++i) {
+    *(int *) sc_array_index_int (rec, i) = receivers[i];
+    count = (mpirank + receivers[i]) % 5;
+    for (k = 0; k < count; ++k) {
+      *(int *) sc_array_push (pay) = 1000 * mpirank + k;
+    }
+    poffs[i + 1] = pay->elem_count;
+  }
+  sc_notify_extv (rec, NULL, pay, offs, ntop, nint, nbot, mpicomm);
+  SC_CHECK_ABORT ((int) rec->elem_count == num_senders, "Blob count");
+  SC_CHECK_ABORT ((int) offs->elem_count == num_senders + 1, "Blob offs");
+  poffs = (size_t *) offs->array;
+  SC_CHECK_ABORT (poffs[0] == 0 && poffs[num_senders] == pay->elem_count,
+                  "Blob total");
+  for (i = 0; i < num_senders; ++i) {
+    sender = *(int *) sc_array_index_int (rec, i);
+    SC_CHECK_ABORTF (sender == senders[i], "Blob sender %d", i);
+    count = (sender + mpirank) % 5;
+    SC_CHECK_ABORTF (poffs[i + 1] - poffs[i] == (size_t) count,
+                     "Blob length %d", i);
+    for (k = 0; k < count; ++k) {
+      SC_CHECK_ABORTF (*(int *) sc_array_index (pay, poffs[i] + k) ==
+                       1000 * sender + k, "Blob %d entry %d", i, k);
+    }
+  }
+  sc_array_destroy (rec);
+  sc_array_destroy (pay);
+  sc_array_destroy (offs);
+}
+
 typedef enum sc_test_stats
 {
   SC_STAT_NOTIFY_ALLG,
   SC_STAT_NOTIFY_NARY,
   SC_STAT_NOTIFY_PAYL,
   SC_STAT_NOTIFY_NATI,
+  SC_STAT_NOTIFY_NBX,
   SC_STAT_NOTIFY_LAST
 }
 sc_test_stats_t;
@@ -75,19 +214,23 @@ sc_test_stats_t;
 int
 main (int argc, char **argv)
 {
-  int                 i;
+  int                 i, j;
   int                 mpiret;
   int                 mpisize, mpirank;
   int                *senders1, num_senders1;
   int                *senders2, num_senders2;
   int                *senders3, num_senders3;
   int                *senders4, num_senders4;
+  int                *senders5, num_senders5;
   int                *receivers, num_receivers;
   int                 ntop, nint, nbot;
+  int                 fanout, fanout2;
+  sc_notify_type_t    tuned, tuned2;
   double              elapsed_allgather;
   double              elapsed_nary;
   double              elapsed_native;
   double              elapsed_payl;
+  double              elapsed_nbx;
   sc_MPI_Comm         mpicomm;
   sc_array_t         *rec2, *snd2, *rec4, *pay4;
   sc_statinfo_t       stats[SC_STAT_NOTIFY_LAST];
@@ -181,17 +324,83 @@ main (int argc, char **argv)
   elapsed_native += sc_MPI_Wtime ();
   sc_stats_set1 (stats + SC_STAT_NOTIFY_NATI, elapsed_native, "Native");
 
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  SC_GLOBAL_INFO ("Testing sc_notify_nbx\n");
+  senders5 = SC_ALLOC (int, mpisize);
+  elapsed_nbx = -sc_MPI_Wtime ();
+  mpiret = sc_notify_nbx (receivers, num_receivers,
+                          senders5, &num_senders5, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_nbx += sc_MPI_Wtime ();
+  sc_stats_set1 (stats + SC_STAT_NOTIFY_NBX, elapsed_nbx, "NBX");
+
   SC_CHECK_ABORT (num_senders1 == num_senders2, "Mismatch 12 sender count");
   SC_CHECK_ABORT (num_senders1 == num_senders3, "Mismatch 13 sender count");
   SC_CHECK_ABORT (num_senders1 == num_senders4, "Mismatch 14 sender count");
+  SC_CHECK_ABORT (num_senders1 == num_senders5, "Mismatch 15 sender count");
   for (i = 0; i < num_senders1; ++i) {
     SC_CHECK_ABORTF (senders1[i] == senders2[i], "Mismatch 12 sender %d", i);
     SC_CHECK_ABORTF (senders1[i] == senders3[i], "Mismatch 13 sender %d", i);
     SC_CHECK_ABORTF (senders1[i] == senders4[i], "Mismatch 14 sender %d", i);
+    SC_CHECK_ABORTF (senders1[i] == senders5[i], "Mismatch 15 sender %d", i);
     SC_CHECK_ABORTF (*(int *) sc_array_index_int (pay4, i) ==
                      2 * senders4[i] + 3, "Mismatch payload %d", i);
   }
 
+  /* successive calls must not receive each other's messages */
+  for (j = 0; j < 3; ++j) {
+    mpiret = sc_notify_nbx (receivers, num_receivers,
+                            senders5, &num_senders5, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORT (num_senders1 == num_senders5, "Mismatch nbx count");
+    for (i = 0; i < num_senders1; ++i) {
+      SC_CHECK_ABORTF (senders1[i] == senders5[i], "Mismatch nbx %d", i);
+    }
+  }
+
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  SC_GLOBAL_INFOF ("Testing sc_notify_ext and sc_notify_extv with %d %d %d"
+                   " and general payload\n", ntop, nint, nbot);
+  test_notify_payload (mpicomm, mpirank, receivers, num_receivers,
+                       senders1, num_senders1, ntop, nint, nbot);
+
+  /* run every algorithm through sc_notify, the automatic one twice */
+  SC_GLOBAL_INFO ("Testing sc_notify with all types\n");
+  SC_CHECK_ABORT (!sc_notify_tune_lookup (mpicomm, &tuned, &fanout),
+                  "Notify tuned too early");
+  for (j = SC_NOTIFY_BINARY; j <= SC_NOTIFY_AUTO + 1; ++j) {
+    sc_notify_type = (sc_notify_type_t) SC_MIN (j, SC_NOTIFY_AUTO);
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_notify (receivers, num_receivers,
+                        senders3, &num_senders3, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORTF (num_senders1 == num_senders3, "Mismatch type %d", j);
+    for (i = 0; i < num_senders1; ++i) {
+      SC_CHECK_ABORTF (senders1[i] == senders3[i],
+                       "Mismatch type %d sender %d", j, i);
+    }
+    if (j == SC_NOTIFY_AUTO) {
+      /* the first automatic call stores its choice */
+      SC_CHECK_ABORT (sc_notify_tune_lookup (mpicomm, &tuned, &fanout),
+                      "Notify not tuned");
+    }
+    else if (j > SC_NOTIFY_AUTO) {
+      /* the second one reuses it */
+      SC_CHECK_ABORT (sc_notify_tune_lookup (mpicomm, &tuned2, &fanout2) &&
+                      tuned2 == tuned && fanout2 == fanout,
+                      "Notify tuned again");
+    }
+  }
+  sc_notify_type = SC_NOTIFY_BINARY;
+
+  SC_GLOBAL_INFO ("Testing sc_notify_plan\n");
+  test_notify_plan (mpicomm, mpisize, mpirank);
+
   SC_FREE (receivers);
   SC_FREE (senders1);
   sc_array_destroy (rec2);
@@ -199,6 +408,7 @@ main (int argc, char **argv)
   SC_FREE (senders3);
   sc_array_destroy (rec4);
   sc_array_destroy (pay4);
+  SC_FREE (senders5);
 
   sc_stats_compute (mpicomm, SC_STAT_NOTIFY_LAST, stats);
   sc_stats_print (sc_package_id, SC_LP_STATISTICS,
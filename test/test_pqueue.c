@@ -34,6 +34,103 @@ compar (const void *p1, const void *p2)
   return i1 - i2;
 }
 
+/** Check that the array is a heap of the given arity. */
+static void
+test_is_heap (sc_array_t * a, size_t arity)
+{
+  size_t              zz;
+
+  for (zz = 1; zz < a->elem_count; ++zz) {
+    SC_CHECK_ABORT (compar (sc_array_index (a, (zz - 1) / arity),
+                            sc_array_index (a, zz)) <= 0, "Heap property");
+  }
+}
+
+/** Heapify, pop and pop_push on binary and 4-ary heaps with duplicates. */
+static void
+test_heapify_pop_push (int count)
+{
+  int                 i, e, r2, r4, last, temp;
+  sc_array_t         *a2, *a4;
+
+  a2 = sc_array_new (sizeof (int));
+  a4 = sc_array_new (sizeof (int));
+  for (i = 0; i < count; ++i) {
+    e = (int) ((7919 * (unsigned) i) % 1009);
+    *(int *) sc_array_push (a2) = e;
+    *(int *) sc_array_push (a4) = e;
+  }
+  sc_array_pqueue_heapify (a2, &temp, compar);
+  sc_array_pqueue4_heapify (a4, &temp, compar);
+  test_is_heap (a2, 2);
+  test_is_heap (a4, 4);
+
+  /* replace the top with a larger element, as in an event queue */
+  last = -1;
+  for (i = 0; i < 3 * count; ++i) {
+    e = (int) ((104729 * (unsigned) i) % 1013);
+    (void) sc_array_pqueue_pop_push (a2, &r2, &e, compar);
+    e = (int) ((104729 * (unsigned) i) % 1013);
+    (void) sc_array_pqueue4_pop_push (a4, &r4, &e, compar);
+    SC_CHECK_ABORT (r2 == r4, "pqueue pop_push");
+  }
+  test_is_heap (a2, 2);
+  test_is_heap (a4, 4);
+
+  /* the heaps hold the same elements and pop them in order */
+  for (i = 0; i < count; ++i) {
+    (void) sc_array_pqueue_pop (a2, &r2, compar);
+    (void) sc_array_pqueue4_pop (a4, &r4, compar);
+    SC_CHECK_ABORT (r2 == r4 && r2 >= last, "pqueue pop");
+    last = r2;
+  }
+  SC_CHECK_ABORT (a2->elem_count == 0 && a4->elem_count == 0, "pqueue empty");
+
+  sc_array_destroy (a2);
+  sc_array_destroy (a4);
+}
+
+/** Time a sift down heavy workload on a binary and on a 4-ary heap. */
+static void
+test_pqueue_timing (int count, int rounds)
+{
+  int                 i, e, r, temp, arity;
+  double              elapsed[2];
+  sc_array_t         *a;
+
+  for (arity = 0; arity < 2; ++arity) {
+    a = sc_array_new (sizeof (int));
+    for (i = 0; i < count; ++i) {
+      *(int *) sc_array_push (a) = (int) ((7919 * (unsigned) i) % 65521);
+    }
+    elapsed[arity] = -sc_MPI_Wtime ();
+    if (arity == 0) {
+      sc_array_pqueue_heapify (a, &temp, compar);
+      for (i = 0; i < rounds; ++i) {
+        e = (int) ((104729 * (unsigned) i) % 65521);
+        (void) sc_array_pqueue_pop_push (a, &r, &e, compar);
+      }
+      while (a->elem_count > 0) {
+        (void) sc_array_pqueue_pop (a, &r, compar);
+      }
+    }
+    else {
+      sc_array_pqueue4_heapify (a, &temp, compar);
+      for (i = 0; i < rounds; ++i) {
+        e = (int) ((104729 * (unsigned) i) % 65521);
+        (void) sc_array_pqueue4_pop_push (a, &r, &e, compar);
+      }
+      while (a->elem_count > 0) {
+        (void) sc_array_pqueue4_pop (a, &r, compar);
+      }
+    }
+    elapsed[arity] += sc_MPI_Wtime ();
+    sc_array_destroy (a);
+  }
+  SC_GLOBAL_INFOF ("Test timings pqueue heap %d rounds %d binary %g"
+                   " 4-ary %g\n", count, rounds, elapsed[0], elapsed[1]);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -147,6 +244,28 @@ main (int argc, char **argv)
                   elapsed_pqueue, 3. * elapsed_qsort);
 
   sc_array_destroy (a4);
+
+  /* the 4-ary heap pops the same sequence */
+  a1 = sc_array_new (sizeof (int));
+  for (i = 0; i < count; ++i) {
+    *(int *) sc_array_push (a1) = (15 * i) % 172;
+    (void) sc_array_pqueue4_add (a1, &temp, compar);
+  }
+  test_is_heap (a1, 4);
+  i3last = -1;
+  for (i = 0; i < count; ++i) {
+    (void) sc_array_pqueue4_pop (a1, &i3, compar);
+    SC_CHECK_ABORT (i3 >= i3last, "pqueue4_pop");
+    i3last = i3;
+  }
+  sc_array_destroy (a1);
+
+  test_heapify_pop_push (1);
+  test_heapify_pop_push (2);
+  test_heapify_pop_push (5);
+  test_heapify_pop_push (count);
+  test_pqueue_timing (100000, 1000000);
+
   sc_finalize ();
 
   mpiret = sc_MPI_Finalize ();
@@ -23,6 +23,167 @@
 
 #include <sc_reduce.h>
 
+/** Compare long vector reductions with MPI and report the timings. */
+static void
+test_reduce_vector (sc_MPI_Comm mpicomm, int mpirank, int mpisize, int N)
+{
+  int                 mpiret;
+  int                 i, j;
+  int                *ivalues, *iresult, *iexpect;
+  long               *lvalues, *lresult, *lexpect;
+  double             *dvalues, *dresult, *dexpect;
+  double              elapsed_sc, elapsed_mpi;
+  sc_MPI_Op           op[3] = { sc_MPI_SUM, sc_MPI_MAX, sc_MPI_MIN };
+
+  ivalues = SC_ALLOC (int, 3 * N);
+  iresult = ivalues + N;
+  iexpect = ivalues + 2 * N;
+  lvalues = SC_ALLOC (long, 3 * N);
+  lresult = lvalues + N;
+  lexpect = lvalues + 2 * N;
+  dvalues = SC_ALLOC (double, 3 * N);
+  dresult = dvalues + N;
+  dexpect = dvalues + 2 * N;
+  for (i = 0; i < N; ++i) {
+    ivalues[i] = (mpirank * 7 + i * 13) % 101 - 50;
+    lvalues[i] = (long) ((mpirank * 5 + i * 17) % 103 - 51) * 100003L;
+    dvalues[i] = 0.5 * ((mpirank * 11 + i * 3) % 97);
+  }
+
+  for (j = 0; j < 3; ++j) {
+    sc_allreduce (ivalues, iresult, N, sc_MPI_INT, op[j], mpicomm);
+    mpiret = sc_MPI_Allreduce (ivalues, iexpect, N, sc_MPI_INT, op[j],
+                               mpicomm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORTF (!memcmp (iresult, iexpect, N * sizeof (int)),
+                     "Allreduce int vector mismatch %d", j);
+
+    sc_allreduce (lvalues, lresult, N, sc_MPI_LONG, op[j], mpicomm);
+    mpiret = sc_MPI_Allreduce (lvalues, lexpect, N, sc_MPI_LONG, op[j],
+                               mpicomm);
+    SC_CHECK_MPI (mpiret);
+    SC_CHECK_ABORTF (!memcmp (lresult, lexpect, N * sizeof (long)),
+                     "Allreduce long vector mismatch %d", j);
+
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed_sc = -sc_MPI_Wtime ();
+    sc_allreduce (dvalues, dresult, N, sc_MPI_DOUBLE, op[j], mpicomm);
+    elapsed_sc += sc_MPI_Wtime ();
+
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed_mpi = -sc_MPI_Wtime ();
+    mpiret = sc_MPI_Allreduce (dvalues, dexpect, N, sc_MPI_DOUBLE, op[j],
+                               mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed_mpi += sc_MPI_Wtime ();
+
+    /* the sums of half-integers are exact in any order */
+    for (i = 0; i < N; ++i) {
+      SC_CHECK_ABORTF (dresult[i] == dexpect[i],        /* ok */
+                       "Allreduce double vector mismatch %d", j);
+    }
+    SC_GLOBAL_INFOF ("Allreduce %d doubles with %d processes op %d:"
+                     " sc %g s MPI %g s\n", N, mpisize, j,
+                     elapsed_sc, elapsed_mpi);
+  }
+
+  SC_FREE (ivalues);
+  SC_FREE (lvalues);
+  SC_FREE (dvalues);
+}
+
+/** Run short and long nonblocking reductions at the same time. */
+static void
+test_reduce_nonblocking (sc_MPI_Comm mpicomm, int mpirank, int N)
+{
+  int                 mpiret;
+  int                 i, flag;
+  long                lvalue, lresult, lexpect;
+  double             *dvalues, *dresult, *dexpect;
+  sc_coll_t          *lrequest, *drequest;
+
+  dvalues = SC_ALLOC (double, 3 * N);
+  dresult = dvalues + N;
+  dexpect = dvalues + 2 * N;
+  for (i = 0; i < N; ++i) {
+    dvalues[i] = 0.5 * ((mpirank * 5 + i * 7) % 89);
+  }
+  lvalue = (long) (mpirank * 3 % 17);
+
+  sc_iallreduce (dvalues, dresult, N, sc_MPI_DOUBLE, sc_MPI_SUM, mpicomm,
+                 &drequest);
+  sc_iallreduce (&lvalue, &lresult, 1, sc_MPI_LONG, sc_MPI_MAX, mpicomm,
+                 &lrequest);
+
+  /* the send buffers may be modified right away */
+  mpiret = sc_MPI_Allreduce (dvalues, dexpect, N, sc_MPI_DOUBLE, sc_MPI_SUM,
+                             mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&lvalue, &lexpect, 1, sc_MPI_LONG, sc_MPI_MAX,
+                             mpicomm);
+  SC_CHECK_MPI (mpiret);
+  memset (dvalues, 0, N * sizeof (double));
+  lvalue = -1;
+
+  do {
+    sc_coll_test (&lrequest, &flag);
+  }
+  while (!flag);
+  SC_CHECK_ABORT (lrequest == NULL && lresult == lexpect,
+                  "Iallreduce long mismatch");
+
+  sc_coll_wait (&drequest);
+  SC_CHECK_ABORT (drequest == NULL, "Iallreduce request not freed");
+  for (i = 0; i < N; ++i) {
+    SC_CHECK_ABORT (dresult[i] == dexpect[i],   /* ok */
+                    "Iallreduce double vector mismatch");
+  }
+
+  SC_FREE (dvalues);
+}
+
+/** Compare sc_allreduce_node with every possible number of nodes. */
+static void
+test_reduce_node (sc_MPI_Comm mpicomm, int mpirank, int mpisize, int N)
+{
+  int                 mpiret;
+  int                 i, ppn;
+  long               *values, *result, *expect;
+  sc_MPI_Comm         nodecomm;
+
+  values = SC_ALLOC (long, 3 * N);
+  result = values + N;
+  expect = values + 2 * N;
+  for (i = 0; i < N; ++i) {
+    values[i] = (long) ((mpirank * 13 + i * 5) % 71);
+  }
+  mpiret = sc_MPI_Allreduce (values, expect, N, sc_MPI_LONG, sc_MPI_SUM,
+                             mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  for (ppn = 1; ppn <= mpisize; ++ppn) {
+    if (mpisize % ppn != 0) {
+      continue;
+    }
+    mpiret = sc_MPI_Comm_dup (mpicomm, &nodecomm);
+    SC_CHECK_MPI (mpiret);
+    sc_mpi_comm_attach_node_comms (nodecomm, ppn);
+
+    memset (result, 0, N * sizeof (long));
+    sc_allreduce_node (values, result, N, sc_MPI_LONG, sc_MPI_SUM, nodecomm);
+    SC_CHECK_ABORTF (!memcmp (result, expect, N * sizeof (long)),
+                     "Allreduce node mismatch with %d per node", ppn);
+
+    sc_mpi_comm_detach_node_comms (nodecomm);
+    mpiret = sc_MPI_Comm_free (&nodecomm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  SC_FREE (values);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -101,6 +262,18 @@ main (int argc, char **argv)
     }
   }
 
+  /* test long vectors below and above the scatter threshold */
+  test_reduce_vector (mpicomm, mpirank, mpisize, 100);
+  test_reduce_vector (mpicomm, mpirank, mpisize, 100003);
+
+  /* test nonblocking reductions */
+  test_reduce_nonblocking (mpicomm, mpirank, 100);
+  test_reduce_nonblocking (mpicomm, mpirank, 100003);
+
+  /* test node-aware reductions */
+  test_reduce_node (mpicomm, mpirank, mpisize, 3);
+  test_reduce_node (mpicomm, mpirank, mpisize, 100003);
+
   sc_finalize ();
 
   mpiret = sc_MPI_Finalize ();
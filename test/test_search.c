@@ -23,6 +23,115 @@
 
 #include <sc_search.h>
 
+/** Compare all lower bound searches on a sorted array with duplicates. */
+static void
+test_lower_bound64 (size_t nmemb)
+{
+  size_t              zz, ntargets;
+  int64_t            *array, *targets;
+  ssize_t             expect, *positions;
+  sc_search_eytzinger_t *eyt;
+
+  array = SC_ALLOC (int64_t, nmemb);
+  for (zz = 0; zz < nmemb; ++zz) {
+    array[zz] = 3 * (int64_t) (zz / 2);
+  }
+  ntargets = 3 * nmemb / 2 + 3;
+  targets = SC_ALLOC (int64_t, ntargets);
+  positions = SC_ALLOC (ssize_t, ntargets);
+  for (zz = 0; zz < ntargets; ++zz) {
+    targets[zz] = (int64_t) zz - 1;
+  }
+
+  eyt = sc_search_eytzinger_new (array, nmemb);
+  sc_search_lower_bound64_many (targets, ntargets, array, nmemb, positions);
+  for (zz = 0; zz < ntargets; ++zz) {
+    expect = sc_search_lower_bound64 (targets[zz], array, nmemb, nmemb / 2);
+    SC_CHECK_ABORT (sc_search_lower_bound64_branchless
+                    (targets[zz], array, nmemb) == expect, "Branchless");
+    SC_CHECK_ABORT (sc_search_eytzinger_lower_bound (eyt, targets[zz])
+                    == expect, "Eytzinger");
+    SC_CHECK_ABORT (positions[zz] == expect, "Many");
+  }
+  sc_search_eytzinger_destroy (eyt);
+
+  SC_FREE (array);
+  SC_FREE (targets);
+  SC_FREE (positions);
+}
+
+/** Time the lower bound searches for random and for sorted targets. */
+static void
+test_lower_bound64_timing (size_t nmemb, size_t ntargets)
+{
+  size_t              zz;
+  uint64_t            x;
+  int64_t            *array, *targets;
+  ssize_t            *positions, sum[4];
+  double              elapsed[5];
+  sc_search_eytzinger_t *eyt;
+
+  array = SC_ALLOC (int64_t, nmemb);
+  for (zz = 0; zz < nmemb; ++zz) {
+    array[zz] = 2 * (int64_t) zz;
+  }
+  targets = SC_ALLOC (int64_t, ntargets);
+  positions = SC_ALLOC (ssize_t, ntargets);
+  x = 1;
+  for (zz = 0; zz < ntargets; ++zz) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    targets[zz] = (int64_t) ((x >> 16) % (2 * nmemb + 2));
+  }
+  eyt = sc_search_eytzinger_new (array, nmemb);
+
+  memset (sum, 0, 4 * sizeof (ssize_t));
+  elapsed[0] = -sc_MPI_Wtime ();
+  for (zz = 0; zz < ntargets; ++zz) {
+    sum[0] += sc_search_lower_bound64 (targets[zz], array, nmemb, nmemb / 2);
+  }
+  elapsed[0] += sc_MPI_Wtime ();
+  elapsed[1] = -sc_MPI_Wtime ();
+  for (zz = 0; zz < ntargets; ++zz) {
+    sum[1] += sc_search_lower_bound64_branchless (targets[zz], array, nmemb);
+  }
+  elapsed[1] += sc_MPI_Wtime ();
+  elapsed[2] = -sc_MPI_Wtime ();
+  for (zz = 0; zz < ntargets; ++zz) {
+    sum[2] += sc_search_eytzinger_lower_bound (eyt, targets[zz]);
+  }
+  elapsed[2] += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (sum[0] == sum[1] && sum[0] == sum[2], "Timing results");
+
+  /* the batch search expects sorted targets */
+  qsort (targets, ntargets, sizeof (int64_t), sc_int64_compare);
+  elapsed[3] = -sc_MPI_Wtime ();
+  for (zz = 0; zz < ntargets; ++zz) {
+    positions[zz] =
+      sc_search_lower_bound64_branchless (targets[zz], array, nmemb);
+  }
+  elapsed[3] += sc_MPI_Wtime ();
+  elapsed[4] = -sc_MPI_Wtime ();
+  sc_search_lower_bound64_many (targets, ntargets, array, nmemb, positions);
+  elapsed[4] += sc_MPI_Wtime ();
+  for (zz = 0; zz < ntargets; ++zz) {
+    sum[3] += positions[zz];
+  }
+  SC_CHECK_ABORT (sum[0] == sum[3], "Timing many");
+
+  SC_GLOBAL_INFOF ("Lower bound in %lld random Mops/s classic %g"
+                   " branchless %g Eytzinger %g\n", (long long) nmemb,
+                   1e-6 * ntargets / elapsed[0], 1e-6 * ntargets / elapsed[1],
+                   1e-6 * ntargets / elapsed[2]);
+  SC_GLOBAL_INFOF ("Lower bound in %lld sorted Mops/s branchless %g"
+                   " many %g\n", (long long) nmemb,
+                   1e-6 * ntargets / elapsed[3], 1e-6 * ntargets / elapsed[4]);
+
+  sc_search_eytzinger_destroy (eyt);
+  SC_FREE (array);
+  SC_FREE (targets);
+  SC_FREE (positions);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -41,6 +150,8 @@ main (int argc, char **argv)
   mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
   if (mpirank == 0) {
     maxlevel = 3;
     target = 3;
@@ -54,8 +165,16 @@ main (int argc, char **argv)
                     maxlevel, level, i, target, position);
       }
     }
+
+    for (i = 0; i < 40; ++i) {
+      test_lower_bound64 ((size_t) i);
+    }
+    test_lower_bound64 (1000);
+    test_lower_bound64_timing (1 << 20, 1 << 20);
   }
 
+  sc_finalize ();
+
   mpiret = sc_MPI_Finalize ();
   SC_CHECK_MPI (mpiret);
 
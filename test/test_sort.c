@@ -24,20 +24,152 @@
 #include <sc_allgather.h>
 #include <sc_sort.h>
 
+#ifdef SC_ENABLE_DEBUG
+
+/** Compare doubles in the direction given by the context. */
+static int
+test_sort_compare_sign (const void *v1, const void *v2, void *ctx)
+{
+  return *(int *) ctx * sc_double_compare (v1, v2);
+}
+
+/** Gather the data on rank 0 and check that it is sorted. */
+static void
+test_sort_verify (sc_MPI_Comm mpicomm, double *ldata, size_t * nmemb)
+{
+  int                 mpiret;
+  int                 rank, num_procs;
+  int                 i;
+  int                *recvc, *displ;
+  size_t              zz, gtotal;
+  double             *gdata;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  SC_GLOBAL_PRODUCTION ("Verifying\n");
+  gtotal = 0;
+  recvc = NULL;
+  displ = NULL;
+  gdata = NULL;
+  if (rank == 0) {
+    recvc = SC_ALLOC (int, num_procs);
+    displ = SC_ALLOC (int, num_procs + 1);
+    displ[0] = 0;
+    for (i = 0; i < num_procs; ++i) {
+      recvc[i] = (int) nmemb[i];
+      displ[i + 1] = displ[i] + recvc[i];
+    }
+    gtotal = (size_t) displ[num_procs];
+    gdata = SC_ALLOC (double, gtotal);
+  }
+  mpiret = sc_MPI_Gatherv (ldata, (int) nmemb[rank], sc_MPI_DOUBLE,
+                           gdata, recvc, displ, sc_MPI_DOUBLE, 0, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (rank == 0) {
+    for (zz = 0; zz < gtotal - 1; ++zz) {
+      SC_CHECK_ABORT (gdata[zz] <= gdata[zz + 1], "Parallel sort failed");
+    }
+  }
+  SC_FREE (gdata);
+  SC_FREE (displ);
+  SC_FREE (recvc);
+}
+
+/** A record that is large compared to its key. */
+typedef struct test_sort_record
+{
+  double              key;
+  int                 payload[18];
+}
+test_sort_record_t;
+
+/** Sort records by moving whole records and by a key permutation. */
+static void
+test_sort_records (sc_MPI_Comm mpicomm, size_t * nmemb, int timing)
+{
+  int                 mpiret;
+  int                 rank;
+  int                 k;
+  size_t              zz, lcount;
+  double              tfull, tperm;
+  double             *keys;
+  test_sort_record_t *full, *records;
+  sc_psort_perm_t    *perm;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+  lcount = nmemb[rank];
+
+  records = SC_ALLOC (test_sort_record_t, lcount);
+  full = SC_ALLOC (test_sort_record_t, lcount);
+  for (zz = 0; zz < lcount; ++zz) {
+    records[zz].key = -50. + (100. * rand () / (RAND_MAX + 1.0));
+    for (k = 0; k < 18; ++k) {
+      records[zz].payload[k] = (int) floor (records[zz].key * 1000.) + k;
+    }
+  }
+  memcpy (full, records, lcount * sizeof (test_sort_record_t));
+
+  tfull = -sc_MPI_Wtime ();
+  sc_psort_sample (mpicomm, full, nmemb, sizeof (test_sort_record_t),
+                   sc_double_compare);
+  tfull += sc_MPI_Wtime ();
+
+  tperm = -sc_MPI_Wtime ();
+  perm = sc_psort_perm_new (mpicomm, records, nmemb,
+                            sizeof (test_sort_record_t),
+                            offsetof (test_sort_record_t, key),
+                            sizeof (double), sc_double_compare);
+  sc_psort_perm_apply (perm, records, sizeof (test_sort_record_t));
+  tperm += sc_MPI_Wtime ();
+  sc_psort_perm_destroy (perm);
+
+  /* the keys agree with the full sort and every record is intact */
+  keys = SC_ALLOC (double, lcount);
+  for (zz = 0; zz < lcount; ++zz) {
+    SC_CHECK_ABORT (records[zz].key == full[zz].key, "Key sort failed");
+    for (k = 0; k < 18; ++k) {
+      SC_CHECK_ABORT (records[zz].payload[k] ==
+                      (int) floor (records[zz].key * 1000.) + k,
+                      "Key sort payload");
+    }
+    keys[zz] = records[zz].key;
+  }
+  if (!timing || lcount < 1000) {
+    test_sort_verify (mpicomm, keys, nmemb);
+  }
+  if (timing) {
+    SC_GLOBAL_PRODUCTIONF ("Records of %d bytes full sort %g s"
+                           " key sort %g s\n",
+                           (int) sizeof (test_sort_record_t), tfull, tperm);
+  }
+
+  SC_FREE (keys);
+  SC_FREE (full);
+  SC_FREE (records);
+}
+
+#endif /* SC_ENABLE_DEBUG */
+
 int
 main (int argc, char **argv)
 {
 #ifdef SC_ENABLE_DEBUG
   int                 mpiret;
   int                 rank, num_procs;
-  int                 i, isizet;
+  int                 isizet;
   int                 k, printed;
-  int                *recvc, *displ;
   int                 timing;
+  int                 sign;
   size_t              zz;
-  size_t              lcount, gtotal;
+  size_t              lcount, tcount;
   size_t             *nmemb;
-  double             *ldata, *gdata;
+  double             *ldata;
+  double             *tdata, *sdata;
+  double              tserial, tthreaded, tpsort, tsample;
   sc_MPI_Comm         mpicomm;
   char                buffer[BUFSIZ];
 
@@ -74,7 +206,44 @@ main (int argc, char **argv)
   for (zz = 0; zz < lcount; ++zz) {
     ldata[zz] = -50. + (100. * rand () / (RAND_MAX + 1.0));
   }
+  tpsort = -sc_MPI_Wtime ();
   sc_psort (mpicomm, ldata, nmemb, sizeof (double), sc_double_compare);
+  tpsort += sc_MPI_Wtime ();
+
+  /* compare the threaded local sort with qsort on the same data */
+  tcount = timing ? lcount : 100000;
+  tdata = SC_ALLOC (double, tcount);
+  sdata = SC_ALLOC (double, tcount);
+  for (zz = 0; zz < tcount; ++zz) {
+    tdata[zz] = sdata[zz] = -50. + (100. * rand () / (RAND_MAX + 1.0));
+  }
+  tserial = -sc_MPI_Wtime ();
+  sc_sort_local (sdata, tcount, sizeof (double), sc_double_compare, 1);
+  tserial += sc_MPI_Wtime ();
+  tthreaded = -sc_MPI_Wtime ();
+  sc_sort_local (tdata, tcount, sizeof (double), sc_double_compare, 0);
+  tthreaded += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (!memcmp (tdata, sdata, tcount * sizeof (double)),
+                  "Threaded local sort failed");
+  SC_GLOBAL_PRODUCTIONF ("Local sort %lld values qsort %g s threaded %g s"
+                         " speedup %g\n", (long long) tcount, tserial,
+                         tthreaded, tserial / tthreaded);
+
+  /* sort descending and back with a context comparator */
+  sign = -1;
+  sc_sort_local_ctx (tdata, tcount, sizeof (double),
+                     test_sort_compare_sign, &sign, 4);
+  for (zz = 0; zz < tcount; ++zz) {
+    SC_CHECK_ABORT (tdata[zz] == sdata[tcount - 1 - zz],
+                    "Context local sort failed");
+  }
+  sign = 1;
+  sc_sort_local_ctx (tdata, tcount, sizeof (double),
+                     test_sort_compare_sign, &sign, 1);
+  SC_CHECK_ABORT (!memcmp (tdata, sdata, tcount * sizeof (double)),
+                  "Context local sort failed");
+  SC_FREE (tdata);
+  SC_FREE (sdata);
 
   /* output result */
   if (!timing) {
@@ -91,33 +260,43 @@ main (int argc, char **argv)
 
   /* verify result */
   if (!timing || lcount < 1000) {
-    SC_GLOBAL_PRODUCTION ("Verifying\n");
-    gtotal = 0;
-    recvc = NULL;
-    displ = NULL;
-    gdata = NULL;
-    if (rank == 0) {
-      recvc = SC_ALLOC (int, num_procs);
-      displ = SC_ALLOC (int, num_procs + 1);
-      displ[0] = 0;
-      for (i = 0; i < num_procs; ++i) {
-        recvc[i] = (int) nmemb[i];
-        displ[i + 1] = displ[i] + recvc[i];
-      }
-      gtotal = (size_t) displ[num_procs];
-      gdata = SC_ALLOC (double, gtotal);
-    }
-    mpiret = sc_MPI_Gatherv (ldata, (int) lcount, sc_MPI_DOUBLE,
-                             gdata, recvc, displ, sc_MPI_DOUBLE, 0, mpicomm);
-    SC_CHECK_MPI (mpiret);
-    if (rank == 0) {
-      for (zz = 0; zz < gtotal - 1; ++zz) {
-        SC_CHECK_ABORT (gdata[zz] <= gdata[zz + 1], "Parallel sort failed");
-      }
+    test_sort_verify (mpicomm, ldata, nmemb);
+  }
+
+  /* sort again with a context comparator */
+  for (zz = 0; zz < lcount; ++zz) {
+    ldata[zz] = -50. + (100. * rand () / (RAND_MAX + 1.0));
+  }
+  sign = 1;
+  sc_psort_ctx (mpicomm, ldata, nmemb, sizeof (double),
+                test_sort_compare_sign, &sign);
+  if (!timing || lcount < 1000) {
+    test_sort_verify (mpicomm, ldata, nmemb);
+  }
+
+  /* sort again by sample sort, with many duplicates unless timing */
+  for (zz = 0; zz < lcount; ++zz) {
+    ldata[zz] = -50. + (100. * rand () / (RAND_MAX + 1.0));
+    if (!timing) {
+      ldata[zz] = floor (ldata[zz] / 20.);
     }
-    SC_FREE (gdata);
-    SC_FREE (displ);
-    SC_FREE (recvc);
+  }
+  tsample = -sc_MPI_Wtime ();
+  sc_psort_sample (mpicomm, ldata, nmemb, sizeof (double),
+                   sc_double_compare);
+  tsample += sc_MPI_Wtime ();
+  if (!timing || lcount < 1000) {
+    test_sort_verify (mpicomm, ldata, nmemb);
+  }
+
+  /* sort large records by moving only their keys */
+  test_sort_records (mpicomm, nmemb, timing);
+
+  /* weak scaling: run with fixed values per process and varying np */
+  if (timing) {
+    SC_GLOBAL_PRODUCTIONF ("Processes %d values per process %lld"
+                           " bitonic %g s sample %g s\n", num_procs,
+                           (long long) lcount, tpsort, tsample);
   }
 
   /* clean up and exit */
@@ -38,7 +38,8 @@ main (int argc, char **argv)
   int                 rank, num_procs;
   size_t              nmemb[3], lsize, total;
   size_t              zz;
-  char               *ldata;
+  char               *ldata, *sdata;
+  double              tserial, tthreaded;
   sc_MPI_Comm         mpicomm;
 
   mpiret = sc_MPI_Init (&argc, &argv);
@@ -51,6 +52,28 @@ main (int argc, char **argv)
 
   sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
 
+  /* compare the threaded local sort with qsort on the same records */
+  lsize = 3 * 7240;
+  srand (29 + rank);
+  ldata = SC_ALLOC (char, lsize * size);
+  sdata = SC_ALLOC (char, lsize * size);
+  for (zz = 0; zz < lsize * size; ++zz) {
+    ldata[zz] = sdata[zz] = (char) (-50. + (300. * rand () /
+                                            (RAND_MAX + 1.0)));
+  }
+  tserial = -sc_MPI_Wtime ();
+  sc_sort_local (sdata, lsize, size, the_compare, 1);
+  tserial += sc_MPI_Wtime ();
+  tthreaded = -sc_MPI_Wtime ();
+  sc_sort_local (ldata, lsize, size, the_compare, 0);
+  tthreaded += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (!memcmp (ldata, sdata, lsize * size), "Local sort");
+  SC_GLOBAL_PRODUCTIONF ("Local sort %lld records qsort %g s threaded %g s"
+                         " speedup %g\n", (long long) lsize, tserial,
+                         tthreaded, tserial / tthreaded);
+  SC_FREE (ldata);
+  SC_FREE (sdata);
+
   if (num_procs != 3) {
     SC_GLOBAL_PRODUCTION ("This test will test things only for np = 3\n");
     goto donothing;
@@ -75,6 +98,16 @@ main (int argc, char **argv)
                                  ldata + size * zz) <= 0, "Sort");
   }
 
+  /* the sample sort must produce the same partition */
+  for (zz = 0; zz < lsize * size; ++zz) {
+    ldata[zz] = (char) (-50. + (300. * rand () / (RAND_MAX + 1.0)));
+  }
+  sc_psort_sample (mpicomm, ldata, nmemb, size, the_compare);
+  for (zz = 1; zz < lsize; ++zz) {
+    SC_CHECK_ABORT (the_compare (ldata + size * (zz - 1),
+                                 ldata + size * zz) <= 0, "Sample sort");
+  }
+
   /* clean up and exit */
   SC_FREE (ldata);
 